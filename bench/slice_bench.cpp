@@ -0,0 +1,236 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#include "slicer/arbslice.h"
+#include "slicer/overlayslice.h"
+#include "slicer/rawslice.h"
+#include "slicer/volumeslice.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// headless benchmark of the cpu slicing kernels behind the ortho, arb and volume viewports
+// usage: knossos_slice_bench [cube edge] [objects] [repeats]
+// every case runs single threaded on synthetic cubes, the median of repeats runs is reported in megavoxels per second
+// raw kernels run with every supported instruction set and are checked against the scalar one first
+
+namespace {
+/**
+ * @brief Subobject s belongs to object s % objects, every fourth object is selected.
+ */
+class SyntheticSegmentation : public OverlaySlice::Resolver {
+    const std::uint64_t objects;
+public:
+    explicit SyntheticSegmentation(const std::uint64_t objects) : objects{objects} {}
+    OverlaySlice::ColorCache::Entry resolve(const std::uint64_t subobjectId) const override {
+        const auto objectIndex = subobjectId % objects;
+        const std::uint32_t rgb = (objectIndex * 2654435761u) & 0xFFFFFF;
+        return {subobjectId, objectIndex, rgb | 0x80000000u, 0, objectIndex % 4 == 0};
+    }
+    bool selected(const std::uint64_t subobjectId) const {
+        return subobjectId % objects % 4 == 0;
+    }
+};
+
+template<typename Function>
+double megavoxelsPerSecond(const double voxels, const int repeats, Function && function) {
+    function();// warm up caches and lazily grown buffers
+    std::vector<double> rates;
+    for (int i = 0; i < repeats; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        rates.emplace_back(voxels / elapsed.count() / 1e6);
+    }
+    std::nth_element(std::begin(rates), std::begin(rates) + rates.size() / 2, std::end(rates));
+    return rates[rates.size() / 2];
+}
+
+void report(const std::string & kernel, const std::string & variant, const std::string & area, const std::string & hover, const double rate) {
+    std::cout << std::left << std::setw(10) << kernel << std::setw(11) << variant << std::setw(8) << area << std::setw(7) << hover
+              << std::right << std::fixed << std::setprecision(1) << std::setw(9) << rate << '\n';
+}
+}
+
+int main(int argc, char * argv[]) {
+    const int edge = argc > 1 ? std::atoi(argv[1]) : 128;
+    const std::uint64_t objects = argc > 2 ? std::atoll(argv[2]) : 1000;
+    const int repeats = std::max(1, argc > 3 ? std::atoi(argv[3]) : 9);
+    const int supercubeEdge = 3;
+    const std::size_t area = static_cast<std::size_t>(edge) * edge;
+    const std::size_t voxels = area * edge;
+
+    std::mt19937 random;// fixed seed, every run slices the same data
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> raw(voxels);
+    for (auto & voxel : raw) {
+        voxel = byte(random);
+    }
+    // blocky subobjects of 12³ voxels, so ids come in runs and planes have edges like real segmentations
+    std::vector<std::uint64_t> overlay(voxels);
+    const std::uint64_t subobjects = 4 * objects;
+    for (int z = 0; z < edge; ++z)
+    for (int y = 0; y < edge; ++y)
+    for (int x = 0; x < edge; ++x) {
+        const std::uint64_t block = (static_cast<std::uint64_t>(z / 12) * 73856093) ^ (static_cast<std::uint64_t>(y / 12) * 19349663) ^ (static_cast<std::uint64_t>(x / 12) * 83492791);
+        overlay[(static_cast<std::size_t>(z) * edge + y) * edge + x] = 1 + block % subobjects;
+    }
+    const SyntheticSegmentation segmentation(objects);
+    const auto focusedObject = overlay[voxels / 2] % objects;
+
+    std::vector<std::tuple<std::uint8_t, std::uint8_t, std::uint8_t>> lut(256);
+    for (std::size_t i = 0; i < lut.size(); ++i) {
+        lut[i] = std::make_tuple(255 - i, i / 2, i);
+    }
+    const auto tables = RawSlice::makeTables(nullptr, 80.f);
+    const auto lutTables = RawSlice::makeTables(&lut, 80.f);
+    const RawSlice::Span all{0, edge};
+    const RawSlice::Span partial{edge / 4, edge - edge / 3};
+    const std::pair<RawSlice::Plane, std::string> planes[] = {{RawSlice::Plane::XY, "xy"}, {RawSlice::Plane::XZ, "xz"}, {RawSlice::Plane::ZY, "zy"}};
+    const auto planeStart = [edge, area](const RawSlice::Plane plane, const int depth){
+        return depth * (plane == RawSlice::Plane::ZY ? 1 : plane == RawSlice::Plane::XZ ? edge : area);
+    };
+
+    std::cout << "cube edge " << edge << ", " << objects << " objects, median of " << repeats << " runs, megavoxels per second\n";
+    const std::pair<RawSlice::Isa, std::string> isas[] = {{RawSlice::Isa::Scalar, "scalar"}, {RawSlice::Isa::SSE41, "sse4.1"}, {RawSlice::Isa::AVX2, "avx2"}};
+    const std::pair<const RawSlice::Tables *, std::string> rawTables[] = {{&tables, "raw"}, {&lutTables, "raw lut"}};
+    bool ok = true;
+    std::vector<std::uint8_t> rgb(3 * area), reference(3 * area), rgba(4 * area);
+    for (const auto & isa : isas) {
+        if (isa.first > RawSlice::bestIsa()) {
+            continue;
+        }
+        for (const auto & table : rawTables) {
+            for (const auto & plane : planes) {
+                for (const auto & span : {all, partial}) {
+                    const auto * middle = raw.data() + planeStart(plane.first, edge / 2);
+                    RawSlice::extract(middle, reference.data(), edge, plane.first, *table.first, span, span, RawSlice::Isa::Scalar);
+                    RawSlice::extract(middle, rgb.data(), edge, plane.first, *table.first, span, span, isa.first);
+                    const bool same = reference == rgb;
+                    ok = ok && same;
+                    const auto rate = megavoxelsPerSecond(voxels, repeats, [&](){
+                        for (int depth = 0; depth < edge; ++depth) {
+                            RawSlice::extract(raw.data() + planeStart(plane.first, depth), rgb.data(), edge, plane.first, *table.first, span, span, isa.first);
+                        }
+                    });
+                    report(table.second, plane.second + ' ' + isa.second, span.begin == 0 ? "inside" : "partly", same ? "-" : "DIFF", rate);
+                }
+            }
+        }
+    }
+    OverlaySlice::ColorCache cache;
+    for (const auto & plane : planes) {
+        for (const auto & span : {all, partial}) {
+            for (const bool hover : {false, true}) {
+                const auto rate = megavoxelsPerSecond(voxels, repeats, [&](){
+                    OverlaySlice::Colors colors(cache, segmentation, hover, focusedObject);
+                    for (int depth = 0; depth < edge; ++depth) {
+                        OverlaySlice::colorize(overlay.data() + planeStart(plane.first, depth), rgba.data(), edge, plane.first, colors, span, span);
+                    }
+                });
+                report("overlay", plane.second, span.begin == 0 ? "inside" : "partly", hover ? "hover" : "-", rate);
+            }
+        }
+    }
+
+    // the supercube repeats the cube, the plane is tilted through all three axes
+    ArbSlice::Grid<std::uint8_t> rawGrid{std::vector<const std::uint8_t *>(std::pow(supercubeEdge, 3), raw.data()), supercubeEdge, edge};
+    ArbSlice::Grid<std::uint64_t> overlayGrid{std::vector<const std::uint64_t *>(std::pow(supercubeEdge, 3), overlay.data()), supercubeEdge, edge};
+    const int texels = (supercubeEdge - 1) * edge;
+    const int planesPerRun = 16;
+    const auto arbPlane = [edge](const int step){
+        return ArbSlice::Plane{{{1.0 * edge, 0.2 * edge, 0.5 * edge + 0.5 * step}}, {{0.8, 0.6, 0}}, {{-0.36, 0.48, 0.8}}};
+    };
+    std::vector<std::uint8_t> arbRgb(3 * static_cast<std::size_t>(texels) * texels);
+    for (const auto & filter : {std::make_pair(ArbSlice::Filter::Nearest, "nearest"), std::make_pair(ArbSlice::Filter::Trilinear, "trilinear")}) {
+        const auto rate = megavoxelsPerSecond(static_cast<double>(planesPerRun) * texels * texels, repeats, [&](){
+            for (int step = 0; step < planesPerRun; ++step) {
+                ArbSlice::resample(rawGrid, arbPlane(step), tables.inside, arbRgb.data(), texels, 0, texels, filter.first);
+            }
+        });
+        report("arb raw", filter.second, "-", "-", rate);
+    }
+    const int superEdge = supercubeEdge * edge;
+    const ArbSlice::Box allInside{{{0, 0, 0}}, {{superEdge - 1, superEdge - 1, superEdge - 1}}};
+    const ArbSlice::Box partlyInside{{{superEdge / 4, superEdge / 4, superEdge / 4}}, {{superEdge - superEdge / 3, superEdge - superEdge / 3, superEdge - superEdge / 3}}};
+    std::vector<std::uint64_t> arbIds(static_cast<std::size_t>(texels) * texels);
+    std::vector<std::uint8_t> arbRgba(4 * arbIds.size());
+    for (const auto * inside : {&allInside, &partlyInside}) {
+        for (const bool hover : {false, true}) {
+            const auto rate = megavoxelsPerSecond(static_cast<double>(planesPerRun) * texels * texels, repeats, [&](){
+                OverlaySlice::Colors colors(cache, segmentation, hover, focusedObject);
+                for (int step = 0; step < planesPerRun; ++step) {
+                    ArbSlice::gather(overlayGrid, arbPlane(step), *inside, 0, arbIds.data(), texels, 0, texels);
+                    const auto & edges = colors.edges(arbIds.data(), texels, texels);
+                    for (std::size_t i = 0; i < arbIds.size(); ++i) {
+                        colors.store(arbRgba.data() + 4 * i, arbIds[i], edges[i]);
+                    }
+                }
+            });
+            report("arb oc", "gather", inside == &allInside ? "inside" : "partly", hover ? "hover" : "-", rate);
+        }
+    }
+
+    // complete rebuild of the segmentation volume texture like Viewport3D::updateVolumeTexture, bricks one after another
+    const int texLen = edge;
+    const int bricks = std::pow(VolumeSlice::bricksPerAxis(texLen), 3);
+    std::vector<std::uint8_t> volume(4 * static_cast<std::size_t>(texLen) * texLen * texLen), shaded, cells(std::pow(VolumeSlice::cellsPerAxis(texLen), 3));
+    std::vector<std::vector<std::uint64_t>> brickIds(bricks), brickDistinct(bricks);
+    const auto rate = megavoxelsPerSecond(std::pow(texLen, 3), repeats, [&](){
+        std::unordered_map<std::uint64_t, VolumeSlice::Rgba> colors;
+        for (int brick = 0; brick < bricks; ++brick) {
+            const auto box = VolumeSlice::brick(brick, texLen);
+            brickIds[brick].resize(box.size());
+            brickDistinct[brick] = VolumeSlice::sample(overlayGrid, box, brickIds[brick].data());
+            for (const auto id : brickDistinct[brick]) {
+                if (colors.find(id) == std::end(colors)) {
+                    const auto rgba = segmentation.resolve(id).rgba;
+                    const std::uint8_t alpha = segmentation.selected(id) ? 255 : 0;
+                    colors.emplace(id, VolumeSlice::Rgba{{static_cast<std::uint8_t>(rgba), static_cast<std::uint8_t>(rgba >> 8), static_cast<std::uint8_t>(rgba >> 16), alpha}});
+                }
+            }
+        }
+        for (int brick = 0; brick < bricks; ++brick) {
+            const auto box = VolumeSlice::brick(brick, texLen);
+            VolumeSlice::colorize(brickIds[brick].data(), box, colors, volume.data(), texLen);
+            VolumeSlice::occupancy(volume.data(), box, texLen, cells.data());
+        }
+        for (int brick = 0; brick < bricks; ++brick) {
+            const auto box = VolumeSlice::brick(brick, texLen);
+            shaded.resize(4 * box.size());
+            VolumeSlice::shade(volume.data(), box, texLen, shaded.data());
+        }
+    });
+    report("volume", "rebuild", "-", "-", rate);
+    if (!ok) {
+        std::cout << "raw kernels differ from the scalar reference\n";
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -27,12 +27,14 @@
 #include "skeleton/skeletonizer.h"
 #include "stateInfo.h"
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QRegularExpression>
+#include <QSettings>
 #include <QStringList>
 #include <QTextStream>
 #include <QUrlQuery>
@@ -204,10 +206,42 @@ Dataset Dataset::fromLegacyConf(const QUrl & configUrl, QString config) {
     return info;
 }
 
-void Dataset::checkMagnifications() {
+namespace {
+//mags probed per dataset url, used for an unchanged config until the probe on every open confirms or corrects them
+const QString DATASET_METADATA = "dataset_metadata";
+
+QString hexHash(const QString & text) {
+    return QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1).toHex();
+}
+}
+
+bool Dataset::restoreMagnifications(const QString & config) {
+    QSettings settings;
+    settings.beginGroup(DATASET_METADATA);
+    settings.beginGroup(hexHash(url.toString()));//urls contain slashes which would nest groups
+    if (settings.value("config").toString() != hexHash(config)) {
+        return false;
+    }
+    lowestAvailableMag = settings.value("lowest_mag").toInt();
+    highestAvailableMag = settings.value("highest_mag").toInt();
+    qDebug() << QObject::tr("Lowest Mag: %1, Highest Mag: %2 (cached)").arg(lowestAvailableMag).arg(highestAvailableMag).toUtf8().constData();
+    return true;
+}
+
+void Dataset::checkMagnifications(const QString & config, QObject * context, std::function<void(int, int)> done) const {
     //iterate over all possible mags and test their availability
-    std::tie(lowestAvailableMag, highestAvailableMag) = Network::singleton().checkOnlineMags(url);
-    qDebug() << QObject::tr("Lowest Mag: %1, Highest Mag: %2").arg(lowestAvailableMag).arg(highestAvailableMag).toUtf8().constData();
+    Network::singleton().checkOnlineMags(url, context, [urlKey = hexHash(url.toString()), configHash = hexHash(config), done](const int lowest, const int highest){
+        qDebug() << QObject::tr("Lowest Mag: %1, Highest Mag: %2").arg(lowest).arg(highest).toUtf8().constData();
+        if (lowest <= highest) {
+            QSettings settings;
+            settings.beginGroup(DATASET_METADATA);
+            settings.beginGroup(urlKey);
+            settings.setValue("config", configHash);
+            settings.setValue("lowest_mag", lowest);
+            settings.setValue("highest_mag", highest);
+        }
+        done(lowest, highest);
+    });
 }
 
 void Dataset::applyToState() const {
@@ -28,6 +28,10 @@
 #include <QString>
 #include <QUrl>
 
+#include <functional>
+
+class QObject;
+
 struct Dataset {
     enum class API {
         Heidelbrain, WebKnossos, GoogleBrainmaps, OpenConnectome
@@ -41,7 +45,8 @@ struct Dataset {
     static Dataset parseOpenConnectomeJson(const QUrl & infoUrl, const QString & json_raw);
     static Dataset parseWebKnossosJson(const QString & json_raw);
     static Dataset fromLegacyConf(const QUrl & url, QString config);
-    void checkMagnifications();
+    bool restoreMagnifications(const QString & config);
+    void checkMagnifications(const QString & config, QObject * context, std::function<void(int, int)> done) const;
     void applyToState() const;
 
     static QUrl apiSwitch(const API api, const QUrl & baseUrl, const Coordinate globalCoord, const int scale, const int cubeedgelength, const CubeType type);
@@ -40,10 +40,12 @@
 #include <QImage>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QTimer>
 #include <QtConcurrent>
 
 #include <cmath>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 
 //generalizing this needs polymorphic lambdas or return type deduction
@@ -61,6 +63,82 @@ bool currentlyVisibleWrapWrap(const Coordinate & center, const Coordinate & coor
     return currentlyVisibleWrap(center)(coord);
 }
 
+void Loader::LatencyHistogram::add(const qint64 msec) {
+    const std::size_t bin = binsPerOctave * std::log2(1 + std::max(qint64{0}, msec));
+    ++bins[std::min(bin, bins.size() - 1)];
+    if (++count > maxSamples) {//age old samples
+        count = 0;
+        for (auto & elem : bins) {
+            elem /= 2;
+            count += elem;
+        }
+    }
+}
+
+qint64 Loader::LatencyHistogram::percentile(const double fraction) const {
+    const std::size_t target = std::ceil(fraction * count);
+    std::size_t accumulated = 0;
+    for (std::size_t bin = 0; bin < bins.size(); ++bin) {
+        accumulated += bins[bin];
+        if (accumulated >= target) {
+            return std::exp2((bin + 1.0) / binsPerOctave) - 1;//upper bin edge
+        }
+    }
+    return std::exp2(static_cast<double>(bins.size()) / binsPerOctave) - 1;
+}
+
+void Loader::EncodingStats::add(const double cubeBytes, const double msec) {
+    const double weight = samples < 8 ? 1.0 / (samples + 1) : 0.125;//plain mean during warm-up, then exponentially weighted
+    bytes += weight * (cubeBytes - bytes);
+    decodeMsec += weight * (msec - decodeMsec);
+    ++samples;
+}
+
+/**
+ * @brief Worker::updateThroughput adds a sample of bytes transferred in msec, measured while the body was arriving
+ */
+void Loader::Worker::updateThroughput(const double bytes, const double msec) {
+    if (bytes <= 0 || msec <= 0) {
+        return;
+    }
+    //replies share the link, so scale the single reply rate by the number of parallel connections (Qt uses up to 6 per host)
+    const auto parallel = std::min<std::size_t>(6, 1 + dcDownload.size() + ocDownload.size());
+    const double sample = parallel * bytes / msec;
+    bytesPerMsec = bytesPerMsec == 0 ? sample : bytesPerMsec + 0.125 * (sample - bytesPerMsec);
+}
+
+void Loader::Worker::selectDcEncoding() {
+    if (typeDc == Dataset::CubeType::RAW_UNCOMPRESSED || state->compressionRatio == 0) {
+        return;//no compressed variant available or raw cubes manually enforced
+    }
+    if (samplesSinceSwitch < encodingMinSamples || bytesPerMsec == 0) {
+        return;
+    }
+    const double decodeThreads = std::max(1, decompressionPool.maxThreadCount());
+    const auto cost = [this, decodeThreads](const EncodingStats & stats, const double bytesGuess, const double decodeGuess){
+        const auto bytes = stats.samples != 0 ? stats.bytes : bytesGuess;
+        const auto decode = stats.samples != 0 ? stats.decodeMsec : decodeGuess;
+        return bytes / bytesPerMsec + decode / decodeThreads;
+    };
+    const auto rawCost = cost(rawStats, state->cubeBytes, 0);
+    const auto compressedCost = cost(compressedStats, compressedRatioGuess * state->cubeBytes, compressedDecodeGuessMsec);
+    const bool rawActive = typeDcActive == Dataset::CubeType::RAW_UNCOMPRESSED;
+    const auto currentCost = rawActive ? rawCost : compressedCost;
+    const auto alternativeCost = rawActive ? compressedCost : rawCost;
+    if (alternativeCost < encodingHysteresis * currentCost) {
+        const auto next = rawActive ? typeDc : Dataset::CubeType::RAW_UNCOMPRESSED;
+        {
+            QMutexLocker locker(&telemetryMutex);
+            telemetry.encodingSwitches.push_back({telemetry.uptime.elapsed(), typeDcActive, next, bytesPerMsec, rawCost, compressedCost});
+        }
+        qDebug() << "loader: switching cube encoding" << static_cast<int>(typeDcActive) << "→" << static_cast<int>(next)
+                 << "at" << bytesPerMsec << "B/ms, cost raw" << rawCost << "ms, compressed" << compressedCost << "ms";
+        //only new requests use the other encoding, both decode to the same voxels, so loaded cubes stay valid
+        typeDcActive = next;
+        samplesSinceSwitch = 0;
+    }
+}
+
 void Loader::Controller::suspendLoader() {
     ++loadingNr;
     workerThread.quit();
@@ -79,10 +157,19 @@ void Loader::Controller::unloadCurrentMagnification() {
     emit unloadCurrentMagnificationSignal();
 }
 
-void Loader::Controller::markOcCubeAsModified(const CoordOfCube &cubeCoord, const int magnification) {
+void Loader::Controller::availableMagsChanged() {
+    if (worker != nullptr) {
+        suspendLoader();//the loader indexes its caches by mag
+        worker->OcModifiedCacheQueue.resize(std::log2(state->highestAvailableMag) + 1);
+        worker->snappyCache.resize(std::log2(state->highestAvailableMag) + 1);
+        workerThread.start();
+    }
+}
+
+void Loader::Controller::markOcCubeAsModified(const CoordOfCube &cubeCoord, const int magnification, const Coordinate & globalFirst, const Coordinate & globalLast) {
     emit markOcCubeAsModifiedSignal(cubeCoord, magnification);
     state->viewer->window->notifyUnsavedChanges();
-    state->viewer->oc_reslice_notify_all(cubeCoord.cube2Global(state->cubeEdgeLength, state->magnification));
+    state->viewer->oc_reslice_notify_region(cubeCoord, globalFirst, globalLast);
 
 }
 
@@ -99,6 +186,14 @@ decltype(Loader::Worker::snappyCache) Loader::Controller::getAllModifiedCubes()
     }
 }
 
+Loader::Telemetry Loader::Controller::telemetry() {
+    if (worker == nullptr) {
+        return {};
+    }
+    QMutexLocker locker(&worker->telemetryMutex);
+    return worker->telemetry;
+}
+
 bool Loader::Controller::isFinished() {
     return worker != nullptr ? worker->isFinished.load() : true;//no loader == done?
 }
@@ -206,8 +301,9 @@ std::vector<CoordOfCube> Loader::Worker::DcoiFromPos(const Coordinate & center)
 }
 
 Loader::Worker::Worker(const QUrl & baseUrl, const Dataset::API api, const Dataset::CubeType typeDc, const Dataset::CubeType typeOc, const QString & experimentName)
-    : baseUrl{baseUrl}, api{api}, typeDc{typeDc}, typeOc{typeOc}, experimentName{experimentName}, OcModifiedCacheQueue(std::log2(state->highestAvailableMag)+1), snappyCache(std::log2(state->highestAvailableMag)+1)
+    : typeDcActive{typeDc}, baseUrl{baseUrl}, api{api}, typeDc{typeDc}, typeOc{typeOc}, experimentName{experimentName}, OcModifiedCacheQueue(std::log2(state->highestAvailableMag)+1), snappyCache(std::log2(state->highestAvailableMag)+1)
 {
+    telemetry.uptime.start();
 
     // freeDcSlots / freeOcSlots are lists of pointers to locations that
     // can hold data or overlay cubes. Whenever we want to load a new
@@ -247,6 +343,43 @@ Loader::Worker::~Worker() {
     state->protectCube2Pointer.unlock();
 }
 
+/**
+ * @brief takes the first free slot which the viewer doesn’t read anymore, nullptr if there is none
+ */
+/**
+ * @brief Times the body of a reply from its first received bytes on, so waiting for a connection and the server don’t count as transfer
+ */
+struct TransferTimer {
+    QElapsedTimer sinceFirstBytes;
+    qint64 firstBytes{0};
+    qint64 lastBytes{0};
+};
+
+static std::shared_ptr<TransferTimer> timeTransfer(QNetworkReply * reply) {
+    auto transfer = std::make_shared<TransferTimer>();
+    QObject::connect(reply, &QNetworkReply::downloadProgress, [transfer](const qint64 bytesReceived, const qint64){
+        if (!transfer->sinceFirstBytes.isValid() && bytesReceived > 0) {
+            transfer->sinceFirstBytes.start();
+            transfer->firstBytes = bytesReceived;
+        }
+        transfer->lastBytes = bytesReceived;
+    });
+    return transfer;
+}
+
+static char * popFreeSlot(std::list<char*> & freeSlots) {
+    QMutexLocker locker(&state->protectCube2Pointer);
+    const auto it = std::find_if(std::begin(freeSlots), std::end(freeSlots), [](const char * slot){
+        return state->pinnedCubes.count(slot) == 0;
+    });
+    if (it == std::end(freeSlots)) {
+        return nullptr;
+    }
+    auto * slot = *it;
+    freeSlots.erase(it);
+    return slot;
+}
+
 template<typename CubeHash, typename Slots, typename Keep>
 void unloadCubes(CubeHash & loadedCubes, Slots & freeSlots, Keep keep) {
     unloadCubes(loadedCubes, freeSlots, keep, [](const CoordOfCube &, char *){});
@@ -398,8 +531,10 @@ void Loader::Worker::abortDownloadsFinishDecompression(Func keep) {
     finishDecompression(ocDecompression, keep);
 }
 
-std::pair<bool, char*> decompressCube(char * currentSlot, QIODevice & reply, const Dataset::CubeType type, coord2bytep_map_t & cubeHash, const Coordinate globalCoord, const int magnification) {
+Loader::DecompressionResult decompressCube(char * currentSlot, QIODevice & reply, const Dataset::CubeType type, coord2bytep_map_t & cubeHash, const Coordinate globalCoord, const int magnification) {
     QThread::currentThread()->setPriority(QThread::IdlePriority);
+    QElapsedTimer decodeTime;
+    decodeTime.start();
     bool success = false;
 
     auto data = reply.read(reply.bytesAvailable());//readAll can be very slow – https://bugreports.qt.io/browse/QTBUG-45926
@@ -443,6 +578,7 @@ std::pair<bool, char*> decompressCube(char * currentSlot, QIODevice & reply, con
     }  else {
         qDebug() << "unsupported format";
     }
+    const auto decodeMsec = decodeTime.elapsed();
 
     if (success) {
         state->protectCube2Pointer.lock();
@@ -455,7 +591,7 @@ std::pair<bool, char*> decompressCube(char * currentSlot, QIODevice & reply, con
         }
     }
 
-    return {success, currentSlot};
+    return {success, currentSlot, decodeMsec};
 }
 
 void Loader::Worker::cleanup(const Coordinate center) {
@@ -517,38 +653,41 @@ void Loader::Worker::downloadAndLoadCubes(const unsigned int loadingNr, const Co
         if (Dataset::isOverlay(type)) {
             auto snappyIt = snappyCache[loaderMagnification].find(globalCoord.cube(state->cubeEdgeLength, state->magnification));
             if (snappyIt != std::end(snappyCache[loaderMagnification])) {
-                if (!freeSlots.empty()) {
-                    auto downloadIt = downloads.find(globalCoord);
-                    if (downloadIt != std::end(downloads)) {
-                        downloadIt->second->abort();
-                    }
-                    auto decompressionIt = decompressions.find(globalCoord);
-                    if (decompressionIt != std::end(decompressions)) {
-                        decompressionIt->second->waitForFinished();
-                    }
-                    const auto cubeCoord = globalCoord.cube(state->cubeEdgeLength, state->magnification);
+                auto downloadIt = downloads.find(globalCoord);
+                if (downloadIt != std::end(downloads)) {
+                    downloadIt->second->abort();
+                }
+                auto decompressionIt = decompressions.find(globalCoord);
+                if (decompressionIt != std::end(decompressions)) {
+                    decompressionIt->second->waitForFinished();
+                }
+                const auto cubeCoord = globalCoord.cube(state->cubeEdgeLength, state->magnification);
+                state->protectCube2Pointer.lock();
+                auto * currentSlot = Coordinate2BytePtr_hash_get_or_fail(cubeHash, cubeCoord);
+                cubeHash.erase(cubeCoord);
+                if (currentSlot != nullptr && state->pinnedCubes.count(currentSlot) != 0) {//still being sliced, don’t overwrite it
+                    freeSlots.emplace_back(currentSlot);
+                    currentSlot = nullptr;
+                }
+                state->protectCube2Pointer.unlock();
+                if (currentSlot == nullptr) {
+                    currentSlot = popFreeSlot(freeSlots);
+                }
+                if (currentSlot == nullptr) {
+                    qCritical() << globalCoord.x << globalCoord.y << globalCoord.z << "no slots";
+                    return;
+                }
+                //directly uncompress snappy cube into the OC slot
+                const auto success = snappy::RawUncompress(snappyIt->second.c_str(), snappyIt->second.size(), reinterpret_cast<char*>(currentSlot));
+                if (success) {
                     state->protectCube2Pointer.lock();
-                    auto * currentSlot = Coordinate2BytePtr_hash_get_or_fail(cubeHash, cubeCoord);
-                    cubeHash.erase(cubeCoord);
+                    cubeHash[globalCoord.cube(state->cubeEdgeLength, state->magnification)] = currentSlot;
                     state->protectCube2Pointer.unlock();
-                    if (currentSlot == nullptr) {
-                        currentSlot = freeSlots.front();
-                        freeSlots.pop_front();
-                    }
-                    //directly uncompress snappy cube into the OC slot
-                    const auto success = snappy::RawUncompress(snappyIt->second.c_str(), snappyIt->second.size(), reinterpret_cast<char*>(currentSlot));
-                    if (success) {
-                        state->protectCube2Pointer.lock();
-                        cubeHash[globalCoord.cube(state->cubeEdgeLength, state->magnification)] = currentSlot;
-                        state->protectCube2Pointer.unlock();
 
-                        state->viewer->oc_reslice_notify_all(globalCoord);
-                    } else {
-                        freeSlots.emplace_back(currentSlot);
-                        qCritical() << globalCoord.x << globalCoord.y << globalCoord.z << "snappy extract" << snappyIt->second.size() << "failed";
-                    }
+                    state->viewer->oc_reslice_notify_all(globalCoord);
                 } else {
-                    qCritical() << globalCoord.x << globalCoord.y << globalCoord.z << "no slots";
+                    freeSlots.emplace_back(currentSlot);
+                    qCritical() << globalCoord.x << globalCoord.y << globalCoord.z << "snappy extract" << snappyIt->second.size() << "failed";
                 }
                 return;
             }
@@ -580,32 +719,65 @@ void Loader::Worker::downloadAndLoadCubes(const unsigned int loadingNr, const Co
                 //the first download usually finishes last (which is a bug) so we put it alone in the high priority bucket
                 request.setPriority(QNetworkRequest::HighPriority);
             }
-            auto * reply = qnam.get(request);
-            reply->setParent(nullptr);//reparent, so it don’t gets destroyed with qnam
-            downloads[globalCoord] = reply;
-            broadcastProgress(true);
-            QObject::connect(reply, &QNetworkReply::finished, [this, reply, type, globalCoord, center, &downloads, &decompressions, &freeSlots, &cubeHash](){
-                if (freeSlots.empty()) {
+            auto processReply = [this, type, globalCoord, &downloads, &decompressions, &freeSlots, &cubeHash](QNetworkReply * reply, const QElapsedTimer & latency, const TransferTimer & transfer){
+                const auto downloadIt = downloads.find(globalCoord);
+                const bool primary = downloadIt != std::end(downloads) && downloadIt->second == reply;
+                const auto hedgeIt = hedgePartner.find(reply);
+                if (hedgeIt != std::end(hedgePartner)) {
+                    auto * partner = hedgeIt->second;
+                    hedgePartner.erase(hedgeIt);
+                    hedgePartner.erase(partner);
+                    if (!primary) {//the hedge finished first
+                        const bool failed = reply->error() != QNetworkReply::NoError && reply->error() != QNetworkReply::ContentNotFoundError;
+                        if (failed || downloadIt == std::end(downloads)) {
+                            reply->deleteLater();//keep waiting for the original request
+                            return;
+                        }
+                        QMutexLocker locker(&telemetryMutex);
+                        ++telemetry.hedgesWon;
+                        downloadIt->second = reply;
+                    }
+                    partner->abort();
+                } else if (!primary) {//lost the race
+                    reply->deleteLater();
+                    return;
+                }
+                //transferred bytes, qnam transparently decodes a content encoding, so the body can be larger
+                const auto contentLength = reply->header(QNetworkRequest::ContentLengthHeader);
+                const auto replyBytes = contentLength.isValid() ? contentLength.toLongLong() : reply->bytesAvailable();
+                if (reply->error() == QNetworkReply::NoError) {
+                    latencyHistogram.add(latency.elapsed());
+                    if (transfer.sinceFirstBytes.isValid() && transfer.lastBytes > transfer.firstBytes) {//a body arriving at once only tells the latency
+                        const auto share = static_cast<double>(transfer.lastBytes - transfer.firstBytes) / transfer.lastBytes;
+                        updateThroughput(share * replyBytes, transfer.sinceFirstBytes.nsecsElapsed() / 1e6);
+                    }
+                }
+                auto * currentSlot = popFreeSlot(freeSlots);
+                if (currentSlot == nullptr) {
                     qCritical() << "no slots" << static_cast<int>(type) << cubeHash.size() << freeSlots.size();
                     downloads[globalCoord]->deleteLater();
                     downloads.erase(globalCoord);
                     broadcastProgress();
                     return;
                 }
-                auto * currentSlot = freeSlots.front();
-                freeSlots.pop_front();
                 if (reply->error() == QNetworkReply::NoError) {
 
                     auto future = QtConcurrent::run(&decompressionPool, std::bind(&decompressCube, currentSlot, std::ref(*reply), type, std::ref(cubeHash), globalCoord, state->magnification));
 
                     auto * watcher = new QFutureWatcher<DecompressionResult>;
-                    QObject::connect(watcher, &QFutureWatcher<DecompressionResult>::finished, [this, &cubeHash, &freeSlots, &downloads, &decompressions, globalCoord, watcher, type, currentSlot](){
+                    QObject::connect(watcher, &QFutureWatcher<DecompressionResult>::finished, [this, &cubeHash, &freeSlots, &downloads, &decompressions, globalCoord, watcher, type, currentSlot, replyBytes](){
                         if (!watcher->isCanceled()) {
                             auto result = watcher->result();
 
-                            if (!result.first) {//decompression unsuccessful
+                            if (!result.success) {//decompression unsuccessful
                                 qCritical() << globalCoord.x << globalCoord.y << globalCoord.z << "decompression" << static_cast<int>(type) << "failed → no fill";
-                                freeSlots.emplace_back(result.second);
+                                freeSlots.emplace_back(result.slot);
+                            } else if (!Dataset::isOverlay(type)) {
+                                (type == Dataset::CubeType::RAW_UNCOMPRESSED ? rawStats : compressedStats).add(replyBytes, result.decodeMsec);
+                                if (type == typeDcActive) {
+                                    ++samplesSinceSwitch;
+                                }
+                                selectDcEncoding();
                             }
                         } else {
                             qCritical() << globalCoord.x << globalCoord.y << globalCoord.z << "future canceled";
@@ -642,12 +814,50 @@ void Loader::Worker::downloadAndLoadCubes(const unsigned int loadingNr, const Co
                     downloads.erase(globalCoord);
                     broadcastProgress();
                 }
+            };
+            QElapsedTimer latency;
+            latency.start();
+            auto * reply = qnam.get(request);
+            reply->setParent(nullptr);//reparent, so it don’t gets destroyed with qnam
+            downloads[globalCoord] = reply;
+            {
+                QMutexLocker locker(&telemetryMutex);
+                ++telemetry.requests;
+            }
+            broadcastProgress(true);
+            QObject::connect(reply, &QNetworkReply::finished, [processReply, reply, latency, transfer = timeTransfer(reply)](){
+                processReply(reply, latency, *transfer);
             });
+            if (baseUrl.scheme() != "file" && currentlyVisibleWrap(center)(globalCoord) && latencyHistogram.size() >= hedgeMinSamples) {
+                //duplicate the request if it takes unusually long, the reply context cancels the timer when it’s gone
+                QTimer::singleShot(static_cast<int>(latencyHistogram.percentile(hedgePercentile)), reply, [this, request, reply, globalCoord, processReply, &downloads](){
+                    const auto downloadIt = downloads.find(globalCoord);
+                    const bool pending = downloadIt != std::end(downloads) && downloadIt->second == reply && !reply->isFinished();
+                    const bool withinBudget = (telemetry.hedges + 1) * 100 <= hedgeBudgetPercent * telemetry.requests;
+                    if (pending && withinBudget && hedgePartner.find(reply) == std::end(hedgePartner)) {
+                        QElapsedTimer hedgeLatency;
+                        hedgeLatency.start();
+                        auto hedgeRequest = request;
+                        hedgeRequest.setPriority(QNetworkRequest::HighPriority);
+                        auto * hedge = qnam.get(hedgeRequest);
+                        hedge->setParent(nullptr);
+                        hedgePartner[reply] = hedge;
+                        hedgePartner[hedge] = reply;
+                        {
+                            QMutexLocker locker(&telemetryMutex);
+                            ++telemetry.hedges;
+                        }
+                        QObject::connect(hedge, &QNetworkReply::finished, [processReply, hedge, hedgeLatency, transfer = timeTransfer(hedge)](){
+                            processReply(hedge, hedgeLatency, *transfer);
+                        });
+                    }
+                });
+            }
         }
     };
 
     const auto workaroundProcessLocalImmediately = baseUrl.scheme() == "file" ? [](){QCoreApplication::processEvents();} : [](){};
-    auto typeDcOverride = state->compressionRatio == 0 ? Dataset::CubeType::RAW_UNCOMPRESSED : typeDc;
+    auto typeDcOverride = state->compressionRatio == 0 ? Dataset::CubeType::RAW_UNCOMPRESSED : typeDcActive;
     for (auto globalCoord : allCubes) {
         if (loadingNr == Loader::Controller::singleton().loadingNr) {
             startDownload(globalCoord, typeDcOverride, dcDownload, dcDecompression, freeDcSlots, state->Dc2Pointer[loaderMagnification]);
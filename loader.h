@@ -28,6 +28,7 @@
 #include "segmentation/segmentation.h"
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QMutex>
 #include <QNetworkReply>
@@ -41,6 +42,7 @@
 
 #include <boost/multi_array.hpp>
 
+#include <array>
 #include <atomic>
 #include <list>
 #include <unordered_map>
@@ -65,6 +67,56 @@ class Worker;
 namespace Loader {
 class Worker;
 
+/**
+ * @brief Logarithmically binned download latencies (4 bins per octave of milliseconds).
+ * Bins are halved when too many samples accumulated, so the distribution follows changing network conditions.
+ */
+class LatencyHistogram {
+    static constexpr std::size_t binsPerOctave = 4;
+    static constexpr std::size_t maxSamples = 4096;
+    std::array<std::size_t, 17 * binsPerOctave> bins{{}};
+    std::size_t count{0};
+public:
+    void add(const qint64 msec);
+    qint64 percentile(const double fraction) const;
+    std::size_t size() const { return count; }
+};
+
+/**
+ * @brief Running per cube averages of transferred bytes and decode time for one cube encoding.
+ */
+struct EncodingStats {
+    double bytes{0};
+    double decodeMsec{0};
+    std::size_t samples{0};
+    void add(const double cubeBytes, const double msec);
+};
+
+struct DecompressionResult {
+    bool success;
+    char * slot;
+    qint64 decodeMsec;
+};
+
+/**
+ * @brief Counters and events of the loader which are useful to judge its behavior in the field.
+ */
+struct Telemetry {
+    struct EncodingSwitch {
+        qint64 msecSinceStart;
+        Dataset::CubeType from;
+        Dataset::CubeType to;
+        double bytesPerMsec;
+        double rawCostMsec;
+        double compressedCostMsec;
+    };
+    QElapsedTimer uptime;
+    std::size_t requests{0};
+    std::size_t hedges{0};
+    std::size_t hedgesWon{0};
+    std::vector<EncodingSwitch> encodingSwitches;
+};
+
 class Worker : public QObject {
     Q_OBJECT
     friend class Loader::Controller;
@@ -76,7 +128,6 @@ private:
 
     template<typename T>
     using ptr = std::unique_ptr<T>;
-    using DecompressionResult = std::pair<bool, char*>;
     using DecompressionOperationPtr = ptr<QFutureWatcher<DecompressionResult>>;
     std::unordered_map<Coordinate, QNetworkReply*> dcDownload;
     std::unordered_map<Coordinate, QNetworkReply*> ocDownload;
@@ -88,6 +139,29 @@ private:
     std::list<char*> freeOcSlots;
     int currentMaxMetric;
 
+    Telemetry telemetry;// written by the worker thread, guarded by telemetryMutex
+    QMutex telemetryMutex;
+    LatencyHistogram latencyHistogram;
+    // hedged requests: duplicate visible downloads which take longer than the learned latency percentile
+    // the first reply to finish is used, its partner gets aborted
+    std::unordered_map<QNetworkReply*, QNetworkReply*> hedgePartner;
+    double hedgePercentile{0.95};
+    std::size_t hedgeBudgetPercent{5};// maximum extra load
+    std::size_t hedgeMinSamples{20};// don’t hedge before the histogram is meaningful
+
+    // adaptive encoding: fetch raw cubes when decoding is the bottleneck, compressed ones when the link is
+    Dataset::CubeType typeDcActive;
+    EncodingStats rawStats;
+    EncodingStats compressedStats;
+    double bytesPerMsec{0};// effective aggregate throughput
+    std::size_t samplesSinceSwitch{0};
+    std::size_t encodingMinSamples{16};
+    double encodingHysteresis{0.8};// the alternative has to be this much cheaper
+    double compressedDecodeGuessMsec{10};// until a compressed cube has been decoded
+    double compressedRatioGuess{0.1};
+    void updateThroughput(const double bytes, const double msec);
+    void selectDcEncoding();
+
     std::atomic_bool isFinished{false};
     uint loaderMagnification = 0;
     void CalcLoadOrderMetric(float halfSc, floatCoordinate currentMetricPos, floatCoordinate direction, float *metrics);
@@ -145,6 +219,7 @@ public:
     void suspendLoader();
     ~Controller();
     void unloadCurrentMagnification();
+    void availableMagsChanged();
     void enableOverlay() {
         suspendLoader();
         worker->allocateOverlayCubes();
@@ -177,8 +252,15 @@ public:
     void snappyCacheSupplySnappy(Args&&... args) {
         emit snappyCacheSupplySnappySignal(std::forward<Args>(args)...);
     }
-    void markOcCubeAsModified(const CoordOfCube &cubeCoord, const int magnification);
+    /**
+     * @brief marks an overlay cube as modified, globalFirst to globalLast is the (inclusive) box of edited voxels
+     */
+    void markOcCubeAsModified(const CoordOfCube &cubeCoord, const int magnification, const Coordinate & globalFirst, const Coordinate & globalLast);
     decltype(Loader::Worker::snappyCache) getAllModifiedCubes();
+    /**
+     * @brief copy of the counters and events of the current worker, thread-safe
+     */
+    Telemetry telemetry();
 public slots:
     bool isFinished();
 signals:
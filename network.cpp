@@ -34,15 +34,26 @@
 #include <QMessageBox>
 #include <QNetworkCookie>
 #include <QNetworkCookieJar>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
 #include <QProgressDialog>
 #include <QSemaphore>
 #include <QSettings>
+#include <QStandardPaths>
 #include <QTimer>
 #include <QVariantList>
 
+#include <memory>
+
 Network::Network(const QObject *) {
     manager.setCookieJar(&cookieJar);
+    datasetManager.setCookieJar(&cookieJar);
+    cookieJar.setParent(nullptr);//shared between both managers
+    //login, task and file replies carry credentials and user data, so only dataset metadata goes to the disk cache
+    //replies are revalidated with conditional requests (ETag, Last-Modified) when served from the cache
+    auto * cache = new QNetworkDiskCache;
+    cache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/datasets");
+    datasetManager.setCache(cache);//takes ownership
 }
 
 QVariantList Network::getCookiesForHost(const QString & host) {
@@ -59,54 +70,29 @@ void Network::setCookies(const QVariantList & setting) {
     }
 }
 
-std::pair<int, int> Network::checkOnlineMags(const QUrl & url) {
-    int lowestAvailableMag = NUM_MAG_DATASETS;
-    int highestAvailableMag = 0;
-    int maxMagCount = int_log(NUM_MAG_DATASETS) + 1;
-
-    QProgressDialog progress("Network Operation…", "Abort", 0, 100, state->mainWindow);
-    progress.setModal(true);
-    std::vector<qint64> bytesReceivedAll(maxMagCount);
-    std::vector<qint64> bytesTotalAll(maxMagCount);
-    std::vector<std::unique_ptr<QNetworkReply>> replies(maxMagCount);
-    QTimer::singleShot(400, &progress, &QProgressDialog::show);
-
-    QEventLoop pause;
+void Network::checkOnlineMags(const QUrl & url, QObject * context, std::function<void(int, int)> done) {
+    struct Probe {
+        int lowestAvailableMag = NUM_MAG_DATASETS;
+        int highestAvailableMag = 0;
+        int pending = int_log(NUM_MAG_DATASETS) + 1;
+    };
+    auto probe = std::make_shared<Probe>();
     for (int currMag = 1; currMag <= NUM_MAG_DATASETS; currMag *= 2) {
         QUrl magUrl = url;
         magUrl.setPath(QString("%1/mag%2/knossos.conf").arg(url.path()).arg(currMag));
-        auto * replyPtr = manager.get(QNetworkRequest{magUrl});
-        replies[int_log(currMag)] = decltype(replies)::value_type{replyPtr};
-        QObject::connect(replyPtr, &QNetworkReply::finished, [magUrl, &pause, &maxMagCount, currMag, replyPtr, &lowestAvailableMag, &highestAvailableMag]() {
-            auto & reply = *replyPtr;
-            if (reply.error() == QNetworkReply::NoError) {
-                lowestAvailableMag = std::min(lowestAvailableMag, currMag);
-                highestAvailableMag = std::max(highestAvailableMag, currMag);
+        auto * reply = datasetManager.get(QNetworkRequest{magUrl});
+        QObject::connect(reply, &QNetworkReply::finished, context, [probe, currMag, reply, done]() {
+            if (reply->error() == QNetworkReply::NoError) {
+                probe->lowestAvailableMag = std::min(probe->lowestAvailableMag, currMag);
+                probe->highestAvailableMag = std::max(probe->highestAvailableMag, currMag);
             }
-            if (--maxMagCount == 0) {
-                pause.exit();
+            reply->deleteLater();
+            if (--probe->pending == 0) {
+                done(probe->lowestAvailableMag, probe->highestAvailableMag);
             }
         });
-        auto processProgress = [&progress, currMag, &bytesReceivedAll, &bytesTotalAll](qint64 bytesReceived, qint64 bytesTotal){
-            bytesReceivedAll[int_log(currMag)] = bytesReceived;
-            bytesTotalAll[int_log(currMag)] = bytesTotal;
-            const auto received = std::accumulate(std::begin(bytesReceivedAll), std::end(bytesReceivedAll), qint64{0});
-            const auto total = std::accumulate(std::begin(bytesTotalAll), std::end(bytesTotalAll), qint64{0});
-            progress.setRange(0, total);
-            progress.setValue(received);
-        };
-        QObject::connect(replyPtr, &QNetworkReply::downloadProgress, processProgress);
-        QObject::connect(replyPtr, &QNetworkReply::uploadProgress, processProgress);
-        QObject::connect(&progress, &QProgressDialog::canceled, replyPtr, &QNetworkReply::abort);
-    }
-
-    pause.exec();
-
-    if (lowestAvailableMag > highestAvailableMag) {
-        throw std::runtime_error{"no mags detected"};
+        QObject::connect(context, &QObject::destroyed, reply, &QNetworkReply::deleteLater);//deleting a running reply aborts it
     }
-
-    return {lowestAvailableMag, highestAvailableMag};
 }
 
 QPair<bool, QByteArray> blockDownloadExtractData(QNetworkReply & reply) {
@@ -155,6 +141,23 @@ QPair<bool, QString> Network::refresh(const QUrl & url) {
     return blockDownloadExtractData(reply);
 }
 
+QPair<bool, QString> Network::refreshDatasetConfig(const QUrl & url) {
+    auto & reply = *datasetManager.get(QNetworkRequest(url));
+    return blockDownloadExtractData(reply);
+}
+
+void Network::refreshDatasetConfig(const QUrl & url, QObject * context, std::function<void(bool, QString)> done) {
+    auto * reply = datasetManager.get(QNetworkRequest(url));
+    QObject::connect(reply, &QNetworkReply::finished, context, [reply, done]() {
+        if (reply->error() != QNetworkReply::NoError) {
+            qDebug() << reply->errorString();
+        }
+        reply->deleteLater();
+        done(reply->error() == QNetworkReply::NoError, reply->readAll());
+    });
+    QObject::connect(context, &QObject::destroyed, reply, &QNetworkReply::deleteLater);//deleting a running reply aborts it
+}
+
 QPair<bool, QString> Network::login(const QUrl & url, const QString & username, const QString & password) {
     const auto postdata = QString("<login><username>%1</username><password>%2</password><knossos_version>%3</knossos_version></login>").arg(username).arg(password).arg(KVERSION);
     qDebug() << postdata;
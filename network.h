@@ -29,8 +29,11 @@
 #include <QNetworkAccessManager>
 #include <QThread>
 
+#include <functional>
+
 class Network {
     QNetworkAccessManager manager;
+    QNetworkAccessManager datasetManager;//disk cached, only for dataset configs and mag probes
     QNetworkCookieJar cookieJar;
 
 public:
@@ -45,11 +48,13 @@ public:
 
     QPair<bool, QString> login(const QUrl & url, const QString & username, const QString & password);
     QPair<bool, QString> refresh(const QUrl & url);
+    QPair<bool, QString> refreshDatasetConfig(const QUrl & url);
+    void refreshDatasetConfig(const QUrl & url, QObject * context, std::function<void(bool, QString)> done);
     QPair<bool, QPair<QString, QByteArray> > getFile(const QUrl & url);
     QPair<bool, QPair<QString, QByteArray> > getPost(const QUrl & url);
     QPair<bool, QString> submitHeidelbrain(const QUrl & url, const QString & filePath, const QString & comment, const bool final);
     void submitSegmentationJob(const QString &filename);
-    std::pair<int, int> checkOnlineMags(const QUrl & url);
+    void checkOnlineMags(const QUrl & url, QObject * context, std::function<void(int, int)> done);
 };
 
 #endif // NETWORK_H
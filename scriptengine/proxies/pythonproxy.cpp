@@ -220,7 +220,10 @@ float PythonProxy::getMovementAreaFactor() {
 }
 
 void PythonProxy::oc_reslice_notify_all(QList<int> coord) {
-    state->viewer->oc_reslice_notify_all(Coordinate(coord));
+    // the script changed the data of the cube, unlike a loaded cube it may already be uploaded
+    const auto cubeCoord = Coordinate(coord).cube(state->cubeEdgeLength, state->magnification);
+    const auto cubeBegin = cubeCoord.cube2Global(state->cubeEdgeLength, state->magnification);
+    state->viewer->oc_reslice_notify_region(cubeCoord, cubeBegin, cubeBegin + state->cubeEdgeLength * state->magnification - 1);
 }
 
 int PythonProxy::loaderLoadingNr() {
@@ -231,6 +234,27 @@ bool PythonProxy::loaderFinished() {
     return Loader::Controller::singleton().isFinished();
 }
 
+QVariantMap PythonProxy::loaderTelemetry() {
+    const auto telemetry = Loader::Controller::singleton().telemetry();
+    QVariantList encodingSwitches;
+    for (const auto & encodingSwitch : telemetry.encodingSwitches) {
+        encodingSwitches.append(QVariantMap{
+            {"msec_since_start", encodingSwitch.msecSinceStart},
+            {"from", static_cast<int>(encodingSwitch.from)},
+            {"to", static_cast<int>(encodingSwitch.to)},
+            {"bytes_per_msec", encodingSwitch.bytesPerMsec},
+            {"raw_cost_msec", encodingSwitch.rawCostMsec},
+            {"compressed_cost_msec", encodingSwitch.compressedCostMsec}
+        });
+    }
+    return {
+        {"requests", static_cast<qulonglong>(telemetry.requests)},
+        {"hedges", static_cast<qulonglong>(telemetry.hedges)},
+        {"hedges_won", static_cast<qulonglong>(telemetry.hedgesWon)},
+        {"encoding_switches", encodingSwitches}
+    };
+}
+
 void PythonProxy::setMagnificationLock(const bool locked) {
     state->viewer->setMagnificationLock(locked);
 }
@@ -27,6 +27,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QVariantMap>
 #include <QVector>
 
 struct _object;
@@ -76,6 +77,7 @@ public slots:
     void oc_reslice_notify_all(QList<int> coord);
     int loaderLoadingNr();
     bool loaderFinished();
+    QVariantMap loaderTelemetry();
     bool loadStyleSheet(const QString &path);
     void setMagnificationLock(const bool locked);
 
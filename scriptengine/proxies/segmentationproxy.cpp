@@ -24,12 +24,12 @@
 
 #include "segmentation/segmentation.h"
 
-auto & objectFromId(const quint64 objId) {
+uint64_t objectIndexFromId(const quint64 objId) {
     const auto it = Segmentation::singleton().objectIdToIndex.find(objId);
     if (it == std::end(Segmentation::singleton().objectIdToIndex)) {
         throw std::runtime_error(QObject::tr("object with id %1 does not exist").arg(objId).toStdString());
     }
-    return Segmentation::singleton().objects[it->second];
+    return it->second;
 }
 
 void SegmentationProxy::subobjectFromId(const quint64 subObjId, const QList<int> & coord) {
@@ -47,22 +47,21 @@ bool SegmentationProxy::isRenderOnlySelecdedObjs() {
 quint64 SegmentationProxy::largestObjectContainingSubobject(const quint64 subObjId, const QList<int> & coord) {
     const auto & subobject = Segmentation::singleton().subobjectFromId(subObjId, Coordinate(coord));
     const auto objIndex = Segmentation::singleton().largestObjectContainingSubobject(subobject);
-    return Segmentation::singleton().objects[objIndex].id;
+    return Segmentation::singleton().objects.id[objIndex];
 }
 
 QList<quint64> SegmentationProxy::subobjectIdsOfObject(const quint64 objId) {
     QList<quint64> subobjectIds;
-    const auto & obj = objectFromId(objId);
-    for (const auto & elem : obj.subobjects) {
-        subobjectIds.append(elem.get().id);
+    for (const auto * elem : Segmentation::singleton().objects.subobjects(objectIndexFromId(objId))) {
+        subobjectIds.append(elem->id);
     }
     return subobjectIds;
 }
 
 QList<quint64> SegmentationProxy::objects() {
     QList<quint64> objectIds;
-    for (const auto & elem : Segmentation::singleton().objects) {
-        objectIds.append(elem.id);
+    for (const auto id : Segmentation::singleton().objects.id) {
+        objectIds.append(id);
     }
     return objectIds;
 }
@@ -70,21 +69,21 @@ QList<quint64> SegmentationProxy::objects() {
 QList<quint64> SegmentationProxy::selectedObjects() {
     QList<quint64> selectedIds;
     for (const auto index : Segmentation::singleton().selectedObjectIndices) {
-        selectedIds.append(Segmentation::singleton().objects[index].id);
+        selectedIds.append(Segmentation::singleton().objects.id[index]);
     }
     return selectedIds;
 }
 
 void SegmentationProxy::addSubobject(const quint64 objId, const quint64 subobjectId) {
-    Segmentation::singleton().newSubObject(objectFromId(objId), subobjectId);
+    Segmentation::singleton().newSubObject(objectIndexFromId(objId), subobjectId);
 }
 
 void SegmentationProxy::changeComment(const quint64 objId, const QString & comment) {
-    Segmentation::singleton().changeComment(objectFromId(objId), comment);
+    Segmentation::singleton().changeComment(objectIndexFromId(objId), comment);
 }
 
 void SegmentationProxy::changeColor(const quint64 objId, const QColor & color) {
-    Segmentation::singleton().changeColor(objectFromId(objId), std::make_tuple(color.red(), color.green(), color.blue()));
+    Segmentation::singleton().changeColor(objectIndexFromId(objId), std::make_tuple(color.red(), color.green(), color.blue()));
 }
 
 void SegmentationProxy::createObject(const quint64 objId, const quint64 initialSubobjectId, const QList<int> & location, const bool todo, const bool immutable) {
@@ -92,21 +91,21 @@ void SegmentationProxy::createObject(const quint64 objId, const quint64 initialS
 }
 
 void SegmentationProxy::removeObject(const quint64 objId) {
-    Segmentation::singleton().removeObject(objectFromId(objId));
+    Segmentation::singleton().removeObject(objectIndexFromId(objId));
 }
 
 void SegmentationProxy::selectObject(const quint64 objId) {
-    Segmentation::singleton().selectObject(objectFromId(objId));
+    Segmentation::singleton().selectObject(objectIndexFromId(objId));
 }
 
 void SegmentationProxy::unselectObject(const quint64 objId) {
-    Segmentation::singleton().unselectObject(objectFromId(objId));
+    Segmentation::singleton().unselectObject(objectIndexFromId(objId));
 }
 
 void SegmentationProxy::jumpToObject(const quint64 objId) {
-    Segmentation::singleton().jumpToObject(objectFromId(objId));
+    Segmentation::singleton().jumpToObject(objectIndexFromId(objId));
 }
 
 QList<int> SegmentationProxy::objectLocation(const quint64 objId) {
-    return objectFromId(objId).location.list();
+    return Segmentation::singleton().objects.location[objectIndexFromId(objId)].list();
 }
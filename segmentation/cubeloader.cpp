@@ -54,6 +54,18 @@ uint64_t readVoxel(const Coordinate & pos) {
     return getCubeRef(cubeIt.second)[inCube.z][inCube.y][inCube.x];
 }
 
+uint64_t readVoxelPinned(const Coordinate & pos) {
+    if (Session::singleton().outsideMovementArea(pos) || !Segmentation::enabled) {
+        return Segmentation::singleton().getBackgroundId();
+    }
+    auto * rawcube = Coordinate2BytePtr_hash_get_or_fail(state->Oc2Pointer[int_log(state->magnification)], pos.cube(state->cubeEdgeLength, state->magnification));
+    if (rawcube == nullptr) {
+        return Segmentation::singleton().getBackgroundId();
+    }
+    const auto inCube = pos.insideCube(state->cubeEdgeLength, state->magnification);
+    return getCubeRef(rawcube)[inCube.z][inCube.y][inCube.x];
+}
+
 bool writeVoxel(const Coordinate & pos, const uint64_t value, bool isMarkChanged) {
     auto cubeIt = getRawCube(pos);
     if (Session::singleton().outsideMovementArea(pos) || !Segmentation::enabled || !cubeIt.first) {
@@ -62,7 +74,7 @@ bool writeVoxel(const Coordinate & pos, const uint64_t value, bool isMarkChanged
     const auto inCube = pos.insideCube(state->cubeEdgeLength, state->magnification);
     getCubeRef(cubeIt.second)[inCube.z][inCube.y][inCube.x] = value;
     if (isMarkChanged) {
-        Loader::Controller::singleton().markOcCubeAsModified(pos.cube(state->cubeEdgeLength, state->magnification), state->magnification);
+        Loader::Controller::singleton().markOcCubeAsModified(pos.cube(state->cubeEdgeLength, state->magnification), state->magnification, pos, pos);
     }
     return true;
 }
@@ -98,7 +110,14 @@ std::pair<Coordinate, Coordinate> getRegion(const floatCoordinate & centerPos, c
 
 void coordCubesMarkChanged(const CubeCoordSet & cubeChangeSet) {
     for (auto &cubeCoord : cubeChangeSet) {
-        Loader::Controller::singleton().markOcCubeAsModified(cubeCoord, state->magnification);
+        const auto globalFirst = cubeCoord.cube2Global(state->cubeEdgeLength, state->magnification);
+        Loader::Controller::singleton().markOcCubeAsModified(cubeCoord, state->magnification, globalFirst, globalFirst + state->cubeEdgeLength * state->magnification - 1);
+    }
+}
+
+void coordCubesMarkChanged(const CubeCoordSet & cubeChangeSet, const Coordinate & globalFirst, const Coordinate & globalLast) {
+    for (auto &cubeCoord : cubeChangeSet) {
+        Loader::Controller::singleton().markOcCubeAsModified(cubeCoord, state->magnification, globalFirst, globalLast);// clipped to the cube by the viewer
     }
 }
 
@@ -226,7 +245,8 @@ void writeVoxels(const Coordinate & centerPos, const uint64_t value, const brush
         for (auto &elem : cubeChangeSetWholeCube) {
             cubeChangeSet.emplace(elem);
         }
-        coordCubesMarkChanged(cubeChangeSet);
+        const auto region = getRegion(centerPos, brush);
+        coordCubesMarkChanged(cubeChangeSet, region.first, region.second);
     }
 }
 
@@ -238,7 +258,7 @@ CubeCoordSet processRegionByStridedBuf(const Coordinate & globalFirst, const Coo
                 voxel = reinterpret_cast<const uint64_t &>(data[(globalPos - globalFirst).componentMul(strides).sum()]);
             });
         if (markChanged) {
-            coordCubesMarkChanged(cubeChangeSet);
+            coordCubesMarkChanged(cubeChangeSet, globalFirst, globalLast);
         }
     }
     else {
@@ -257,5 +277,5 @@ void listFill(const Coordinate & centerPos, const brush_t & brush, const uint64_
             voxel = fillsoid;
         }
     });
-    coordCubesMarkChanged(cubeChangeSet);
+    coordCubesMarkChanged(cubeChangeSet, region.first, region.second);
 }
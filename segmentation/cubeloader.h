@@ -36,7 +36,9 @@ using subobjectRetrievalMap = std::unordered_map<uint64_t, Coordinate>;
 bool isInsideSphere(const double xi, const double yi, const double zi, const double radius);
 
 void coordCubesMarkChanged(const CubeCoordSet & cubeChangeSet);
+void coordCubesMarkChanged(const CubeCoordSet & cubeChangeSet, const Coordinate & globalFirst, const Coordinate & globalLast);
 uint64_t readVoxel(const Coordinate & pos);
+uint64_t readVoxelPinned(const Coordinate & pos);// protectCube2Pointer has to be locked
 subobjectRetrievalMap readVoxels(const Coordinate & centerPos, const brush_t &);
 bool writeVoxel(const Coordinate & pos, const uint64_t value, bool isMarkChanged = true);
 void writeVoxels(const Coordinate & centerPos, const uint64_t value, const brush_t &, bool isMarkChanged = true);
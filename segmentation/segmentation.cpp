@@ -31,62 +31,188 @@
 #include <QTextStream>
 
 #include <algorithm>
+#include <cassert>
 #include <fstream>
 #include <sstream>
+#include <type_traits>
 #include <utility>
 
 bool Segmentation::enabled = false;
 uint64_t Segmentation::SubObject::highestId = 0;
-uint64_t Segmentation::Object::highestId = 0;
-uint64_t Segmentation::Object::highestIndex = -1;
+uint64_t Segmentation::highestObjectId = 0;
 
-Segmentation::Object::Object(std::vector<std::reference_wrapper<SubObject>> initialVolumes, const Coordinate & location, const uint64_t id, const bool & todo, const bool & immutable)
-    : id(id), todo(todo), immutable(immutable), location(location) {
-    highestId = std::max(id, highestId);
-    for (auto & elem : initialVolumes) {
-        addExistingSubObject(elem);
-    }
-    std::sort(std::begin(subobjects), std::end(subobjects));
+namespace {
+const auto subobjectOrder = [](const auto * lhs, const auto * rhs){
+    return lhs->id < rhs->id;
+};
 }
 
-Segmentation::Object::Object(Object & first, Object & second)
-    : id(++highestId), todo(false), immutable(false), location(second.location), selected{true} { //merge is selected
-    subobjects.reserve(first.subobjects.size() + second.subobjects.size());
-    merge(first);
-    merge(second);
-    subobjects.shrink_to_fit();
+uint64_t Segmentation::Objects::append(const uint64_t id, const Coordinate & location, const bool todo, const bool immutable, const bool selected) {
+    uint32_t newSlot;
+    if (freeSlots.empty()) {
+        newSlot = slotRow.size();
+        slotRow.emplace_back();
+        slotGeneration.emplace_back(1);
+    } else {
+        newSlot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    const auto index = size();
+    slotRow[newSlot] = index;
+    slot.emplace_back(newSlot);
+    subobjectsBegin.emplace_back(subobjectPool.size());
+    subobjectsCount.emplace_back(0);
+    this->id.emplace_back(id);
+    this->location.emplace_back(location);
+    category.emplace_back(0);//the empty category is interned first
+    comment.emplace_back();
+    color.emplace_back();
+    this->todo.emplace_back(todo);
+    this->immutable.emplace_back(immutable);
+    this->selected.emplace_back(selected);
+    return index;
+}
+
+void Segmentation::Objects::swapWithLast(const uint64_t index) {
+    const auto last = size() - 1;
+    const auto swapRows = [index, last](auto & column){
+        typename std::decay_t<decltype(column)>::value_type tmp = std::move(column[index]);//not a std::vector<bool> reference
+        column[index] = std::move(column[last]);
+        column[last] = std::move(tmp);
+    };
+    swapRows(slot);
+    swapRows(subobjectsBegin);
+    swapRows(subobjectsCount);
+    swapRows(id);
+    swapRows(location);
+    swapRows(category);
+    swapRows(comment);
+    swapRows(color);
+    swapRows(todo);
+    swapRows(immutable);
+    swapRows(selected);
+    slotRow[slot[index]] = index;
+    slotRow[slot[last]] = last;
+}
+
+void Segmentation::Objects::removeLast() {
+    ++slotGeneration[slot.back()];//invalidates the handles of the object
+    freeSlots.emplace_back(slot.back());
+    if (subobjectsBegin.back() + subobjectsCount.back() == subobjectPool.size()) {//the last range is given back directly
+        subobjectPool.resize(subobjectsBegin.back());
+    } else {
+        unusedSubobjects += subobjectsCount.back();
+    }
+    slot.pop_back();
+    subobjectsBegin.pop_back();
+    subobjectsCount.pop_back();
+    id.pop_back();
+    location.pop_back();
+    category.pop_back();
+    comment.pop_back();
+    color.pop_back();
+    todo.pop_back();
+    immutable.pop_back();
+    selected.pop_back();
+    compactSubobjects();
+}
+
+void Segmentation::Objects::clear() {
+    *this = Objects{};
+}
+
+void Segmentation::Objects::appendSubobject(const uint64_t index, SubObject & subobject) {
+    const auto begin = subobjectsBegin[index];
+    const auto count = subobjectsCount[index];
+    if (begin + count != subobjectPool.size()) {//only the last range can grow, move this one behind it
+        subobjectsBegin[index] = subobjectPool.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto elem = subobjectPool[begin + i];
+            subobjectPool.emplace_back(elem);
+        }
+        unusedSubobjects += count;
+    }
+    subobjectPool.emplace_back(&subobject);
+    ++subobjectsCount[index];
 }
 
-bool Segmentation::Object::operator==(const Segmentation::Object & other) const {
-    return index == other.index;
+void Segmentation::Objects::sortSubobjects(const uint64_t index) {
+    const auto begin = std::begin(subobjectPool) + subobjectsBegin[index];
+    std::sort(begin, begin + subobjectsCount[index], subobjectOrder);
 }
 
-void Segmentation::Object::addExistingSubObject(Segmentation::SubObject & sub) {
-    const auto objectPosIt = std::lower_bound(std::begin(sub.objects), std::end(sub.objects), this->index);
-    if (objectPosIt != std::end(sub.objects) && *objectPosIt == this->index) {
-        throw std::runtime_error(tr("object %1 already contains subobject %2").arg(this->id).arg(sub.id).toStdString());
+void Segmentation::Objects::replaceSubobjects(const uint64_t index, const std::vector<SubObject *> & subobjects) {
+    const auto count = subobjectsCount[index];
+    const bool last = subobjectsBegin[index] + count == subobjectPool.size();
+    if (subobjects.size() > count && !last) {//doesn’t fit, move behind the last range
+        unusedSubobjects += count;
+        subobjectsBegin[index] = subobjectPool.size();
     }
-    sub.objects.emplace(objectPosIt, this->index);//register parent
-    subobjects.emplace_back(sub);//add child
+    const auto begin = subobjectsBegin[index];
+    if (begin + subobjects.size() > subobjectPool.size() || last) {
+        subobjectPool.resize(begin + subobjects.size());
+    } else {
+        unusedSubobjects += count - subobjects.size();
+    }
+    std::copy(std::begin(subobjects), std::end(subobjects), std::begin(subobjectPool) + begin);
+    subobjectsCount[index] = subobjects.size();
+    compactSubobjects();
 }
 
-Segmentation::Object & Segmentation::Object::merge(Segmentation::Object & other) {
-    for (auto & elem : other.subobjects) {//add parent
-        auto & parentObjs = elem.get().objects;
-        elem.get().selectedObjectsCount = 1;
-        //don’t insert twice
-        auto posIt = std::lower_bound(std::begin(parentObjs), std::end(parentObjs), this->index);
-        if (posIt == std::end(parentObjs) || *posIt != this->index) {
-            parentObjs.emplace(posIt, this->index);
+/**
+ * @brief Objects::mergeSubobjects adds the subobjects of other to those of the object with index, both stay sorted and unique
+ *
+ * The range of the object grows in place if it’s the last one in the pool, otherwise both ranges are merged behind the last one.
+ * No intermediate vector is built in either case.
+ */
+void Segmentation::Objects::mergeSubobjects(const uint64_t index, const uint64_t other) {
+    const auto otherBegin = subobjectsBegin[other];
+    const auto otherCount = subobjectsCount[other];
+    auto begin = subobjectsBegin[index];
+    const auto count = subobjectsCount[index];
+    if (begin + count == subobjectPool.size()) {//merge from the back into the grown range, the other range lies before it
+        subobjectPool.resize(subobjectPool.size() + otherCount);
+        auto first = count;
+        auto second = otherCount;
+        for (auto out = count + otherCount; second > 0;) {
+            if (first > 0 && subobjectOrder(subobjectPool[otherBegin + second - 1], subobjectPool[begin + first - 1])) {
+                subobjectPool[begin + --out] = subobjectPool[begin + --first];
+            } else {
+                subobjectPool[begin + --out] = subobjectPool[otherBegin + --second];
+            }
         }
+    } else {
+        const auto newBegin = subobjectPool.size();
+        subobjectPool.resize(newBegin + count + otherCount);
+        const auto pool = std::begin(subobjectPool);
+        std::merge(pool + begin, pool + begin + count, pool + otherBegin, pool + otherBegin + otherCount, pool + newBegin, subobjectOrder);
+        unusedSubobjects += count;
+        subobjectsBegin[index] = begin = newBegin;
+    }
+    //the merged range is the last one, so duplicates are erased from the end of the pool
+    const auto rangeBegin = std::begin(subobjectPool) + begin;
+    const auto uniqueEnd = std::unique(rangeBegin, rangeBegin + count + otherCount);
+    subobjectsCount[index] = uniqueEnd - rangeBegin;
+    subobjectPool.erase(uniqueEnd, std::end(subobjectPool));
+    compactSubobjects();
+}
+
+/**
+ * @brief Objects::compactSubobjects rebuilds the pool in row order once unused ranges take up more than half of it
+ */
+void Segmentation::Objects::compactSubobjects() {
+    if (unusedSubobjects < 1024 || 2 * unusedSubobjects < subobjectPool.size()) {
+        return;
     }
-    decltype(subobjects) tmp;
-    tmp.reserve(subobjects.size() + other.subobjects.size());
-    std::merge(std::begin(subobjects), std::end(subobjects), std::begin(other.subobjects), std::end(other.subobjects), std::back_inserter(tmp));
-    tmp.shrink_to_fit();
-    std::swap(subobjects, tmp);
-    subobjects.erase(std::unique(std::begin(subobjects), std::end(subobjects)), std::end(subobjects));
-    return *this;
+    std::vector<SubObject *> pool;
+    pool.reserve(subobjectPool.size() - std::min(unusedSubobjects, subobjectPool.size()));
+    for (std::size_t index = 0; index < size(); ++index) {
+        const auto begin = std::begin(subobjectPool) + subobjectsBegin[index];
+        subobjectsBegin[index] = pool.size();
+        pool.insert(std::end(pool), begin, begin + subobjectsCount[index]);
+    }
+    subobjectPool = std::move(pool);
+    unusedSubobjects = 0;
 }
 
 Segmentation & Segmentation::singleton() {
@@ -95,6 +221,7 @@ Segmentation & Segmentation::singleton() {
 }
 
 Segmentation::Segmentation() {
+    resetCategories();
     loadOverlayLutFromFile();
 }
 
@@ -108,12 +235,15 @@ void Segmentation::clear() {
     selectedObjectIndices.clear();
     objects.clear();
     objectIdToIndex.clear();
-    Object::highestId = 0;
-    Object::highestIndex = -1;
+    todoCount = 0;
+    todoCursor = 0;
+    lastTodoObject = {};
+    highestObjectId = 0;
     SubObject::highestId = 0;
     subobjects.clear();
     touched_subobject_id = 0;
-    categories = prefixed_categories;
+    resetCategories();
+    ++changeCounter;
 
     if (Loader::Controller::singleton().worker != nullptr) {
         //dispatch to loader thread, original cubes are reloaded automatically
@@ -132,6 +262,7 @@ std::tuple<uint8_t, uint8_t, uint8_t, uint8_t> Segmentation::subobjectColor(cons
 
 void Segmentation::loadOverlayLutFromFile(const QString & path) {
     overlayColorMap = loadLookupTable(path);
+    ++changeCounter;
     emit resetData();
 }
 
@@ -141,88 +272,246 @@ bool Segmentation::hasObjects() const {
 
 void Segmentation::createAndSelectObject(const Coordinate & position) {
     clearObjectSelection();
-    auto & newObject = createObjectFromSubobjectId(SubObject::highestId + 1, position);
-    selectObject(newObject);
+    selectObject(createObjectFromSubobjectId(SubObject::highestId + 1, position));
 }
 
-Segmentation::Object & Segmentation::createObjectFromSubobjectId(const uint64_t initialSubobjectId, const Coordinate & location, const uint64_t objectId, const bool todo, const bool immutable) {
+uint64_t Segmentation::createObjectFromSubobjectId(const uint64_t initialSubobjectId, const Coordinate & location, const uint64_t objectId, const bool todo, const bool immutable) {
     if (objectIdToIndex.find(objectId) != std::end(objectIdToIndex)) {
         throw std::runtime_error(tr("object with id %1 already exists").arg(objectId).toStdString());
     }
     //first is iterator to the newly inserted key-value pair or the already existing value
     auto subobjectIt = subobjects.emplace(std::piecewise_construct, std::forward_as_tuple(initialSubobjectId), std::forward_as_tuple(initialSubobjectId)).first;
-    return createObject(std::vector<std::reference_wrapper<SubObject>>{subobjectIt->second}, location, objectId, todo, immutable);
+    return createObject({&subobjectIt->second}, location, objectId, todo, immutable);
 }
 
-template<typename... Args>
-Segmentation::Object & Segmentation::createObject(Args &&... args) {
+uint64_t Segmentation::createObject(const std::vector<SubObject *> & initialSubobjects, const Coordinate & location, const uint64_t objectId, const bool todo, const bool immutable) {
     emit beforeAppendRow();
-    objects.emplace_back(std::forward<Args>(args)...);
-    objectIdToIndex[objects.back().id] = objects.size() - 1;
+    highestObjectId = std::max(objectId, highestObjectId);
+    const auto index = objects.append(objectId, location, todo, immutable, false);
+    for (auto * subobject : initialSubobjects) {
+        addExistingSubObject(index, *subobject);
+    }
+    objects.sortSubobjects(index);
+    objectIdToIndex[objectId] = index;
+    todoCount += todo;//appended behind the cursor, which stays valid
+    updateLargestObjects(index);
     emit appendedRow();
-    return objects.back();
+    return index;
 }
 
-void Segmentation::removeObject(Object & object) {
-    unselectObject(object);
-    for (auto & elem : object.subobjects) {
-        auto & subobject = elem.get();
-        subobject.objects.erase(std::remove(std::begin(subobject.objects), std::end(subobject.objects), object.index), std::end(subobject.objects));
-        if (subobject.objects.empty()) {
-            subobjects.erase(subobject.id);
+/**
+ * @brief Segmentation::createMergedObject appends a selected object which contains the subobjects of both objects
+ */
+uint64_t Segmentation::createMergedObject(const uint64_t firstIndex, const uint64_t secondIndex) {
+    emit beforeAppendRow();
+    const auto location = objects.location[secondIndex];
+    const auto index = objects.append(++highestObjectId, location, false, false, true);//merge is selected
+    mergeObject(index, firstIndex);
+    mergeObject(index, secondIndex);
+    objectIdToIndex[objects.id[index]] = index;
+    updateLargestObjects(index);
+    emit appendedRow();
+    return index;
+}
+
+/**
+ * @brief Segmentation::addExistingSubObject registers the object with the subobject, sort its subobjects once all are added
+ */
+void Segmentation::addExistingSubObject(const uint64_t objectIndex, SubObject & subobject) {
+    const auto slot = objects.slot[objectIndex];
+    const auto slotIt = std::lower_bound(std::begin(subobject.objectSlots), std::end(subobject.objectSlots), slot);
+    if (slotIt != std::end(subobject.objectSlots) && *slotIt == slot) {
+        throw std::runtime_error(tr("object %1 already contains subobject %2").arg(objects.id[objectIndex]).arg(subobject.id).toStdString());
+    }
+    subobject.objectSlots.emplace(slotIt, slot);//register parent
+    objects.appendSubobject(objectIndex, subobject);//add child
+}
+
+void Segmentation::mergeObject(const uint64_t objectIndex, const uint64_t otherIndex) {
+    const auto slot = objects.slot[objectIndex];
+    for (auto * subobject : objects.subobjects(otherIndex)) {//add parent
+        auto & parentSlots = subobject->objectSlots;
+        subobject->selectedObjectsCount = 1;
+        //don’t insert twice
+        auto posIt = std::lower_bound(std::begin(parentSlots), std::end(parentSlots), slot);
+        if (posIt == std::end(parentSlots) || *posIt != slot) {
+            parentSlots.emplace(posIt, slot);
+        }
+    }
+    objects.mergeSubobjects(objectIndex, otherIndex);
+}
+
+Segmentation::ObjectHandle Segmentation::objectHandle(const uint64_t objectIndex) const {
+    const auto slot = objects.slot[objectIndex];
+    return {slot, objects.slotGeneration[slot]};
+}
+
+boost::optional<uint64_t> Segmentation::objectIndex(const ObjectHandle handle) const {
+    if (handle.slot < objects.slotGeneration.size() && objects.slotGeneration[handle.slot] == handle.generation) {
+        return objects.slotRow[handle.slot];
+    }
+    return boost::none;//the object was removed
+}
+
+uint64_t Segmentation::objectIndexOfSlot(const uint32_t slot) const {
+    return objects.slotRow[slot];
+}
+
+void Segmentation::removeObject(const uint64_t objectIndex) {
+    unselectObject(objectIndex);
+    const auto slot = objects.slot[objectIndex];
+    for (auto * subobject : objects.subobjects(objectIndex)) {
+        auto & parentSlots = subobject->objectSlots;
+        parentSlots.erase(std::lower_bound(std::begin(parentSlots), std::end(parentSlots), slot));
+        if (parentSlots.empty()) {
+            subobjects.erase(subobject->id);
+        } else if (subobject->largestObject == slot) {
+            updateLargestObject(*subobject);
         }
     }
     //swap with last, so no intermediate rows need to be deleted
-    if (objects.size() > 1 && object.index != objects.back().index) {
-        //replace object index in subobjects
-        for (auto & elem : objects.back().subobjects) {
-            auto & subobject = elem.get();
-            std::replace(std::begin(subobject.objects), std::end(subobject.objects), objects.back().index, object.index);
+    const auto lastIndex = objects.size() - 1;
+    if (objectIndex != lastIndex) {
+        if (objects.todo[lastIndex]) {//the last row moves in front of the cursor
+            todoCursor = std::min(todoCursor, objectIndex);
         }
-        //replace object index in selected objects
-        selectedObjectIndices.replace(objects.back().index, object.index);
-        std::swap(objects.back().index, object.index);
-        std::swap(objects.back(), object);
-        std::swap(objectIdToIndex[objects.back().id], objectIdToIndex[object.id]);
-        emit changedRow(object.index);//object now references the former end
-        emit changedRowSelection(object.index);//object now references the former end
-        emit changedRowSelection(objects.back().index);//object now references the former end
+        //replace object index in selected objects, subobjects refer to objects by slot and need no update
+        selectedObjectIndices.replace(lastIndex, objectIndex);
+        std::swap(objectIdToIndex[objects.id[lastIndex]], objectIdToIndex[objects.id[objectIndex]]);
+        objects.swapWithLast(objectIndex);
+        emit changedRow(objectIndex);//objectIndex now references the former end
+        emit changedRowSelection(objectIndex);
+        emit changedRowSelection(lastIndex);
     }
     emit beforeRemoveRow();
     //the last element is the one which gets removed
-    if (objects.back().id == Object::highestId) {
-        --Object::highestId;//reassign highest object id if it was removed before
+    if (objects.id.back() == highestObjectId) {
+        --highestObjectId;//reassign highest object id if it was removed before
     }
-    objectIdToIndex.erase(objects.back().id);
-    objects.pop_back();
+    objectIdToIndex.erase(objects.id.back());
+    todoCount -= objects.todo.back();
+    objects.removeLast();
+    todoCursor = std::min(todoCursor, objects.size());
+    ++changeCounter;
     emit removedRow();
-    --Object::highestIndex;
 }
 
-void Segmentation::changeCategory(Object & obj, const QString & category) {
-    obj.category = category;
-    emit changedRow(obj.index);
-    categories.insert(category);
+void Segmentation::resetCategories() {
+    categories.clear();
+    categoryIndices.clear();
+    for (const auto & category : prefixed_categories) {
+        internCategory(category);
+    }
+}
+
+uint32_t Segmentation::internCategory(const QString & category) {
+    const auto it = categoryIndices.find(category);
+    if (it != std::end(categoryIndices)) {
+        return it.value();
+    }
+    categoryIndices.insert(category, categories.size());
+    categories.emplace_back(category);
+    return categories.size() - 1;
+}
+
+void Segmentation::changeCategory(const uint64_t objectIndex, const QString & category) {
+    objects.category[objectIndex] = internCategory(category);
+    emit changedRow(objectIndex);
     emit categoriesChanged();
 }
 
-void Segmentation::changeColor(Object &obj, const std::tuple<uint8_t, uint8_t, uint8_t> & color) {
-    obj.color = color;
-    emit changedRow(obj.index);
+void Segmentation::changeColor(const uint64_t objectIndex, const std::tuple<uint8_t, uint8_t, uint8_t> & color) {
+    objects.color[objectIndex] = color;
+    ++changeCounter;
+    emit changedRow(objectIndex);
+}
+
+void Segmentation::changeComment(const uint64_t objectIndex, const QString & comment) {
+    objects.comment[objectIndex] = comment;
+    emit changedRow(objectIndex);
 }
 
-void Segmentation::changeComment(Object & obj, const QString & comment) {
-    obj.comment = comment;
-    emit changedRow(obj.index);
+void Segmentation::changeImmutable(const uint64_t objectIndex, const bool immutable) {
+    objects.immutable[objectIndex] = immutable;
+    updateLargestObjects(objectIndex);
+    emit changedRow(objectIndex);
 }
 
-void Segmentation::newSubObject(Object & obj, uint64_t subObjID) {
+void Segmentation::setTodo(const uint64_t objectIndex, const bool todo) {
+    if (objects.todo[objectIndex] != todo) {
+        objects.todo[objectIndex] = todo;
+        if (todo) {
+            ++todoCount;
+            todoCursor = std::min(todoCursor, objectIndex);
+        } else {
+            --todoCount;
+        }
+    }
+    ++changeCounter;
+    emit changedRow(objectIndex);
+}
+
+void Segmentation::rebuildTodoIndex() {
+    todoCount = std::count(std::begin(objects.todo), std::end(objects.todo), true);
+    todoCursor = 0;
+}
+
+boost::optional<uint64_t> Segmentation::nextTodoIndex() {
+    if (todoCount == 0) {
+        todoCursor = objects.size();
+        return boost::none;
+    }
+    //rows are only skipped once until a todo flag is set in front of the cursor again
+    while (!objects.todo[todoCursor]) {
+        ++todoCursor;
+    }
+    return todoCursor;
+}
+
+void Segmentation::newSubObject(const uint64_t objectIndex, uint64_t subObjID) {
     auto subobjectIt = subobjects.emplace(std::piecewise_construct, std::forward_as_tuple(subObjID), std::forward_as_tuple(subObjID)).first;
-    obj.addExistingSubObject(subobjectIt->second);
+    addExistingSubObject(objectIndex, subobjectIt->second);
+    objects.sortSubobjects(objectIndex);
+    updateLargestObjects(objectIndex);
+    emit changedRow(objectIndex);
+}
+
+bool Segmentation::slotOrder(const uint32_t lhs, const uint32_t rhs) const {
+    return objectOrder(objects.slotRow[lhs], objects.slotRow[rhs]);
+}
+
+/**
+ * @brief Segmentation::updateLargestObject recomputes the cached largest object of a subobject from all its objects
+ */
+void Segmentation::updateLargestObject(SubObject & subobject) {
+    const auto comparator = [this](const uint32_t lhs, const uint32_t rhs){ return slotOrder(lhs, rhs); };
+    subobject.largestObject = *std::max_element(std::begin(subobject.objectSlots), std::end(subobject.objectSlots), comparator);
+}
+
+/**
+ * @brief Segmentation::updateLargestObjects updates the subobjects of an object after its size or immutability changed
+ *
+ * Only the object itself moved in the order, so it either becomes the largest object of a subobject
+ * or, if it already was, another object might have overtaken it.
+ */
+void Segmentation::updateLargestObjects(const uint64_t objectIndex) {
+    ++changeCounter;// called whenever objects or their subobjects change
+    const auto slot = objects.slot[objectIndex];
+    for (auto * subobject : objects.subobjects(objectIndex)) {
+        const auto largest = subobject->largestObject;
+        if (subobject->objectSlots.size() == 1) {
+            subobject->largestObject = slot;
+        } else if (largest == slot) {
+            updateLargestObject(*subobject);
+        } else if (slotOrder(largest, slot) || (!slotOrder(slot, largest) && slot < largest)) {
+            subobject->largestObject = slot;// max_element keeps the first of equally large objects
+        }
+    }
 }
 
 void Segmentation::setRenderOnlySelectedObjs(const bool onlySelected) {
     renderOnlySelectedObjs = onlySelected;
+    ++changeCounter;
     emit renderOnlySelectedObjsChanged(renderOnlySelectedObjs);
 }
 
@@ -231,14 +520,16 @@ decltype(Segmentation::backgroundId) Segmentation::getBackgroundId() const {
 }
 
 void Segmentation::setBackgroundId(decltype(backgroundId) newBackgroundId) {
-    emit backgroundIdChanged(backgroundId = newBackgroundId);
+    backgroundId = newBackgroundId;
+    ++changeCounter;
+    emit backgroundIdChanged(backgroundId);
 }
 
 std::tuple<uint8_t, uint8_t, uint8_t, uint8_t> Segmentation::colorObjectFromIndex(const uint64_t objectIndex) const {
-    if (objects[objectIndex].color) {
-        return std::tuple_cat(objects[objectIndex].color.get(), std::make_tuple(alpha));
+    if (objects.color[objectIndex]) {
+        return std::tuple_cat(objects.color[objectIndex].get(), std::make_tuple(alpha));
     } else {
-        const auto & objectId = objects[objectIndex].id;
+        const auto & objectId = objects.id[objectIndex];
         const auto colorIndex = objectId % overlayColorMap.size();
         return std::tuple_cat(overlayColorMap[colorIndex], std::make_tuple(alpha));
     }
@@ -255,10 +546,10 @@ std::tuple<uint8_t, uint8_t, uint8_t, uint8_t> Segmentation::colorOfSelectedObje
     if (subobject.selectedObjectsCount > 1) {
         return std::make_tuple(std::uint8_t{255}, std::uint8_t{0}, std::uint8_t{0}, alpha);//mark overlapping objects in red
     }
-    const auto objectIndex = *std::find_if(std::begin(subobject.objects), std::end(subobject.objects), [this](const uint64_t index){
-        return objects[index].selected;
+    const auto slot = *std::find_if(std::begin(subobject.objectSlots), std::end(subobject.objectSlots), [this](const uint32_t slot){
+        return objects.selected[objects.slotRow[slot]];
     });
-    return colorObjectFromIndex(objectIndex);
+    return colorObjectFromIndex(objects.slotRow[slot]);
 }
 
 std::tuple<uint8_t, uint8_t, uint8_t, uint8_t> Segmentation::colorObjectFromSubobjectId(const uint64_t subObjectID) const {
@@ -287,11 +578,21 @@ bool Segmentation::subobjectExists(const uint64_t & subobjectId) const {
     return it != std::end(subobjects);
 }
 
+std::vector<uint64_t> Segmentation::subobjectIdsOfObjectIndex(const uint64_t objectIndex) const {
+    std::vector<uint64_t> ids;
+    if (objectIndex < objects.size()) {
+        for (const auto * subobject : objects.subobjects(objectIndex)) {
+            ids.emplace_back(subobject->id);
+        }
+    }
+    return ids;
+}
+
 uint64_t Segmentation::subobjectIdOfFirstSelectedObject(const Coordinate & newLocation) {
     if (selectedObjectsCount() != 0) {
-        auto & obj = objects[selectedObjectIndices.front()];
-        obj.location = newLocation;
-        return obj.subobjects.front().get().id;
+        const auto index = selectedObjectIndices.front();
+        objects.location[index] = newLocation;
+        return objects.subobjects(index).front().id;
     } else {
         throw std::runtime_error("no objects selected for subobject retrieval");
     }
@@ -307,10 +608,10 @@ Segmentation::SubObject & Segmentation::subobjectFromId(const uint64_t & subobje
 }
 
 bool Segmentation::objectOrder(const uint64_t & lhsIndex, const uint64_t & rhsIndex) const {
-    const auto & lhs = objects[lhsIndex];
-    const auto & rhs = objects[rhsIndex];
+    const bool lhsImmutable = objects.immutable[lhsIndex];
+    const bool rhsImmutable = objects.immutable[rhsIndex];
     //operator< substitute, prefer immutable objects and choose the smallest
-    return (lhs.immutable && !rhs.immutable) || (lhs.immutable == rhs.immutable && lhs.subobjects.size() < rhs.subobjects.size());
+    return (lhsImmutable && !rhsImmutable) || (lhsImmutable == rhsImmutable && objects.subobjectsCount[lhsIndex] < objects.subobjectsCount[rhsIndex]);
 }
 
 uint64_t Segmentation::largestObjectContainingSubobjectId(const uint64_t subObjectId, const Coordinate & location) {
@@ -319,11 +620,13 @@ uint64_t Segmentation::largestObjectContainingSubobjectId(const uint64_t subObje
 }
 
 uint64_t Segmentation::largestObjectContainingSubobject(const Segmentation::SubObject & subobject) const {
+#ifndef NDEBUG
     //same comparator for both functions, it seems to work as it is, so i don’t waste my head now to find out why
     //there may have been some reasoning… (at first glance it seems too restrictive for the largest object)
-    auto comparator = std::bind(&Segmentation::objectOrder, this, std::placeholders::_1, std::placeholders::_2);
-    const auto objectIndex = *std::max_element(std::begin(subobject.objects), std::end(subobject.objects), comparator);
-    return objectIndex;
+    auto comparator = std::bind(&Segmentation::slotOrder, this, std::placeholders::_1, std::placeholders::_2);
+    assert(subobject.largestObject == *std::max_element(std::begin(subobject.objectSlots), std::end(subobject.objectSlots), comparator));
+#endif
+    return objects.slotRow[subobject.largestObject];
 }
 
 uint64_t Segmentation::tryLargestObjectContainingSubobject(const uint64_t subObjectId) const {
@@ -335,9 +638,9 @@ uint64_t Segmentation::tryLargestObjectContainingSubobject(const uint64_t subObj
 }
 
 uint64_t Segmentation::smallestImmutableObjectContainingSubobject(const Segmentation::SubObject & subobject) const {
-    auto comparitor = std::bind(&Segmentation::objectOrder, this, std::placeholders::_1, std::placeholders::_2);
-    const auto objectIndex = *std::min_element(std::begin(subobject.objects), std::end(subobject.objects), comparitor);
-    return objectIndex;
+    auto comparitor = std::bind(&Segmentation::slotOrder, this, std::placeholders::_1, std::placeholders::_2);
+    const auto slot = *std::min_element(std::begin(subobject.objectSlots), std::end(subobject.objectSlots), comparitor);
+    return objects.slotRow[slot];
 }
 
 void Segmentation::hoverSubObject(const uint64_t subobject_id) {
@@ -345,7 +648,9 @@ void Segmentation::hoverSubObject(const uint64_t subobject_id) {
         const auto & iter = Segmentation::singleton().subobjects.find(subobject_id);
         std::vector<uint64_t> overlappingObjIndices;
         if (iter != std::end(Segmentation::singleton().subobjects)) {
-            overlappingObjIndices = iter->second.objects;
+            for (const auto slot : iter->second.objectSlots) {
+                overlappingObjIndices.emplace_back(objects.slotRow[slot]);
+            }
         }
         emit hoveredSubObjectChanged(hovered_subobject_id = subobject_id, overlappingObjIndices);
     }
@@ -361,12 +666,12 @@ void Segmentation::untouchObjects() {
     emit resetTouchedObjects();
 }
 
-std::vector<std::reference_wrapper<Segmentation::Object>> Segmentation::touchedObjects() {
+std::vector<Segmentation::ObjectHandle> Segmentation::touchedObjects() {
     auto it = subobjects.find(touched_subobject_id);
-    std::vector<std::reference_wrapper<Segmentation::Object>> vec;
+    std::vector<ObjectHandle> vec;
     if (it != std::end(subobjects)) {
-        for (const auto & index : it->second.objects) {
-            vec.emplace_back(objects[index]);
+        for (const auto slot : it->second.objectSlots) {
+            vec.push_back({slot, objects.slotGeneration[slot]});
         }
     }
     return vec;
@@ -376,8 +681,8 @@ bool Segmentation::isSelected(const SubObject & rhs) const {
     return rhs.selectedObjectsCount != 0;
 }
 
-bool Segmentation::isSelected(const uint64_t & objectIndex) const {
-    return objects[objectIndex].selected;
+bool Segmentation::isSelected(const uint64_t &objectIndex) const {
+    return objects.selected[objectIndex];
 }
 
 bool Segmentation::isSubObjectIdSelected(const uint64_t & subobjectId) const {
@@ -394,127 +699,130 @@ void Segmentation::clearObjectSelection() {
     emit resetSelection();
 }
 
-void Segmentation::selectObject(Object & object) {
-    if (object.selected) {
+void Segmentation::selectObject(const uint64_t & objectIndex) {
+    const auto index = objectIndex;//copy, the argument may live in selectedObjectIndices
+    if (index >= objects.size() || objects.selected[index]) {
         return;
     }
-    object.selected = true;
-    for (auto & subobj : object.subobjects) {
-        ++subobj.get().selectedObjectsCount;
+    objects.selected[index] = true;
+    for (auto * subobject : objects.subobjects(index)) {
+        ++subobject->selectedObjectsCount;
     }
-    selectedObjectIndices.emplace_back(object.index);
-    emit changedRowSelection(object.index);
+    ++changeCounter;
+    selectedObjectIndices.emplace_back(index);
+    emit changedRowSelection(index);
 }
 
 void Segmentation::unselectObject(const uint64_t & objectIndex) {
-    if (objectIndex < objects.size()) {
-        unselectObject(objects[objectIndex]);
-    }
-}
-
-void Segmentation::unselectObject(Object & object) {
-    if (!object.selected) {
+    const auto index = objectIndex;//copy, the argument may live in selectedObjectIndices
+    if (index >= objects.size() || !objects.selected[index]) {
         return;
     }
-    object.selected = false;
-    for (auto & subobj : object.subobjects) {
-        --subobj.get().selectedObjectsCount;
+    objects.selected[index] = false;
+    for (auto * subobject : objects.subobjects(index)) {
+        --subobject->selectedObjectsCount;
     }
-    selectedObjectIndices.erase(object.index);
-    emit changedRowSelection(object.index);
-}
-
-void Segmentation::jumpToObject(Object & object) {
-    state->viewer->setPositionWithRecentering(object.location);
+    ++changeCounter;
+    selectedObjectIndices.erase(index);
+    emit changedRowSelection(index);
 }
 
 void Segmentation::jumpToObject(const uint64_t & objectIndex) {
     if(objectIndex < objects.size()) {
-        jumpToObject(objects[objectIndex]);
+        state->viewer->setPositionWithRecentering(objects.location[objectIndex]);
     }
 }
 
 void Segmentation::selectNextTodoObject() {
     if(selectedObjectIndices.empty() == false) {
-        lastTodoObject_id = selectedObjectIndices.front();
-        auto & obj = objects[lastTodoObject_id];
-        obj.todo = false;
-        unselectObject(obj);
+        const auto index = selectedObjectIndices.front();
+        lastTodoObject = objectHandle(index);
+        setTodo(index, false);
+        unselectObject(index);
     }
-    auto list = todolist();
-    if(todolist().empty() == false) {
-        selectObject(list.front());
-        jumpToObject(list.front());
+    if (const auto next = nextTodoIndex()) {
+        selectObject(next.get());
+        jumpToObject(next.get());
     }
     emit todosLeftChanged();
 }
 
 void Segmentation::selectPrevTodoObject() {
     if(selectedObjectIndices.empty() == false) {
-        auto & obj = objects[selectedObjectIndices.front()];
-        unselectObject(obj);
+        unselectObject(selectedObjectIndices.front());
+    }
+    if (const auto index = objectIndex(lastTodoObject)) {//it may have been removed since
+        setTodo(index.get(), true);
+        selectObject(index.get());
+        jumpToObject(index.get());
     }
-    auto & obj = objects[lastTodoObject_id];
-    obj.todo = true;
-    selectObject(obj);
-    jumpToObject(obj);
     emit todosLeftChanged();
-    return;
 }
 
 void Segmentation::markSelectedObjectForSplitting(const Coordinate & pos) {
     if(selectedObjectIndices.empty() == false) {
-        auto & object = objects[selectedObjectIndices.front()];
-        object.comment = "Split request";
-        object.location = pos;
-        emit changedRow(selectedObjectIndices.front());
+        const auto index = selectedObjectIndices.front();
+        objects.comment[index] = "Split request";
+        objects.location[index] = pos;
+        emit changedRow(index);
         selectNextTodoObject();
     }
 }
 
-std::vector<std::reference_wrapper<Segmentation::Object>> Segmentation::todolist() {
-    std::vector<std::reference_wrapper<Segmentation::Object>> todolist;
-    for (auto & obj : objects) {
-        if(obj.todo) {
-            todolist.push_back(obj);
+std::vector<uint64_t> Segmentation::todolist() {
+    std::vector<uint64_t> todolist;
+    todolist.reserve(todoCount);
+    if (const auto first = nextTodoIndex()) {
+        for (auto index = first.get(); todolist.size() < todoCount; ++index) {
+            if (objects.todo[index]) {
+                todolist.emplace_back(index);
+            }
         }
     }
-    std::sort(todolist.begin(), todolist.end());
     return todolist;
 }
 
+std::size_t Segmentation::todosLeft() const {
+    return todoCount;
+}
+
 
-void Segmentation::unmergeObject(Segmentation::Object & object, Segmentation::Object & other, const Coordinate & position) {
-    decltype(object.subobjects) tmp;
-    std::set_difference(std::begin(object.subobjects), std::end(object.subobjects), std::begin(other.subobjects), std::end(other.subobjects), std::back_inserter(tmp));
-    if (!tmp.empty()) {//only unmerge if subobjects remain
-        if (object.immutable) {
-            unselectObject(object);
-            createObject(tmp, position);
-            selectObject(objects.back());
+void Segmentation::unmergeObject(const uint64_t objectIndex, const uint64_t otherIndex, const Coordinate & position) {
+    std::vector<SubObject *> remaining;
+    const auto object = objects.subobjects(objectIndex);
+    const auto other = objects.subobjects(otherIndex);
+    std::set_difference(std::begin(object), std::end(object), std::begin(other), std::end(other), std::back_inserter(remaining), subobjectOrder);
+    if (!remaining.empty()) {//only unmerge if subobjects remain
+        if (objects.immutable[objectIndex]) {
+            unselectObject(objectIndex);
+            selectObject(createObject(remaining, position));
         } else {
-            unselectObject(object);
-            for (auto & elem : other.subobjects) {
-                auto & parentObjs = elem.get().objects;
-                parentObjs.erase(std::remove(std::begin(parentObjs), std::end(parentObjs), object.index), std::end(parentObjs));//remove parent
+            unselectObject(objectIndex);
+            const auto slot = objects.slot[objectIndex];
+            for (auto * subobject : other) {
+                auto & parentSlots = subobject->objectSlots;
+                parentSlots.erase(std::remove(std::begin(parentSlots), std::end(parentSlots), slot), std::end(parentSlots));//remove parent
+                if (subobject->largestObject == slot) {
+                    updateLargestObject(*subobject);
+                }
             }
-            std::swap(object.subobjects, tmp);
-            selectObject(object);
-            emit changedRow(object.index);
+            objects.replaceSubobjects(objectIndex, remaining);
+            updateLargestObjects(objectIndex);
+            selectObject(objectIndex);
+            emit changedRow(objectIndex);
         }
     }
 }
 
-Segmentation::Object & Segmentation::objectFromSubobject(Segmentation::SubObject & subobject, const Coordinate & position) {
-    const auto & other = std::find_if(std::begin(subobject.objects), std::end(subobject.objects)
-    , [&](const uint64_t elemId){
-        const auto & elem = objects[elemId];
-        return elem.subobjects.size() == 1 && elem.subobjects.front().get().id == subobject.id;
+uint64_t Segmentation::objectFromSubobject(Segmentation::SubObject & subobject, const Coordinate & position) {
+    const auto other = std::find_if(std::begin(subobject.objectSlots), std::end(subobject.objectSlots), [&](const uint32_t slot){
+        const auto index = objects.slotRow[slot];
+        return objects.subobjectsCount[index] == 1 && objects.subobjects(index).front().id == subobject.id;
     });
-    if (other == std::end(subobject.objects)) {
-        return createObject(std::vector<std::reference_wrapper<SubObject>>{subobject}, position);
+    if (other == std::end(subobject.objectSlots)) {
+        return createObject({&subobject}, position);
     } else {
-        return objects[*other];
+        return objects.slotRow[*other];
     }
 }
 
@@ -526,32 +834,27 @@ void Segmentation::selectObjectFromSubObject(const uint64_t soid, const Coordina
     selectObject(objectFromSubobject(subobjectFromId(soid, position), position));
 }
 
-void Segmentation::selectObject(const uint64_t & objectIndex) {
-    if (objectIndex < objects.size()) {
-        selectObject(objects[objectIndex]);
-    }
-}
-
 std::size_t Segmentation::selectedObjectsCount() const {
     return selectedObjectIndices.size();
 }
 
 void Segmentation::mergelistSave(QIODevice & file) const {
     QTextStream stream(&file);
-    for (const auto & obj : objects) {
-        stream << obj.id << ' ' << obj.todo << ' ' << obj.immutable;
-        for (const auto & subObj : obj.subobjects) {
-            stream << ' ' << subObj.get().id;
+    for (std::size_t index = 0; index < objects.size(); ++index) {
+        stream << objects.id[index] << ' ' << objects.todo[index] << ' ' << objects.immutable[index];
+        for (const auto * subObj : objects.subobjects(index)) {
+            stream << ' ' << subObj->id;
         }
         stream << '\n';
-        stream << obj.location.x << ' ' << obj.location.y << ' ' << obj.location.z << ' ';
-        if (obj.color) {
-            stream << std::get<0>(obj.color.get()) << ' ' << std::get<1>(obj.color.get()) << ' ' << std::get<2>(obj.color.get()) << '\n';
+        const auto & location = objects.location[index];
+        stream << location.x << ' ' << location.y << ' ' << location.z << ' ';
+        if (const auto & color = objects.color[index]) {
+            stream << std::get<0>(color.get()) << ' ' << std::get<1>(color.get()) << ' ' << std::get<2>(color.get()) << '\n';
         } else {
             stream << '\n';
         }
-        stream << obj.category << '\n';
-        stream << obj.comment << '\n';
+        stream << categories[objects.category[index]] << '\n';
+        stream << objects.comment[index] << '\n';
     }
     if (stream.status() != QTextStream::Ok) {
         qDebug() << "mergelistSave fail";
@@ -585,17 +888,19 @@ void Segmentation::mergelistLoad(QIODevice & file) {
         bool valid3 = !(comment = stream.readLine()).isNull();
 
         if (valid0 && valid1 && valid2 && valid3) {
-            auto & obj = createObjectFromSubobjectId(initialVolume, location, objId, todo, immutable);
+            const auto index = createObjectFromSubobjectId(initialVolume, location, objId, todo, immutable);
             uint64_t subObjId;
             while (lineStream >> subObjId) {
-                newSubObject(obj, subObjId);
+                auto subobjectIt = subobjects.emplace(std::piecewise_construct, std::forward_as_tuple(subObjId), std::forward_as_tuple(subObjId)).first;
+                addExistingSubObject(index, subobjectIt->second);
             }
-            std::sort(std::begin(obj.subobjects), std::end(obj.subobjects));
-            changeCategory(obj, category);
+            objects.sortSubobjects(index);
+            updateLargestObjects(index);//once the object is complete, not per subobject
+            changeCategory(index, category);
             if (customColorValid) {
-                changeColor(obj, std::make_tuple(r, g, b));
+                changeColor(index, std::make_tuple(r, g, b));
             }
-            obj.comment = comment;
+            objects.comment[index] = comment;
         } else {
             blockSignals(blockState);
             Segmentation::clear();
@@ -603,6 +908,7 @@ void Segmentation::mergelistLoad(QIODevice & file) {
         }
     }
     blockSignals(blockState);
+    rebuildTodoIndex();
     emit resetData();
 }
 
@@ -620,6 +926,7 @@ void Segmentation::jobLoad(QIODevice & file) {
     job.worker = worker_line.isNull() ? "" : worker_line;
     job.submitPath = submit_line.isNull() ? "" : submit_line;
     if (job.id != 0) {
+        rebuildTodoIndex();//one pass over the todo column of the loaded mergelist
         Session::singleton().annotationMode = AnnotationMode::Mode_MergeSimple;
     }
 }
@@ -644,7 +951,7 @@ void Segmentation::startJobMode() {
 void Segmentation::deleteSelectedObjects() {
     const auto blockState = blockSignals(true);
     while (!selectedObjectIndices.empty()) {
-        removeObject(objects[selectedObjectIndices.back()]);
+        removeObject(selectedObjectIndices.back());
     }
     blockSignals(blockState);
     emit resetData();
@@ -652,45 +959,46 @@ void Segmentation::deleteSelectedObjects() {
 
 void Segmentation::mergeSelectedObjects() {
     while (selectedObjectIndices.size() > 1) {
-        auto & firstObj = objects[selectedObjectIndices.front()];//front is the merge origin
-        auto & secondObj = objects[selectedObjectIndices.back()];
+        const auto firstIndex = selectedObjectIndices.front();//front is the merge origin
+        const auto secondIndex = selectedObjectIndices.back();
         //objects are no longer selected when they got merged
-        auto flat_deselect = [this](Object & object){
-            object.selected = false;
-            selectedObjectIndices.erase(object.index);
-            emit changedRowSelection(object.index);//deselect
+        auto flat_deselect = [this](const uint64_t index){
+            objects.selected[index] = false;
+            selectedObjectIndices.erase(index);
+            ++changeCounter;
+            emit changedRowSelection(index);//deselect
         };
         //4 (im)mutability possibilities
-        if (secondObj.immutable && firstObj.immutable) {
-            flat_deselect(secondObj);
-            const auto firstIndex = firstObj.index;
-            const auto secondIndex = secondObj.index;
+        if (objects.immutable[secondIndex] && objects.immutable[firstIndex]) {
+            flat_deselect(secondIndex);
+            setTodo(secondIndex, false);
+            const auto newIndex = createMergedObject(secondIndex, firstIndex);//create new object from merge result, appending keeps both indices valid
 
-            secondObj.todo = false;//secondObj will get invalidated
-            uint64_t newIndex = createObject(secondObj, firstObj).index;//create new object from merge result, invalidates firstObj and secondObj references since vector size changed
-
-            flat_deselect(objects[firstIndex]);//firstObj got invalidated
+            flat_deselect(firstIndex);
             selectedObjectIndices.emplace_front(newIndex);//move new index to front, so it gets the new merge origin
             emit changedRowSelection(firstIndex);
             emit changedRowSelection(secondIndex);
-        } else if (secondObj.immutable) {
-            flat_deselect(secondObj);
-            firstObj.merge(secondObj);
-            secondObj.todo = false;
-            emit changedRowSelection(secondObj.index);
-            emit changedRow(firstObj.index);
-        } else if (firstObj.immutable) {
-            flat_deselect(firstObj);
-            secondObj.merge(firstObj);
-            firstObj.todo = false;
-            emit changedRowSelection(firstObj.index);
-            emit changedRow(secondObj.index);
+        } else if (objects.immutable[secondIndex]) {
+            flat_deselect(secondIndex);
+            mergeObject(firstIndex, secondIndex);
+            updateLargestObjects(firstIndex);
+            setTodo(secondIndex, false);
+            emit changedRowSelection(secondIndex);
+            emit changedRow(firstIndex);
+        } else if (objects.immutable[firstIndex]) {
+            flat_deselect(firstIndex);
+            mergeObject(secondIndex, firstIndex);
+            updateLargestObjects(secondIndex);
+            setTodo(firstIndex, false);
+            emit changedRowSelection(firstIndex);
+            emit changedRow(secondIndex);
         } else {//if both are mutable the second object is merged into the first
-            flat_deselect(secondObj);
-            firstObj.merge(secondObj);
-            secondObj.todo = false;
-            emit changedRow(firstObj.index);
-            removeObject(secondObj);
+            flat_deselect(secondIndex);
+            mergeObject(firstIndex, secondIndex);
+            updateLargestObjects(firstIndex);
+            setTodo(secondIndex, false);
+            emit changedRow(firstIndex);
+            removeObject(secondIndex);
         }
     }
     emit todosLeftChanged();
@@ -700,24 +1008,24 @@ void Segmentation::unmergeSelectedObjects(const Coordinate & clickPos) {
     if (selectedObjectIndices.size() == 1) {
         deleteSelectedObjects();
     } else while (selectedObjectIndices.size() > 1) {
-        auto & objectToUnmerge = objects[selectedObjectIndices.back()];
-        unmergeObject(objects[selectedObjectIndices.front()], objectToUnmerge, clickPos);
+        const auto objectToUnmerge = selectedObjectIndices.back();
+        unmergeObject(selectedObjectIndices.front(), objectToUnmerge, clickPos);
         unselectObject(objectToUnmerge);
-        objectToUnmerge.todo = true;
+        setTodo(objectToUnmerge, true);
     }
     emit todosLeftChanged();
 }
 
 void Segmentation::jumpToSelectedObject() {
     if (!selectedObjectIndices.empty()) {
-        jumpToObject(objects[selectedObjectIndices.front()]);
+        jumpToObject(selectedObjectIndices.front());
     }
 }
 
 bool Segmentation::placeCommentForSelectedObject(const QString & comment) {
     if(selectedObjectIndices.size() == 1) {
         int index = selectedObjectIndices.front();
-        objects[index].comment = comment;
+        objects.comment[index] = comment;
         emit changedRow(index);
         return true;
     }
@@ -728,9 +1036,9 @@ void Segmentation::restoreDefaultColorForSelectedObjects() {
     if (!selectedObjectIndices.empty()) {
         for (auto index : selectedObjectIndices) {
             auto & colormap = Segmentation::singleton().overlayColorMap;
-            auto & obj = objects[index];
-            obj.color = colormap[obj.id % colormap.size()];
+            objects.color[index] = colormap[objects.id[index] % colormap.size()];
         }
+        ++changeCounter;
         emit resetData();
     }
 }
@@ -29,6 +29,7 @@
 
 #include <QColor>
 #include <QDebug>
+#include <QHash>
 #include <QSet>
 #include <QString>
 #include <QObject>
@@ -46,7 +47,7 @@ class Segmentation : public QObject {
 Q_OBJECT
     friend void connectedComponent(const Coordinate & seed);
     friend void verticalSplittingPlane(const Coordinate & seed);
-    friend auto & objectFromId(const quint64 objId);
+    friend uint64_t objectIndexFromId(const quint64 objId);
     friend class SegmentationObjectModel;
     friend class TouchedObjectModel;
     friend class CategoryDelegate;
@@ -54,96 +55,148 @@ Q_OBJECT
     friend class SegmentationView;
     friend class SegmentationProxy;
 
-    class Object;
     class SubObject {
         friend void connectedComponent(const Coordinate & seed);
         friend void verticalSplittingPlane(const Coordinate & seed);
         friend class SegmentationObjectModel;
         friend class Segmentation;
         static uint64_t highestId;
-        std::vector<uint64_t> objects;
+        std::vector<uint32_t> objectSlots;// slots of the objects containing this subobject in ascending order, they don’t change when rows move
         std::size_t selectedObjectsCount = 0;
+        uint32_t largestObject = 0;// slot, kept up to date by Segmentation::updateLargestObjects
     public:
         const uint64_t id;
         explicit SubObject(const uint64_t & id) : id(id) {
             highestId = std::max(id, highestId);
-            objects.reserve(10);//improves merging performance by a factor of 3
+            objectSlots.reserve(10);//improves merging performance by a factor of 3
         }
         SubObject(SubObject &&) = delete;
         SubObject(const SubObject &) = delete;
     };
 
-    template<typename T, typename U>
-    friend bool operator<(const std::reference_wrapper<T> & lhs, const std::reference_wrapper<U> & rhs) {
-        return lhs.get().id < rhs.get().id;
-    }
-    template<typename T, typename U>
-    friend bool operator==(const std::reference_wrapper<T> & lhs, const std::reference_wrapper<U> & rhs) {
-        return lhs.get().id == rhs.get().id;
-    }
+public:
+    /**
+     * @brief Refers to an object independently of its row, a handle of a removed object is detected by its generation.
+     */
+    struct ObjectHandle {
+        uint32_t slot{0};
+        uint32_t generation{0};// never matches a slot
+    };
+
+    /**
+     * @brief The subobjects of an object in ascending id order, invalidated when the subobjects of any object change.
+     */
+    class SubObjects {
+        SubObject * const * first;
+        SubObject * const * last;
+    public:
+        SubObjects(SubObject * const * first, SubObject * const * last) : first{first}, last{last} {}
+        SubObject * const * begin() const { return first; }
+        SubObject * const * end() const { return last; }
+        std::size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+        SubObject & front() const { return **first; }
+    };
 
-    class Object {
+private:
+    /**
+     * @brief Columns of all objects, row i of each column belongs to the object with index i.
+     *
+     * The sorted subobjects of each object form a contiguous range of one pool. Ranges left behind by merges and
+     * removals are reclaimed once they outweigh the live ones. Rows are swapped with the last one on removal,
+     * so they stay contiguous for the table models, while slots keep addressing the same object.
+     */
+    class Objects {
         friend void connectedComponent(const Coordinate & seed);
         friend void verticalSplittingPlane(const Coordinate & seed);
-        friend class SegmentationObjectModel;
-        friend class TouchedObjectModel;
-        friend class SegmentationView;
-        friend class SegmentationProxy;
         friend class Segmentation;
+        std::vector<uint32_t> slot;
+        std::vector<std::size_t> subobjectsBegin;
+        std::vector<std::size_t> subobjectsCount;
+        std::vector<SubObject *> subobjectPool;
+        std::size_t unusedSubobjects{0};
+        std::vector<uint64_t> slotRow;
+        std::vector<uint32_t> slotGeneration;
+        std::vector<uint32_t> freeSlots;
 
-        static uint64_t highestId;
-        static uint64_t highestIndex;
+        uint64_t append(const uint64_t id, const Coordinate & location, const bool todo, const bool immutable, const bool selected);
+        void swapWithLast(const uint64_t index);
+        void removeLast();
+        void clear();
+        void appendSubobject(const uint64_t index, SubObject & subobject);
+        void sortSubobjects(const uint64_t index);
+        void replaceSubobjects(const uint64_t index, const std::vector<SubObject *> & subobjects);
+        void mergeSubobjects(const uint64_t index, const uint64_t other);
+        void compactSubobjects();
     public:
-        //see http://coliru.stacked-crooked.com/a/aba85777991b4425
-        std::vector<std::reference_wrapper<SubObject>> subobjects;
-        uint64_t id;
-        uint64_t index = ++highestIndex;
-        bool todo;
-        bool immutable;
-        Coordinate location;
-        QString category;
-        boost::optional<std::tuple<uint8_t, uint8_t, uint8_t>> color;
-        QString comment;
-        bool selected = false;
+        std::vector<uint64_t> id;
+        std::vector<Coordinate> location;
+        std::vector<uint32_t> category;// index into Segmentation::categories
+        std::vector<QString> comment;
+        std::vector<boost::optional<std::tuple<uint8_t, uint8_t, uint8_t>>> color;
+        std::vector<bool> todo;// change through Segmentation::setTodo, which keeps the todo index in sync
+        std::vector<bool> immutable;
+        std::vector<bool> selected;
 
-        explicit Object(std::vector<std::reference_wrapper<SubObject>> initialVolumes, const Coordinate & location, const uint64_t id = ++highestId, const bool & todo = false, const bool & immutable = false);
-        explicit Object(Object & first, Object & second);
-        bool operator==(const Object & other) const;
-        void addExistingSubObject(SubObject & sub);
-        Object & merge(Object & other);
+        std::size_t size() const { return id.size(); }
+        bool empty() const { return id.empty(); }
+        SubObjects subobjects(const uint64_t index) const {
+            const auto * first = subobjectPool.data() + subobjectsBegin[index];
+            return {first, first + subobjectsCount[index]};
+        }
     };
 
+    static uint64_t highestObjectId;
     std::unordered_map<uint64_t, SubObject> subobjects;
-    std::vector<Object> objects;
+    Objects objects;
     std::unordered_map<uint64_t, uint64_t> objectIdToIndex;
     hash_list<uint64_t> selectedObjectIndices;
-    const QSet<QString> prefixed_categories = {"", "ecs", "mito", "myelin", "neuron", "synapse"};
-    QSet<QString> categories = prefixed_categories;
+    const std::vector<QString> prefixed_categories = {"", "ecs", "mito", "myelin", "neuron", "synapse"};
+    // interned category names, objects keep the index of theirs
+    std::vector<QString> categories;
+    QHash<QString, uint32_t> categoryIndices;
     uint64_t backgroundId = 0;
     uint64_t hovered_subobject_id = 0;
     // Selection via subobjects touches all objects containing the subobject.
     uint64_t touched_subobject_id = 0;
     // For segmentation job mode
-    uint64_t lastTodoObject_id = 0;
+    ObjectHandle lastTodoObject;
+    // the todo column is the todo index, together with the number of set flags and a cursor below which no row is todo
+    // kept in sync by setTodo, createObject and removeObject, rebuilt in bulk by rebuildTodoIndex
+    std::size_t todoCount = 0;
+    uint64_t todoCursor = 0;
+    void rebuildTodoIndex();
+    boost::optional<uint64_t> nextTodoIndex();
 
     // This array holds the table for overlay coloring.
     // The colors should be "maximally different".
     std::vector<std::tuple<uint8_t, uint8_t, uint8_t>> overlayColorMap;
 
-    Object & createObjectFromSubobjectId(const uint64_t initialSubobjectId, const Coordinate & location, const uint64_t objectId = ++Object::highestId, const bool todo = false, const bool immutable = false);
-    template<typename... Args>
-    Object & createObject(Args && ... args);
-    void removeObject(Object &);
-    void changeCategory(Object & obj, const QString & category);
-    void changeColor(Object & obj, const std::tuple<uint8_t, uint8_t, uint8_t> & color);
-    void changeComment(Object & obj, const QString & comment);
-    void newSubObject(Object & obj, uint64_t subObjID);
+    uint64_t createObjectFromSubobjectId(const uint64_t initialSubobjectId, const Coordinate & location, const uint64_t objectId = ++highestObjectId, const bool todo = false, const bool immutable = false);
+    uint64_t createObject(const std::vector<SubObject *> & initialSubobjects, const Coordinate & location, const uint64_t objectId = ++highestObjectId, const bool todo = false, const bool immutable = false);
+    uint64_t createMergedObject(const uint64_t firstIndex, const uint64_t secondIndex);
+    void addExistingSubObject(const uint64_t objectIndex, SubObject & subobject);
+    void mergeObject(const uint64_t objectIndex, const uint64_t otherIndex);
+    void removeObject(const uint64_t objectIndex);
+    void resetCategories();
+    uint32_t internCategory(const QString & category);
+    void changeCategory(const uint64_t objectIndex, const QString & category);
+    void changeColor(const uint64_t objectIndex, const std::tuple<uint8_t, uint8_t, uint8_t> & color);
+    void changeComment(const uint64_t objectIndex, const QString & comment);
+    void changeImmutable(const uint64_t objectIndex, const bool immutable);
+    void setTodo(const uint64_t objectIndex, const bool todo);
+    void newSubObject(const uint64_t objectIndex, uint64_t subObjID);
+
+    uint64_t objectIndexOfSlot(const uint32_t slot) const;
+    bool slotOrder(const uint32_t lhs, const uint32_t rhs) const;
+    void updateLargestObject(SubObject & subobject);
+    void updateLargestObjects(const uint64_t objectIndex);
 
     std::tuple<uint8_t, uint8_t, uint8_t, uint8_t> subobjectColor(const uint64_t subObjectID) const;
 
-    void unmergeObject(Object & object, Object & other, const Coordinate & position);
+    void unmergeObject(const uint64_t objectIndex, const uint64_t otherIndex, const Coordinate & position);
 
-    Object & objectFromSubobject(Segmentation::SubObject & subobject, const Coordinate & position);
+    uint64_t objectFromSubobject(Segmentation::SubObject & subobject, const Coordinate & position);
 public:
     class Job {
     public:
@@ -169,6 +222,8 @@ public:
     // for mode in which edges are online highlighted for objects when selected and being hovered over by mouse
     bool hoverVersion{false};
     uint64_t mouseFocusedObjectId{0};
+    // incremented by every mutator that changes objects, selection or rendering options (also while signals are blocked), lets renderers cache colours
+    uint64_t changeCounter{0};
 
     static Segmentation & singleton();
 
@@ -184,6 +239,11 @@ public:
     //volume rendering
     bool volume_render_toggle = false;
     std::atomic_bool volume_update_required{false};
+    // set if only volume_dirty_regions (global first and last voxel) changed since the last update
+    std::atomic_bool volume_update_partial{false};
+    std::vector<std::pair<Coordinate, Coordinate>> volume_dirty_regions;
+    // subobjects whose colour or selection changed since the last update, only valid together with volume_update_partial
+    std::vector<uint64_t> volume_recolor_ids;
     uint volume_tex_id = 0;
     int volume_tex_len = 128;
     int volume_mouse_move_x = 0;
@@ -195,6 +255,9 @@ public:
     bool hasObjects() const;
     bool hasSegData() const;
     bool subobjectExists(const uint64_t & subobjectId) const;
+    std::vector<uint64_t> subobjectIdsOfObjectIndex(const uint64_t objectIndex) const;
+    ObjectHandle objectHandle(const uint64_t objectIndex) const;
+    boost::optional<uint64_t> objectIndex(const ObjectHandle handle) const;
     //data access
     void createAndSelectObject(const Coordinate & position);
     SubObject & subobjectFromId(const uint64_t & subobjectId, const Coordinate & location);
@@ -211,21 +274,19 @@ public:
     std::size_t selectedObjectsCount() const;
     //selection modification
     void selectObject(const uint64_t & objectIndex);
-    void selectObject(Object & object);
     void selectObjectFromSubObject(SubObject &subobject, const Coordinate & position);
     void selectObjectFromSubObject(const uint64_t soid, const Coordinate & position);
     void unselectObject(const uint64_t & objectIndex);
-    void unselectObject(Object & object);
     void clearObjectSelection();
 
     void jumpToObject(const uint64_t & objectIndex);
-    void jumpToObject(Object & object);
-    std::vector<std::reference_wrapper<Segmentation::Object>> todolist();
+    std::vector<uint64_t> todolist();
+    std::size_t todosLeft() const;
 
     void hoverSubObject(const uint64_t subobject_id);
     void touchObjects(const uint64_t subobject_id);
     void untouchObjects();
-    std::vector<std::reference_wrapper<Object>> touchedObjects();
+    std::vector<ObjectHandle> touchedObjects();
     //files
     void mergelistSave(QIODevice & file) const;
     void mergelistLoad(QIODevice & file);
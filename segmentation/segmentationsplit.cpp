@@ -111,19 +111,19 @@ void connectedComponent(const Coordinate & seed) {
         auto & subobject = Segmentation::singleton().subobjectFromId(subobjectId, seed);
         auto splitIndex = Segmentation::singleton().largestObjectContainingSubobject(subobject);
         auto newSubObjId = Segmentation::SubObject::highestId + 1;
-        auto newObjectIndex = Segmentation::singleton().createObjectFromSubobjectId(newSubObjId, seed).index;
+        auto newObjectIndex = Segmentation::singleton().createObjectFromSubobjectId(newSubObjId, seed);
 
         std::unordered_set<uint64_t> subObjectsToFill = {subobjectId};
 
         std::unordered_set<uint64_t> visitedSubObjects = bucketFill({seed.x + 1, seed.y, seed.z}, splitIndex, newSubObjId, subObjectsToFill);
 
         //merge all traversed but unchanged supervoxel into the new object
-        auto & newObject = Segmentation::singleton().objects[newObjectIndex];
         for (auto && id : visitedSubObjects) {
             auto & subobject = Segmentation::singleton().subobjectFromId(id, seed);
-            newObject.addExistingSubObject(subobject);
+            Segmentation::singleton().addExistingSubObject(newObjectIndex, subobject);
         }
-        std::sort(std::begin(newObject.subobjects), std::end(newObject.subobjects));
+        Segmentation::singleton().objects.sortSubobjects(newObjectIndex);
+        Segmentation::singleton().updateLargestObjects(newObjectIndex);
 
         //remove the newly created area from the object to split
         Segmentation::singleton().selectObject(splitIndex);
@@ -170,7 +170,7 @@ void verticalSplittingPlane(const Coordinate & seed) {
         auto & subobject = Segmentation::singleton().subobjectFromId(subobjectId, seed);
         auto splitId = Segmentation::singleton().largestObjectContainingSubobject(subobject);
         auto newSubObjId = Segmentation::SubObject::highestId + 1;
-        auto newObjectIndex = Segmentation::singleton().createObjectFromSubobjectId(newSubObjId, seed).index;
+        auto newObjectIndex = Segmentation::singleton().createObjectFromSubobjectId(newSubObjId, seed);
 
         std::unordered_set<uint64_t> subObjectsToFill = verticalSplittingPlane({seed.x, seed.y, seed.z}, splitId, newSubObjId);
 
@@ -179,23 +179,24 @@ void verticalSplittingPlane(const Coordinate & seed) {
         //add the newly created subobject to all non-splitted objects
         for (auto && id : subObjectsToFill) {
             auto & subobject = Segmentation::singleton().subobjectFromId(id, seed);
-            for (auto && objIndex : subobject.objects) {
+            for (const auto slot : subobject.objectSlots) {
+                const auto objIndex = Segmentation::singleton().objectIndexOfSlot(slot);
                 if (objIndex != splitId) {
-                    auto && object = Segmentation::singleton().objects[objIndex];
                     auto & newSubobject = Segmentation::singleton().subobjectFromId(newSubObjId, seed);
-                    object.addExistingSubObject(newSubobject);
-                    std::sort(std::begin(object.subobjects), std::end(object.subobjects));
+                    Segmentation::singleton().addExistingSubObject(objIndex, newSubobject);
+                    Segmentation::singleton().objects.sortSubobjects(objIndex);
+                    Segmentation::singleton().updateLargestObjects(objIndex);
                 }
             }
         }
 
         //merge all traversed but unchanged supervoxel into the new object
-        auto & newObject = Segmentation::singleton().objects[newObjectIndex];
         for (auto && id : visitedSubObjects) {
             auto & subobject = Segmentation::singleton().subobjectFromId(id, seed);
-            newObject.addExistingSubObject(subobject);
+            Segmentation::singleton().addExistingSubObject(newObjectIndex, subobject);
         }
-        std::sort(std::begin(newObject.subobjects), std::end(newObject.subobjects));
+        Segmentation::singleton().objects.sortSubobjects(newObjectIndex);
+        Segmentation::singleton().updateLargestObjects(newObjectIndex);
 
         //remove the newly created area from the object to split
         Segmentation::singleton().selectObject(splitId);
@@ -397,7 +397,7 @@ std::unordered_map<decltype(treeListElement::treeID), std::reference_wrapper<tre
                     const auto path = attributes.value("path").toString();
                     const bool overlay = attributes.value("overlay").isEmpty() ? Segmentation::enabled : static_cast<bool>(attributes.value("overlay").toInt());
                     if (experimentName != state->name || overlay != Segmentation::enabled) {
-                        state->viewer->window->widgetContainer.datasetLoadWidget.loadDataset(overlay, path, true);
+                        state->viewer->window->widgetContainer.datasetLoadWidget.loadDatasetBlocking(overlay, path, true);// the following elements refer to the new dataset
                     }
                 } else if(xml.name() == "MovementArea") {
                     if (!merge) {
@@ -0,0 +1,261 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#include "arbslice.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ARBSLICE_X86
+#include <immintrin.h>
+#define ARBSLICE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace ArbSlice {
+
+namespace {
+constexpr int fractionBits = 16;
+constexpr std::int64_t one = std::int64_t{1} << fractionBits;
+constexpr std::int64_t half = one / 2;
+constexpr int batch = 8;// texels blended at once by the trilinear filter
+
+using Fixed = std::array<std::int64_t, 3>;
+
+Fixed toFixed(const std::array<double, 3> & value) {
+    return {{std::llround(value[0] * one), std::llround(value[1] * one), std::llround(value[2] * one)}};
+}
+
+std::int64_t floorShift(const std::int64_t value) {
+    return value >= 0 ? value >> fractionBits : -((-value + one - 1) >> fractionBits);
+}
+
+// row starts are computed exactly, so fixed point errors only accumulate along a row
+Fixed rowStart(const Plane & plane, const int row) {
+    return toFixed({{plane.origin[0] + row * plane.down[0], plane.origin[1] + row * plane.down[1], plane.origin[2] + row * plane.down[2]}});
+}
+
+void store(std::uint8_t * texel, const std::uint32_t rgb) {
+    texel[0] = rgb & 0xFF;
+    texel[1] = (rgb >> 8) & 0xFF;
+    texel[2] = (rgb >> 16) & 0xFF;
+}
+
+/**
+ * @brief Incremental cube lookup, the grid is only consulted when a voxel leaves the current cube.
+ */
+template<typename Voxel>
+class Cursor {
+    const Grid<Voxel> & grid;
+    const int extent;
+    std::array<int, 3> first{{1, 1, 1}};// empty bounds force the first lookup
+    std::array<int, 3> last{{0, 0, 0}};
+    const Voxel * cube{nullptr};
+public:
+    explicit Cursor(const Grid<Voxel> & grid) : grid(grid), extent(grid.supercubeEdge * grid.cubeEdge) {}
+    int gridExtent() const {
+        return extent;
+    }
+    bool inGrid(const int x, const int y, const int z) const {
+        return 0 <= x && x < extent && 0 <= y && y < extent && 0 <= z && z < extent;
+    }
+    bool inCube(const int x, const int y, const int z) const {
+        return first[0] <= x && x <= last[0] && first[1] <= y && y <= last[1] && first[2] <= z && z <= last[2];
+    }
+    // the voxel has to be inside of the grid
+    const Voxel * enter(const int x, const int y, const int z) {
+        if (!inCube(x, y, z)) {
+            const int edge = grid.cubeEdge;
+            first = {{x / edge * edge, y / edge * edge, z / edge * edge}};
+            last = {{first[0] + edge - 1, first[1] + edge - 1, first[2] + edge - 1}};
+            cube = grid.cube(x / edge, y / edge, z / edge);
+        }
+        return cube;
+    }
+    std::size_t offset(const int x, const int y, const int z) const {
+        const std::size_t edge = grid.cubeEdge;
+        return (static_cast<std::size_t>(z - first[2]) * edge + (y - first[1])) * edge + (x - first[0]);
+    }
+    Voxel voxel(const int x, const int y, const int z) {
+        const auto * current = enter(x, y, z);
+        return current != nullptr ? current[offset(x, y, z)] : 0;
+    }
+};
+
+void nearestRow(Cursor<std::uint8_t> & cursor, Fixed position, const Fixed & step, const RawSlice::Table & table, std::uint8_t * rgb, const int columns) {
+    for (int column = 0; column < columns; ++column, rgb += 3) {
+        const auto fx = position[0] + half;
+        const auto fy = position[1] + half;
+        const auto fz = position[2] + half;
+        position[0] += step[0];
+        position[1] += step[1];
+        position[2] += step[2];
+        const int x = fx >> fractionBits;
+        const int y = fy >> fractionBits;
+        const int z = fz >> fractionBits;
+        if (fx < 0 || fy < 0 || fz < 0 || !cursor.inGrid(x, y, z)) {
+            store(rgb, 0);
+            continue;
+        }
+        const auto * cube = cursor.enter(x, y, z);
+        store(rgb, cube != nullptr ? table.packed[cube[cursor.offset(x, y, z)]] : 0);
+    }
+}
+
+void idRow(Cursor<std::uint64_t> & cursor, Fixed position, const Fixed & step, const Box & inside, const std::uint64_t outside, std::uint64_t * ids, const int columns) {
+    for (int column = 0; column < columns; ++column) {
+        const auto fx = position[0] + half;
+        const auto fy = position[1] + half;
+        const auto fz = position[2] + half;
+        position[0] += step[0];
+        position[1] += step[1];
+        position[2] += step[2];
+        const int x = fx >> fractionBits;
+        const int y = fy >> fractionBits;
+        const int z = fz >> fractionBits;
+        if (fx < 0 || fy < 0 || fz < 0 || !cursor.inGrid(x, y, z) || !inside.contains(x, y, z)) {
+            ids[column] = outside;
+            continue;
+        }
+        const auto * cube = cursor.enter(x, y, z);
+        ids[column] = cube != nullptr ? cube[cursor.offset(x, y, z)] : outside;
+    }
+}
+
+// corners are indexed by x | y << 1 | z << 2, weights are in 1/256 towards the upper corner
+struct Batch {
+    alignas(16) std::array<std::array<std::uint16_t, batch>, 8> corners;
+    alignas(16) std::array<std::array<std::uint16_t, batch>, 3> weights;
+    alignas(16) std::array<std::uint16_t, batch> values;
+};
+
+std::uint16_t lerp(const std::uint16_t lower, const std::uint16_t upper, const std::uint16_t weight) {
+    return (lower * (256 - weight) + upper * weight + 128) >> 8;
+}
+
+void blendScalar(Batch & texels) {
+    const auto & c = texels.corners;
+    const auto & w = texels.weights;
+    for (int i = 0; i < batch; ++i) {
+        const auto y0 = lerp(lerp(c[0][i], c[1][i], w[0][i]), lerp(c[2][i], c[3][i], w[0][i]), w[1][i]);
+        const auto y1 = lerp(lerp(c[4][i], c[5][i], w[0][i]), lerp(c[6][i], c[7][i], w[0][i]), w[1][i]);
+        texels.values[i] = lerp(y0, y1, w[2][i]);
+    }
+}
+
+#ifdef ARBSLICE_X86
+// products of 8 bit values and weights ≤ 256 fit the 16 bit lanes, results match blendScalar exactly
+ARBSLICE_TARGET("sse4.1") __m128i lerpSSE41(const __m128i lower, const __m128i upper, const __m128i weight) {
+    const auto full = _mm_set1_epi16(256);
+    const auto sum = _mm_add_epi16(_mm_mullo_epi16(lower, _mm_sub_epi16(full, weight)), _mm_mullo_epi16(upper, weight));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+}
+
+ARBSLICE_TARGET("sse4.1") void blendSSE41(Batch & texels) {
+    __m128i c[8];
+    for (int i = 0; i < 8; ++i) {
+        c[i] = _mm_load_si128(reinterpret_cast<const __m128i *>(texels.corners[i].data()));
+    }
+    const auto wx = _mm_load_si128(reinterpret_cast<const __m128i *>(texels.weights[0].data()));
+    const auto wy = _mm_load_si128(reinterpret_cast<const __m128i *>(texels.weights[1].data()));
+    const auto wz = _mm_load_si128(reinterpret_cast<const __m128i *>(texels.weights[2].data()));
+    const auto y0 = lerpSSE41(lerpSSE41(c[0], c[1], wx), lerpSSE41(c[2], c[3], wx), wy);
+    const auto y1 = lerpSSE41(lerpSSE41(c[4], c[5], wx), lerpSSE41(c[6], c[7], wx), wy);
+    _mm_store_si128(reinterpret_cast<__m128i *>(texels.values.data()), lerpSSE41(y0, y1, wz));
+}
+#endif
+
+void trilinearRow(Cursor<std::uint8_t> & cursor, Fixed position, const Fixed & step, const RawSlice::Table & table, std::uint8_t * rgb, const int columns, void (*blend)(Batch &)) {
+    const int maximum = cursor.gridExtent() - 1;
+    Batch texels;
+    std::array<bool, batch> inside;
+    for (int column = 0; column < columns; column += batch) {
+        const int count = std::min(batch, columns - column);
+        for (int i = 0; i < count; ++i) {
+            const auto fx = position[0], fy = position[1], fz = position[2];
+            position[0] += step[0];
+            position[1] += step[1];
+            position[2] += step[2];
+            // coverage matches nearest sampling, corners are clamped to the grid
+            inside[i] = fx + half >= 0 && fy + half >= 0 && fz + half >= 0
+                    && cursor.inGrid((fx + half) >> fractionBits, (fy + half) >> fractionBits, (fz + half) >> fractionBits);
+            if (!inside[i]) {
+                for (auto & corner : texels.corners) {
+                    corner[i] = 0;
+                }
+                texels.weights[0][i] = texels.weights[1][i] = texels.weights[2][i] = 0;
+                continue;
+            }
+            const int x = floorShift(fx), y = floorShift(fy), z = floorShift(fz);
+            texels.weights[0][i] = (fx - (std::int64_t{x} << fractionBits)) >> (fractionBits - 8);
+            texels.weights[1][i] = (fy - (std::int64_t{y} << fractionBits)) >> (fractionBits - 8);
+            texels.weights[2][i] = (fz - (std::int64_t{z} << fractionBits)) >> (fractionBits - 8);
+            const std::array<int, 2> xs{{std::max(x, 0), std::min(x + 1, maximum)}};
+            const std::array<int, 2> ys{{std::max(y, 0), std::min(y + 1, maximum)}};
+            const std::array<int, 2> zs{{std::max(z, 0), std::min(z + 1, maximum)}};
+            const auto * cube = cursor.enter(xs[0], ys[0], zs[0]);
+            if (cursor.inCube(xs[1], ys[1], zs[1])) {// all corners inside of the same cube
+                for (int corner = 0; corner < 8; ++corner) {
+                    texels.corners[corner][i] = cube != nullptr ? cube[cursor.offset(xs[corner & 1], ys[(corner >> 1) & 1], zs[corner >> 2])] : 0;
+                }
+            } else {
+                for (int corner = 0; corner < 8; ++corner) {
+                    texels.corners[corner][i] = cursor.voxel(xs[corner & 1], ys[(corner >> 1) & 1], zs[corner >> 2]);
+                }
+            }
+        }
+        blend(texels);
+        for (int i = 0; i < count; ++i, rgb += 3) {
+            store(rgb, inside[i] ? table.packed[texels.values[i]] : 0);
+        }
+    }
+}
+}//unnamed namespace
+
+void resample(const Grid<std::uint8_t> & grid, const Plane & plane, const RawSlice::Table & table, std::uint8_t * rgb, const int columns, const int rowBegin, const int rowEnd, const Filter filter, const RawSlice::Isa isa) {
+    auto blend = blendScalar;
+#ifdef ARBSLICE_X86
+    blend = isa != RawSlice::Isa::Scalar ? blendSSE41 : blendScalar;
+#else
+    static_cast<void>(isa);
+#endif
+    Cursor<std::uint8_t> cursor(grid);
+    const auto step = toFixed(plane.right);
+    for (int row = rowBegin; row < rowEnd; ++row) {
+        const auto position = rowStart(plane, row);
+        auto * texels = rgb + 3 * static_cast<std::size_t>(row) * columns;
+        if (filter == Filter::Nearest) {
+            nearestRow(cursor, position, step, table, texels, columns);
+        } else {
+            trilinearRow(cursor, position, step, table, texels, columns, blend);
+        }
+    }
+}
+
+void gather(const Grid<std::uint64_t> & grid, const Plane & plane, const Box & inside, const std::uint64_t outside, std::uint64_t * ids, const int columns, const int rowBegin, const int rowEnd) {
+    Cursor<std::uint64_t> cursor(grid);
+    const auto step = toFixed(plane.right);
+    for (int row = rowBegin; row < rowEnd; ++row, ids += columns) {
+        idRow(cursor, rowStart(plane, row), step, inside, outside, ids, columns);
+    }
+}
+}//namespace ArbSlice
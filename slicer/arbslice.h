@@ -0,0 +1,91 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#ifndef ARBSLICE_H
+#define ARBSLICE_H
+
+#include "slicer/rawslice.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Resampling of arbitrarily oriented planes from a supercube of raw datacubes into RGB textures
+ * and of overlay cubes into id planes.
+ *
+ * Kept free of Qt and viewer state like RawSlice, rows can be resampled concurrently.
+ */
+namespace ArbSlice {
+enum class Filter {
+    Nearest, Trilinear
+};
+
+/**
+ * @brief Dense snapshot of the cube pointers of a supercube (x fastest), nullptr for cubes which aren’t loaded.
+ */
+template<typename Voxel>
+struct Grid {
+    std::vector<const Voxel *> cubes;
+    int supercubeEdge{0};
+    int cubeEdge{0};
+    const Voxel * cube(const int x, const int y, const int z) const {
+        return cubes[(static_cast<std::size_t>(z) * supercubeEdge + y) * supercubeEdge + x];
+    }
+};
+
+/**
+ * @brief Plane in voxels relative to the first voxel of the grid, texel (column, row) lies at origin + column * right + row * down.
+ */
+struct Plane {
+    std::array<double, 3> origin;
+    std::array<double, 3> right;
+    std::array<double, 3> down;
+};
+
+/**
+ * @brief Inclusive voxel bounds relative to the first voxel of the grid.
+ */
+struct Box {
+    std::array<int, 3> first;
+    std::array<int, 3> last;
+    bool contains(const int x, const int y, const int z) const {
+        return first[0] <= x && x <= last[0] && first[1] <= y && y <= last[1] && first[2] <= z && z <= last[2];
+    }
+};
+
+/**
+ * @brief Resamples rows [rowBegin, rowEnd) of columns × rows RGB texels (tightly packed) through table.
+ *
+ * Texels outside of the grid or inside of missing cubes are black.
+ */
+void resample(const Grid<std::uint8_t> & grid, const Plane & plane, const RawSlice::Table & table, std::uint8_t * rgb, const int columns, const int rowBegin, const int rowEnd, const Filter filter, const RawSlice::Isa isa = RawSlice::bestIsa());
+/**
+ * @brief Samples the ids of rows [rowBegin, rowEnd) of the plane (nearest) into columns × (rowEnd - rowBegin) ids.
+ *
+ * Voxels outside of inside or of the grid and inside of missing cubes get the outside id.
+ */
+void gather(const Grid<std::uint64_t> & grid, const Plane & plane, const Box & inside, const std::uint64_t outside, std::uint64_t * ids, const int columns, const int rowBegin, const int rowEnd);
+}
+
+#endif//ARBSLICE_H
@@ -24,7 +24,11 @@
 
 #include "segmentation/segmentation.h"
 
-#include <boost/multi_array.hpp>
+#include <QDebug>
+#include <QOpenGLPixelTransferOptions>
+
+#include <algorithm>
+#include <cmath>
 
 gpu_raw_cube::gpu_raw_cube(const int gpucubeedge, const bool index) {
     cube.setAutoMipMapGenerationEnabled(false);
@@ -32,80 +36,185 @@ gpu_raw_cube::gpu_raw_cube(const int gpucubeedge, const bool index) {
     cube.setMipLevels(1);
     cube.setMinificationFilter(index ? QOpenGLTexture::Nearest : QOpenGLTexture::Linear);
     cube.setMagnificationFilter(index ? QOpenGLTexture::Nearest : QOpenGLTexture::Linear);
-    cube.setFormat(index ? QOpenGLTexture::R16_UNorm : QOpenGLTexture::R8_UNorm);
+    cube.setFormat(index ? QOpenGLTexture::RGB8_UNorm : QOpenGLTexture::R8_UNorm);
     cube.setWrapMode(QOpenGLTexture::ClampToEdge);
     cube.allocateStorage();
 }
 
-std::vector<char> gpu_raw_cube::prepare(boost::multi_array_ref<uint8_t, 3>::const_array_view<3>::type view) {
-    std::vector<char> data;
-    for (const auto & d2 : view)
-    for (const auto & d1 : d2)
-    for (const auto & elem : d1) {
-        data.emplace_back(elem);
+std::vector<std::uint8_t> gpu_raw_cube::prepare(const std::uint8_t * cpucube, const int cpucubeedge, const int gpucubeedge, const Coordinate & offset) {
+    const std::size_t cpuedge = cpucubeedge;
+    const std::size_t gpuedge = gpucubeedge;
+    std::vector<std::uint8_t> texels(gpuedge * gpuedge * gpuedge);
+    auto * texel = texels.data();
+    for (std::size_t z = 0; z < gpuedge; ++z)
+    for (std::size_t y = 0; y < gpuedge; ++y) {// x rows are contiguous in both cubes
+        const auto * row = cpucube + ((z + offset.z) * cpuedge + y + offset.y) * cpuedge + offset.x;
+        texel = std::copy(row, row + gpuedge, texel);
     }
-    return data;
+    return texels;
 }
 
-void gpu_raw_cube::upload(const std::vector<char> & data) {
-    cube.setData(QOpenGLTexture::Red, QOpenGLTexture::UInt8, data.data());
+void gpu_raw_cube::upload(const std::vector<std::uint8_t> & texels) {
+    QOpenGLPixelTransferOptions options;
+    options.setAlignment(1);
+    cube.setData(QOpenGLTexture::Red, QOpenGLTexture::UInt8, texels.data(), &options);
 }
 
-void gpu_raw_cube::generate(boost::multi_array_ref<uint8_t, 3>::const_array_view<3>::type view) {
-    upload(prepare(view));
+void gpu_raw_cube::recycle() {
+    vertices.clear();// generate overwrites all texels
 }
 
-gpu_lut_cube::gpu_lut_cube(const int gpucubeedge) : gpu_raw_cube(gpucubeedge, true) {
-    lut.setAutoMipMapGenerationEnabled(false);
-    lut.setMipLevels(1);
-    lut.setMinificationFilter(QOpenGLTexture::Nearest);
-    lut.setMagnificationFilter(QOpenGLTexture::Nearest);
-    lut.setFormat(QOpenGLTexture::RGBA8_UNorm);
+namespace {
+std::array<std::uint8_t, 4> rgba(const std::uint64_t subobjectId) {
+    const auto color = Segmentation::singleton().colorObjectFromSubobjectId(subobjectId);
+    return {{std::get<0>(color), std::get<1>(color), std::get<2>(color), std::get<3>(color)}};
 }
 
-std::vector<gpu_lut_cube::gpu_index> gpu_lut_cube::prepare(boost::multi_array_ref<uint64_t, 3>::const_array_view<3>::type view) {
-    bool lastValid{false};
-    uint64_t lastElem{0};
-    uint64_t lastIndex{0};
-    std::array<std::uint8_t, 4> lastColor{{}};
-
-    std::vector<gpu_index> data;
-    for (const auto & d2 : view)
-    for (const auto & d1 : d2)
-    for (const auto & elem : d1) {
-        if (lastValid && elem == lastElem) {
-            data.emplace_back(lastIndex);
-        } else {
-            const auto it = id_to_lut_index.find(elem);
-            const auto existing = it != std::end(id_to_lut_index);
-            const auto index = existing ? it->second : (id_to_lut_index[elem] = highest_index++);//increment after assignment
-            data.emplace_back(index);
-            if (!existing) {
-                const auto color = Segmentation::singleton().colorObjectFromSubobjectId(elem);
-                lastColor = {{std::get<0>(color), std::get<1>(color), std::get<2>(color), std::get<3>(color)}};
-                colors.push_back(lastColor);
-            }
-            lastElem = elem;
-            lastIndex = index;
-            lastColor = colors[index];
-            lastValid = true;
+std::array<std::uint8_t, 4> objectAndSelection(const std::uint64_t subobjectId) {
+    const auto & seg = Segmentation::singleton();
+    // 0 for unknown subobjects, huge indices share the last value (the shader compares them as floats)
+    const std::uint32_t object = seg.subobjectExists(subobjectId) ? std::min<std::uint64_t>(seg.tryLargestObjectContainingSubobject(subobjectId) + 1, 0xFFFFFF) : 0;
+    const std::uint8_t selected = seg.isSubObjectIdSelected(subobjectId) ? 255 : 0;
+    return {{static_cast<std::uint8_t>(object & 0xFF), static_cast<std::uint8_t>(object >> 8 & 0xFF), static_cast<std::uint8_t>(object >> 16), selected}};
+}
+}
+
+void GpuPalette::markDirty(const slot_type slot) {
+    dirtyFirst = dirtyFirst < dirtyLast ? std::min<std::size_t>(dirtyFirst, slot) : slot;
+    dirtyLast = std::max<std::size_t>(dirtyLast, slot + 1);
+}
+
+void GpuPalette::color(const std::size_t slot) {
+    colors[slot] = rgba(ids[slot]);
+    attributes[slot] = objectAndSelection(ids[slot]);
+}
+
+GpuPalette::slot_type GpuPalette::slot(const std::uint64_t id) {
+    QMutexLocker locker(&mutex);
+    const auto it = idToSlot.find(id);
+    if (it != std::end(idToSlot)) {
+        return it->second;
+    }
+    if (ids.size() >= capacity) {// the layer resets the palette and discards cubes prepared until then
+        return 0;
+    }
+    const slot_type newSlot = ids.size();
+    idToSlot.emplace(id, newSlot);
+    ids.emplace_back(id);
+    return newSlot;
+}
+
+bool GpuPalette::full() const {
+    QMutexLocker locker(&mutex);
+    return ids.size() >= capacity;
+}
+
+void GpuPalette::recolor(const std::uint64_t id) {
+    QMutexLocker locker(&mutex);
+    const auto it = idToSlot.find(id);
+    if (it != std::end(idToSlot) && it->second < colored && !stale) {
+        color(it->second);
+        markDirty(it->second);
+    }
+}
+
+void GpuPalette::recolorAll() {
+    QMutexLocker locker(&mutex);
+    stale = true;
+}
+
+void GpuPalette::clear() {
+    QMutexLocker locker(&mutex);
+    idToSlot.clear();
+    ids.clear();
+    colors.clear();
+    attributes.clear();
+    colored = 0;
+    dirtyFirst = dirtyLast = 0;
+    stale = false;
+}
+
+void GpuPalette::upload() {
+    QMutexLocker locker(&mutex);
+    colors.resize((ids.size() + width - 1) / width * width);
+    attributes.resize(colors.size());
+    if (stale) {
+        colored = 0;
+        stale = false;
+    }
+    if (colored < ids.size()) {
+        for (auto i = colored; i < ids.size(); ++i) {
+            color(i);
         }
+        markDirty(colored);
+        markDirty(ids.size() - 1);
+        colored = ids.size();
+    }
+    const int rows = colors.size() / width;
+    if (!texture.isCreated() || texture.height() < rows) {// grow to the next power of 2 and upload everything
+        int height = 16;
+        while (height < rows) {
+            height *= 2;
+        }
+        for (auto * tex : {&texture, &attributeTexture}) {
+            tex->destroy();
+            tex->setAutoMipMapGenerationEnabled(false);
+            tex->setMipLevels(1);
+            tex->setMinificationFilter(QOpenGLTexture::Nearest);
+            tex->setMagnificationFilter(QOpenGLTexture::Nearest);
+            tex->setWrapMode(QOpenGLTexture::ClampToEdge);
+            tex->setFormat(QOpenGLTexture::RGBA8_UNorm);
+            tex->setSize(width, height);
+            tex->allocateStorage();
+        }
+        dirtyFirst = 0;
+        dirtyLast = ids.size();
+    }
+    if (dirtyFirst < dirtyLast) {
+        const int firstRow = dirtyFirst / width;
+        const int lastRow = (dirtyLast - 1) / width;
+        texture.bind();
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, width, lastRow - firstRow + 1, GL_RGBA, GL_UNSIGNED_BYTE, colors[firstRow * width].data());
+        texture.release();
+        attributeTexture.bind();
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, width, lastRow - firstRow + 1, GL_RGBA, GL_UNSIGNED_BYTE, attributes[firstRow * width].data());
+        attributeTexture.release();
+        dirtyFirst = dirtyLast = 0;
     }
-    const auto lutSize = std::pow(2, std::ceil(std::log2(colors.size())));
-    colors.resize(lutSize);
-    return data;
 }
 
-void gpu_lut_cube::upload(const std::vector<gpu_index> & data) {
-    lut.setSize(colors.size());
-    lut.allocateStorage();
+gpu_lut_cube::gpu_lut_cube(const int gpucubeedge) : gpu_raw_cube(gpucubeedge, true) {}
+
+std::vector<std::uint8_t> gpu_lut_cube::prepare(const std::uint64_t * cpucube, const int cpucubeedge, const int gpucubeedge, const Coordinate & offset, GpuPalette & palette) {
+    const std::size_t cpuedge = cpucubeedge;
+    const std::size_t gpuedge = gpucubeedge;
+    bool lastValid{false};
+    uint64_t lastElem{0};
+    GpuPalette::slot_type lastSlot{0};
 
-    cube.setData(QOpenGLTexture::Red, QOpenGLTexture::UInt16, data.data());
-    lut.setData(QOpenGLTexture::RGBA, QOpenGLTexture::UInt32_RGBA8_Rev, colors.data());
+    std::vector<std::uint8_t> texels(gpuedge * gpuedge * gpuedge * texelBytes);
+    auto * texel = texels.data();
+    for (std::size_t z = 0; z < gpuedge; ++z)
+    for (std::size_t y = 0; y < gpuedge; ++y) {
+        const auto * row = cpucube + ((z + offset.z) * cpuedge + y + offset.y) * cpuedge + offset.x;
+        for (std::size_t x = 0; x < gpuedge; ++x) {
+            if (!lastValid || row[x] != lastElem) {// ids come in runs, so the palette is rarely consulted
+                lastSlot = palette.slot(row[x]);
+                lastElem = row[x];
+                lastValid = true;
+            }
+            *texel++ = lastSlot & 0xFF;
+            *texel++ = lastSlot >> 8 & 0xFF;
+            *texel++ = lastSlot >> 16 & 0xFF;
+        }
+    }
+    return texels;
 }
 
-void gpu_lut_cube::generate(boost::multi_array_ref<uint64_t, 3>::const_array_view<3>::type view) {
-    upload(prepare(view));
+void gpu_lut_cube::upload(const std::vector<std::uint8_t> & texels) {
+    QOpenGLPixelTransferOptions options;
+    options.setAlignment(1);// rgb rows needn’t be a multiple of 4 bytes
+    cube.setData(QOpenGLTexture::RGB, QOpenGLTexture::UInt8, texels.data(), &options);
 }
 
 TextureLayer::TextureLayer(QOpenGLContext & sharectx) {
@@ -118,41 +227,171 @@ TextureLayer::~TextureLayer() {
     ctx.makeCurrent(&surface);//QOpenGLTexture dtor needs a current ctx
 }
 
-template<typename cube_type, typename elem_type>
 void TextureLayer::createBogusCube(const int cpucubeedge, const int gpucubeedge) {
+    const std::vector<char> data(std::pow(cpucubeedge, 3) * (isOverlayData ? sizeof(std::uint64_t) : sizeof(std::uint8_t)), 0);
+    const auto texels = prepare(data.data(), cpucubeedge, gpucubeedge, {0, cpucubeedge - gpucubeedge, 0});
     ctx.makeCurrent(&surface);
-    std::vector<char> data;
-    data.resize(std::pow(cpucubeedge, 3) * sizeof(elem_type));
-    std::fill(std::begin(data), std::end(data), 0);
-    bogusCube.reset(new cube_type(gpucubeedge));
-    boost::multi_array_ref<elem_type, 3> cube(reinterpret_cast<elem_type*>(data.data()), boost::extents[cpucubeedge][cpucubeedge][cpucubeedge]);
-    using range = boost::multi_array_types::index_range;
-    static_cast<cube_type*>(bogusCube.get())->generate(cube[boost::indices[range(0,gpucubeedge)][range(cpucubeedge-gpucubeedge,cpucubeedge-0)][range(0,gpucubeedge)]]);
+    bogusCube = newCube(gpucubeedge);
+    bogusCube->upload(texels);
 }
 
-void TextureLayer::createBogusCube(const int cpucubeedge, const int gpucubeedge) {
+std::vector<std::uint8_t> TextureLayer::prepare(const char * data, const int cpucubeedge, const int gpucubeedge, const Coordinate & offset) {
     if (isOverlayData) {
-        createBogusCube<gpu_lut_cube, std::uint64_t>(cpucubeedge, gpucubeedge);
-    } else {
-        createBogusCube<gpu_raw_cube, std::uint8_t>(cpucubeedge, gpucubeedge);
+        return gpu_lut_cube::prepare(reinterpret_cast<const std::uint64_t *>(data), cpucubeedge, gpucubeedge, offset, palette);
+    }
+    return gpu_raw_cube::prepare(reinterpret_cast<const std::uint8_t *>(data), cpucubeedge, gpucubeedge, offset);
+}
+
+void TextureLayer::pushPrepared(PreparedGPUCube && cube) {
+    QMutexLocker locker(&preparedMutex);
+    prepared.emplace_back(std::move(cube));
+}
+
+bool TextureLayer::takePrepared(PreparedGPUCube & cube) {
+    QMutexLocker locker(&preparedMutex);
+    if (prepared.empty()) {
+        return false;
     }
+    cube = std::move(prepared.back());
+    prepared.pop_back();
+    return true;
 }
 
-template<typename cube_type, typename elem_type>
-void TextureLayer::cubeSubArray(const boost::const_multi_array_ref<elem_type, 3> cube, const int gpucubeedge, const CoordOfGPUCube gpuCoord, const Coordinate offset) {
+bool TextureLayer::hasPrepared() {
+    QMutexLocker locker(&preparedMutex);
+    return !prepared.empty();
+}
+
+void TextureLayer::upload(const PreparedGPUCube & prepared, const int cpucubeedge, const int gpucubeedge) {
+    if (isOverlayData && palette.full()) {// the slots of this cube are invalid
+        resetPalette(cpucubeedge, gpucubeedge);
+        return;
+    }
     ctx.makeCurrent(&surface);
-    using range = boost::multi_array_types::index_range;
-    const auto view = cube[boost::indices[range(0+offset.z,gpucubeedge+offset.z)][range(0+offset.y,gpucubeedge+offset.y)][range(0+offset.x,gpucubeedge+offset.x)]];
-    textures[gpuCoord].reset(new cube_type(gpucubeedge));
-    static_cast<cube_type*>(textures[gpuCoord].get())->generate(view);
+    auto cube = recycled(gpucubeedge);
+    if (!cube) {
+        cube = newCube(gpucubeedge);
+    }
+    cube->upload(prepared.texels);
+    textures[prepared.pos] = std::move(cube);
+    ++misses;
+    reportHitRate();
 }
 
-void TextureLayer::cubeSubArray(const char * data, const int cpucubeedge, const int gpucubeedge, const CoordOfGPUCube gpuCoord, const Coordinate offset) {
+std::unique_ptr<gpu_raw_cube> TextureLayer::newCube(const int gpucubeedge) {
+    if (isOverlayData) {
+        return std::unique_ptr<gpu_raw_cube>(new gpu_lut_cube(gpucubeedge));
+    }
+    return std::unique_ptr<gpu_raw_cube>(new gpu_raw_cube(gpucubeedge));
+}
+
+/**
+ * @brief palette slots are never reused, so once all are taken every overlay cube is uploaded again with a fresh palette
+ */
+void TextureLayer::resetPalette(const int cpucubeedge, const int gpucubeedge) {
+    qDebug() << "overlay palette full, reuploading all overlay cubes";
+    reset(cpucubeedge, gpucubeedge);
+}
+
+void TextureLayer::reset(const int cpucubeedge, const int gpucubeedge) {
+    ctx.makeCurrent(&surface);
+    textures.clear();
+    resident.clear();
+    residentIndex.clear();
+    ++version;// preparations in flight are discarded
     if (isOverlayData) {
-        boost::const_multi_array_ref<std::uint64_t, 3> cube(reinterpret_cast<const std::uint64_t *>(data), boost::extents[cpucubeedge][cpucubeedge][cpucubeedge]);
-        cubeSubArray<gpu_lut_cube>(cube, gpucubeedge, gpuCoord, offset);
-    } else {
-        boost::const_multi_array_ref<std::uint8_t, 3> cube(reinterpret_cast<const std::uint8_t *>(data), boost::extents[cpucubeedge][cpucubeedge][cpucubeedge]);
-        cubeSubArray<gpu_raw_cube>(cube, gpucubeedge, gpuCoord, offset);
+        palette.clear();
+    }
+    createBogusCube(cpucubeedge, gpucubeedge);
+}
+
+std::size_t TextureLayer::cubeBytes(const int gpucubeedge) const {
+    return std::pow(gpucubeedge, 3) * (isOverlayData ? gpu_lut_cube::texelBytes : sizeof(std::uint8_t));
+}
+
+void TextureLayer::evict() {
+    residentIndex.erase(resident.back().pos);
+    resident.pop_back();
+}
+
+/**
+ * @brief reuses the least recently left texture instead of allocating another one when the budget is exhausted
+ */
+std::unique_ptr<gpu_raw_cube> TextureLayer::recycled(const int gpucubeedge) {
+    std::unique_ptr<gpu_raw_cube> cube;
+    if (!resident.empty() && (textures.size() + resident.size() + 1) * cubeBytes(gpucubeedge) > budget) {
+        cube = std::move(resident.back().cube);
+        evict();
+        if (cube->cube.width() == gpucubeedge) {
+            cube->recycle();
+        } else {
+            cube.reset();
+        }
+    }
+    return cube;
+}
+
+void TextureLayer::trim(const int gpucubeedge) {
+    while (!resident.empty() && (textures.size() + resident.size()) * cubeBytes(gpucubeedge) > budget) {
+        evict();
+    }
+}
+
+void TextureLayer::retire(const CoordOfGPUCube & gpuCoord, const int magnification, const int gpucubeedge) {
+    auto it = textures.find(gpuCoord);
+    if (it == std::end(textures)) {
+        return;
+    }
+    const auto residentIt = residentIndex.find(gpuCoord);
+    if (residentIt != std::end(residentIndex)) {// replaced by the newer texture
+        resident.erase(residentIt->second);
+        residentIndex.erase(residentIt);
+    }
+    it->second->vertices.clear();
+    resident.push_front({gpuCoord, magnification, version, std::move(it->second)});
+    residentIndex.emplace(gpuCoord, std::begin(resident));
+    textures.erase(it);
+    trim(gpucubeedge);
+}
+
+bool TextureLayer::restore(const CoordOfGPUCube & gpuCoord, const int magnification) {
+    const auto it = residentIndex.find(gpuCoord);
+    if (it == std::end(residentIndex) || it->second->magnification != magnification || it->second->version != version) {
+        return false;
+    }
+    textures[gpuCoord] = std::move(it->second->cube);
+    resident.erase(it->second);
+    residentIndex.erase(it);
+    ++hits;
+    reportHitRate();
+    return true;
+}
+
+void TextureLayer::invalidate(const Coordinate & globalFirst, const Coordinate & globalLast, const int magnification, const int gpucubeedge) {
+    const auto first = globalFirst.cube(gpucubeedge, magnification);
+    const auto last = globalLast.cube(gpucubeedge, magnification);
+    ctx.makeCurrent(&surface);
+    for (int z = first.z; z <= last.z; ++z)
+    for (int y = first.y; y <= last.y; ++y)
+    for (int x = first.x; x <= last.x; ++x) {
+        const CoordOfGPUCube gpuCoord{x, y, z};
+        const auto it = residentIndex.find(gpuCoord);
+        if (it != std::end(residentIndex) && it->second->magnification == magnification) {
+            resident.erase(it->second);
+            residentIndex.erase(it);
+        }
+        if (preparing.count(gpuCoord) != 0) {
+            stale.emplace(gpuCoord);
+        }
+    }
+}
+
+double TextureLayer::hitRate() const {
+    return hits + misses == 0 ? 0 : static_cast<double>(hits) / (hits + misses);
+}
+
+void TextureLayer::reportHitRate() const {
+    if ((hits + misses) % 4096 == 0) {
+        qDebug() << (isOverlayData ? "overlay" : "raw") << "gpu cube pool: hit rate" << hitRate() << "of" << hits + misses << "cubes," << resident.size() << "resident";
     }
 }
@@ -27,16 +27,21 @@
 
 #include <QOffscreenSurface>
 #include <QOpenGLContext>
+#include <QMutex>
 #include <QOpenGLTexture>
+#include <QThreadPool>
 #include <QVector3D>
 
 #include <boost/functional/hash.hpp>
-#include <boost/multi_array/multi_array_ref.hpp>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <list>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace std {
@@ -54,45 +59,152 @@ public:
     std::vector<floatCoordinate> vertices;
     gpu_raw_cube(const int gpucubeedge, const bool index = false);
     virtual ~gpu_raw_cube() {}
-    std::vector<char> prepare(boost::multi_array_ref<std::uint8_t, 3>::const_array_view<3>::type view);
-    void upload(const std::vector<char> & data);
-    void generate(boost::multi_array_ref<std::uint8_t, 3>::const_array_view<3>::type view);
+    /**
+     * @brief copies the gpu cube at offset out of a cpu cube, thread-safe
+     */
+    static std::vector<std::uint8_t> prepare(const std::uint8_t * cpucube, const int cpucubeedge, const int gpucubeedge, const Coordinate & offset);
+    virtual void upload(const std::vector<std::uint8_t> & texels);
+    /**
+     * @brief prepares the cube for other data, the texture storage is kept
+     */
+    virtual void recycle();
 };
 
-class gpu_lut_cube : public gpu_raw_cube {
+/**
+ * @brief colours of all subobject ids referenced by the overlay cubes of a layer, shared by all of them
+ *
+ * Overlay cubes store palette slots instead of ids, so colour or selection changes only rewrite the affected entries.
+ * A second texture with the same layout holds the largest object and the selection of each slot,
+ * the overlay shader derives hover and selection edges from it.
+ */
+class GpuPalette {
 public:
-    using gpu_index = std::uint16_t;
+    using slot_type = std::uint32_t;// stored as 24 bit rgb texels
+    static constexpr int width = 4096;
+    static constexpr std::size_t capacity = std::size_t{1} << 24;
 private:
-    std::unordered_map<std::uint64_t, gpu_index> id_to_lut_index;
-    gpu_index highest_index = 0;
-    std::vector<std::array<std::uint8_t, 4>> colors;
+    std::unordered_map<std::uint64_t, slot_type> idToSlot;
+    std::vector<std::uint64_t> ids;// slot → id
+    std::vector<std::array<std::uint8_t, 4>> colors;// whole rows of the texture
+    std::vector<std::array<std::uint8_t, 4>> attributes;// object index + 1 (24 bit) and selected flag per slot
+    std::size_t colored{0};// slots are assigned by workers, their colours by the gui thread
+    std::size_t dirtyFirst{0};
+    std::size_t dirtyLast{0};// past the end
+    bool stale{false};
+    mutable QMutex mutex;
+    void markDirty(const slot_type slot);
+    void color(const std::size_t slot);
+public:
+    QOpenGLTexture texture{QOpenGLTexture::Target2D};
+    QOpenGLTexture attributeTexture{QOpenGLTexture::Target2D};
+    /**
+     * @brief slot of id, new slots are coloured during the next upload, thread-safe
+     */
+    slot_type slot(const std::uint64_t id);
+    bool full() const;
+    void recolor(const std::uint64_t id);
+    /**
+     * @brief recolours all slots during the next upload, e.g. after the selection was reset
+     */
+    void recolorAll();
+    void clear();
+    /**
+     * @brief uploads the changed palette rows, the texture grows with the number of slots, ctx has to be current
+     */
+    void upload();
+};
+
+class gpu_lut_cube : public gpu_raw_cube {
 public:
-    QOpenGLTexture lut{QOpenGLTexture::Target1D};
+    static constexpr std::size_t texelBytes = 3;
     gpu_lut_cube(const int gpucubeedge);
-    std::vector<gpu_index> prepare(boost::multi_array_ref<uint64_t, 3>::const_array_view<3>::type view);
-    void upload(const std::vector<gpu_index> & data);
-    void generate(boost::multi_array_ref<std::uint64_t, 3>::const_array_view<3>::type view);
+    /**
+     * @brief converts the ids of the gpu cube at offset into palette slots, thread-safe
+     */
+    static std::vector<std::uint8_t> prepare(const std::uint64_t * cpucube, const int cpucubeedge, const int gpucubeedge, const Coordinate & offset, GpuPalette & palette);
+    void upload(const std::vector<std::uint8_t> & texels) override;
+};
+
+/**
+ * @brief texels of a gpu cube prepared by a worker, uploaded by the gui thread
+ */
+struct PreparedGPUCube {
+    CoordOfGPUCube pos;
+    int magnification;
+    std::uint64_t version;
+    std::vector<std::uint8_t> texels;// empty if the cpu cube was unloaded in the meantime
 };
 
 class TextureLayer {
+    struct Resident {
+        CoordOfGPUCube pos;
+        int magnification;
+        std::uint64_t version;
+        std::unique_ptr<gpu_raw_cube> cube;
+    };
 public:
     QOffscreenSurface surface;
     QOpenGLContext ctx;//ctx has to live past textures
     std::unordered_map<CoordOfGPUCube, std::unique_ptr<gpu_raw_cube>> textures;
+private:
+    // cubes which left the visible supercube, most recently left first
+    std::list<Resident> resident;
+    std::unordered_map<CoordOfGPUCube, std::list<Resident>::iterator> residentIndex;
+    std::size_t hits{0};
+    std::size_t misses{0};
+    std::size_t cubeBytes(const int gpucubeedge) const;
+    void evict();
+    std::unique_ptr<gpu_raw_cube> recycled(const int gpucubeedge);
+    void trim(const int gpucubeedge);
+    void reportHitRate() const;
+    std::unique_ptr<gpu_raw_cube> newCube(const int gpucubeedge);
+    void resetPalette(const int cpucubeedge, const int gpucubeedge);
+    QMutex preparedMutex;
+    std::vector<PreparedGPUCube> prepared;
+public:
+    std::size_t budget{256 * 1024 * 1024};// bytes of visible and resident cubes
+    std::atomic<std::uint64_t> version{0};// incremented when the data of all resident cubes became stale
     std::unique_ptr<gpu_raw_cube> bogusCube;
+    GpuPalette palette;// of overlay layers
     float opacity = 1.0f;
     bool enabled = true;
     bool isOverlayData = false;
     std::vector<std::pair<CoordOfGPUCube, Coordinate>> pendingOrthoCubes;
     std::vector<std::pair<CoordOfGPUCube, Coordinate>> pendingArbCubes;
+    std::unordered_set<CoordOfGPUCube> preparing;// dispatched to the preparationPool, only used by the gui thread
+    std::unordered_set<CoordOfGPUCube> stale;// preparing cubes whose cpu data changed in the meantime, only used by the gui thread
     TextureLayer(QOpenGLContext & sharectx);
     ~TextureLayer();
-    template<typename cube_type, typename elem_type>
-    void createBogusCube(const int cpucubeedge, const int gpucubeedge);
     void createBogusCube(const int cpucubeedge, const int gpucubeedge);
-    template<typename cube_type, typename elem_type>
-    void cubeSubArray(const boost::const_multi_array_ref<elem_type, 3> cube, const int gpucubeedge, const CoordOfGPUCube gpuCoord, const Coordinate offset);
-    void cubeSubArray(const char * data, const int cpucubeedge, const int gpucubeedge, const CoordOfGPUCube gpuCoord, const Coordinate offset);
+    /**
+     * @brief converts the gpu cube at offset of a cpu cube into texels, thread-safe
+     */
+    std::vector<std::uint8_t> prepare(const char * data, const int cpucubeedge, const int gpucubeedge, const Coordinate & offset);
+    void pushPrepared(PreparedGPUCube && cube);
+    bool takePrepared(PreparedGPUCube & cube);
+    bool hasPrepared();
+    /**
+     * @brief uploads the texels of a prepared cube into a new or recycled texture
+     */
+    void upload(const PreparedGPUCube & cube, const int cpucubeedge, const int gpucubeedge);
+    /**
+     * @brief keeps the texture of a cube leaving the visible supercube resident within budget, ctx has to be current
+     */
+    void retire(const CoordOfGPUCube & gpuCoord, const int magnification, const int gpucubeedge);
+    /**
+     * @brief makes a resident texture visible again, returns false if the cube has to be uploaded
+     */
+    bool restore(const CoordOfGPUCube & gpuCoord, const int magnification);
+    /**
+     * @brief drops the resident textures and marks the preparations of the gpu cubes overlapping globalFirst to globalLast as stale
+     */
+    void invalidate(const Coordinate & globalFirst, const Coordinate & globalLast, const int magnification, const int gpucubeedge);
+    /**
+     * @brief drops the visible and resident textures, e.g. after the cpu cubes were replaced by other data
+     */
+    void reset(const int cpucubeedge, const int gpucubeedge);
+    double hitRate() const;
+    QThreadPool preparationPool;// last member, waits for the workers before the layer is destroyed
 };
 
 #endif//GPUCUBER_H
@@ -0,0 +1,229 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#include "overlayslice.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OVERLAYSLICE_X86
+#include <immintrin.h>
+#define OVERLAYSLICE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace OverlaySlice {
+
+ColorCache::ColorCache() : entries(1024) {}
+
+std::size_t ColorCache::slot(const std::uint64_t subobjectId) const {
+    return (subobjectId * 0x9E3779B97F4A7C15ull >> 32) & (entries.size() - 1);//fibonacci hashing, size is a power of 2
+}
+
+void ColorCache::validate(const std::uint64_t newVersion) {
+    if (newVersion != version) {
+        version = newVersion;
+        count = 0;
+        if (++generation == 0) {//wrapped, stale stamps could match again
+            std::fill(std::begin(entries), std::end(entries), Entry{});
+            generation = 1;
+        }
+    }
+}
+
+const ColorCache::Entry * ColorCache::find(const std::uint64_t subobjectId) const {
+    for (auto i = slot(subobjectId);; i = (i + 1) & (entries.size() - 1)) {
+        const auto & entry = entries[i];
+        if (entry.generation != generation) {
+            return nullptr;
+        }
+        if (entry.subobjectId == subobjectId) {
+            return &entry;
+        }
+    }
+}
+
+void ColorCache::grow() {
+    std::vector<Entry> old(entries.size() * 2);
+    std::swap(old, entries);
+    count = 0;
+    for (const auto & entry : old) {
+        if (entry.generation == generation) {
+            insert(entry);
+        }
+    }
+}
+
+const ColorCache::Entry & ColorCache::insert(const Entry & entry) {
+    if (2 * (count + 1) > entries.size()) {//keep probe sequences short
+        grow();
+    }
+    auto i = slot(entry.subobjectId);
+    while (entries[i].generation == generation && entries[i].subobjectId != entry.subobjectId) {
+        i = (i + 1) & (entries.size() - 1);
+    }
+    count += entries[i].generation != generation;
+    entries[i] = entry;
+    entries[i].generation = generation;
+    return entries[i];
+}
+
+Colors::Colors(ColorCache & cache, const Resolver & resolver, const bool hover, const std::uint64_t focusedObject)
+    : cache(cache), resolver(resolver), hover(hover), focusedObject(focusedObject) {}
+
+const std::vector<std::uint8_t> & Colors::edges(const std::uint64_t * ids, const int columns, const int rows) {
+    thread_local std::vector<std::uint64_t> objects;//largest object per voxel for hover edges
+    thread_local std::vector<std::uint8_t> flags;
+    const std::size_t count = static_cast<std::size_t>(columns) * rows;
+    flags.resize(count);
+    if (hover) {
+        objects.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            objects[i] = lookup(ids[i]).objectIndex;
+        }
+        OverlaySlice::edges(objects.data(), flags.data(), columns, rows);
+    } else {
+        OverlaySlice::edges(ids, flags.data(), columns, rows);
+    }
+    return flags;
+}
+
+void Colors::store(std::uint8_t * texel, const std::uint64_t subobjectId, const bool edge) {
+    const auto & entry = lookup(subobjectId);
+    texel[0] = entry.rgba;
+    texel[1] = entry.rgba >> 8;
+    texel[2] = entry.rgba >> 16;
+    texel[3] = entry.rgba >> 24;
+    const bool highlight = entry.selected && edge && (!hover || focusedObject == entry.objectIndex);
+    if (highlight) {
+        texel[3] = std::min(255, texel[3] * 4);
+    }
+}
+
+void gather(const std::uint64_t * cube, std::uint64_t * plane, const int cubeEdge, const RawSlice::Plane slicePlane) {
+    const std::size_t edge = cubeEdge;
+    const std::size_t area = edge * edge;
+    const std::size_t outerStride = slicePlane == RawSlice::Plane::XY ? edge : area;
+    if (slicePlane != RawSlice::Plane::ZY) {
+        for (std::size_t outer = 0; outer < edge; ++outer) {
+            std::copy(cube + outer * outerStride, cube + outer * outerStride + edge, plane + outer * edge);
+        }
+        return;
+    }
+    const std::size_t block = 16;//zy ids are strided along both axes
+    for (std::size_t outer0 = 0; outer0 < edge; outer0 += block) {
+        for (std::size_t inner0 = 0; inner0 < edge; inner0 += block) {
+            for (std::size_t outer = outer0; outer < std::min(edge, outer0 + block); ++outer) {
+                for (std::size_t inner = inner0; inner < std::min(edge, inner0 + block); ++inner) {
+                    plane[outer * edge + inner] = cube[outer * area + inner * edge];
+                }
+            }
+        }
+    }
+}
+
+namespace {
+void edgesScalar(const std::uint64_t * above, const std::uint64_t * row, const std::uint64_t * below, std::uint8_t * edge, const int begin, const int end) {
+    for (int i = begin; i < end; ++i) {
+        edge[i] = row[i] != row[i - 1] || row[i] != row[i + 1] || row[i] != above[i] || row[i] != below[i];
+    }
+}
+
+#ifdef OVERLAYSLICE_X86
+OVERLAYSLICE_TARGET("sse4.1") void edgesSSE41(const std::uint64_t * above, const std::uint64_t * row, const std::uint64_t * below, std::uint8_t * edge, const int begin, const int end) {
+    int i = begin;
+    for (; i + 2 <= end; i += 2) {
+        const auto center = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        const auto left = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i - 1));
+        const auto right = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i + 1));
+        const auto top = _mm_loadu_si128(reinterpret_cast<const __m128i *>(above + i));
+        const auto bottom = _mm_loadu_si128(reinterpret_cast<const __m128i *>(below + i));
+        const auto same = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi64(center, left), _mm_cmpeq_epi64(center, right)),
+                                        _mm_and_si128(_mm_cmpeq_epi64(center, top), _mm_cmpeq_epi64(center, bottom)));
+        const auto mask = _mm_movemask_pd(_mm_castsi128_pd(same));
+        edge[i + 0] = !(mask & 1);
+        edge[i + 1] = !(mask & 2);
+    }
+    edgesScalar(above, row, below, edge, i, end);
+}
+
+OVERLAYSLICE_TARGET("avx2") void edgesAVX2(const std::uint64_t * above, const std::uint64_t * row, const std::uint64_t * below, std::uint8_t * edge, const int begin, const int end) {
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const auto center = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i));
+        const auto left = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i - 1));
+        const auto right = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + i + 1));
+        const auto top = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(above + i));
+        const auto bottom = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(below + i));
+        const auto same = _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi64(center, left), _mm256_cmpeq_epi64(center, right)),
+                                           _mm256_and_si256(_mm256_cmpeq_epi64(center, top), _mm256_cmpeq_epi64(center, bottom)));
+        const auto mask = _mm256_movemask_pd(_mm256_castsi256_pd(same));
+        for (int lane = 0; lane < 4; ++lane) {
+            edge[i + lane] = !(mask & (1 << lane));
+        }
+    }
+    edgesScalar(above, row, below, edge, i, end);
+}
+#endif
+}//unnamed namespace
+
+void edges(const std::uint64_t * plane, std::uint8_t * edge, const int columns, const int rows, const RawSlice::Isa isa) {
+    auto kernel = edgesScalar;
+#ifdef OVERLAYSLICE_X86
+    kernel = isa == RawSlice::Isa::AVX2 ? edgesAVX2 : isa == RawSlice::Isa::SSE41 ? edgesSSE41 : edgesScalar;
+#else
+    static_cast<void>(isa);
+#endif
+    const std::size_t width = columns;
+    std::fill(edge, edge + width, 0);//first and last row and column are never highlighted
+    for (std::size_t y = 1; y + 1 < static_cast<std::size_t>(rows); ++y) {
+        auto * flags = edge + y * width;
+        flags[0] = flags[width - 1] = 0;
+        kernel(plane + (y - 1) * width, plane + y * width, plane + (y + 1) * width, flags, 1, columns - 1);
+    }
+    std::fill(edge + (rows - 1) * width, edge + rows * width, 0);
+}
+
+void edges(const std::uint64_t * plane, std::uint8_t * edge, const int cubeEdge, const RawSlice::Isa isa) {
+    edges(plane, edge, cubeEdge, cubeEdge, isa);
+}
+
+void colorize(const std::uint64_t * cube, std::uint8_t * rgba, const int cubeEdge, const RawSlice::Plane plane, Colors & colors, const RawSlice::Span insideRows, const RawSlice::Span insideColumns) {
+    thread_local std::vector<std::uint64_t> ids;
+    const std::size_t edge = cubeEdge;
+    ids.resize(edge * edge);
+    gather(cube, ids.data(), cubeEdge, plane);
+    const auto & edgeFlags = colors.edges(ids.data(), cubeEdge, cubeEdge);
+    for (std::size_t row = 0; row < edge; ++row) {
+        const bool rowInside = static_cast<int>(row) >= insideRows.begin && static_cast<int>(row) < insideRows.end;
+        for (std::size_t column = 0; column < edge; ++column) {
+            auto * texel = rgba + 4 * (plane == RawSlice::Plane::ZY ? column * edge + row : row * edge + column);
+            if (!rowInside || static_cast<int>(column) < insideColumns.begin || static_cast<int>(column) >= insideColumns.end) {
+                texel[3] = 0;
+                continue;
+            }
+            const auto index = row * edge + column;
+            colors.store(texel, ids[index], edgeFlags[index]);
+        }
+    }
+}
+}//namespace OverlaySlice
@@ -0,0 +1,120 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#ifndef OVERLAYSLICE_H
+#define OVERLAYSLICE_H
+
+#include "slicer/rawslice.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace OverlaySlice {
+/**
+ * @brief Open addressing subobject id → colour table.
+ *
+ * Entries are stamped with a generation, so invalidating the whole table after a segmentation change is O(1).
+ */
+class ColorCache {
+public:
+    struct Entry {
+        std::uint64_t subobjectId;
+        std::uint64_t objectIndex;//largest object containing the subobject, for hover edges
+        std::uint32_t rgba;
+        std::uint32_t generation;
+        bool selected;
+    };
+private:
+    std::vector<Entry> entries;
+    std::size_t count{0};
+    std::uint32_t generation{1};
+    std::uint64_t version{~std::uint64_t{0}};
+    std::size_t slot(const std::uint64_t subobjectId) const;
+    void grow();
+public:
+    ColorCache();
+    /**
+     * @brief drops all entries if version differs from the one they were computed with
+     */
+    void validate(const std::uint64_t version);
+    const Entry * find(const std::uint64_t subobjectId) const;
+    const Entry & insert(const Entry & entry);
+};
+
+/**
+ * @brief Colour, largest object and selection of subobjects missing in a ColorCache, provided by the segmentation.
+ */
+class Resolver {
+public:
+    virtual ~Resolver() = default;
+    virtual ColorCache::Entry resolve(const std::uint64_t subobjectId) const = 0;
+};
+
+/**
+ * @brief Colours ids through a ColorCache, the edges of selected objects are highlighted.
+ *
+ * While hovering, edges run between objects instead of subobjects and only those of the focused object are highlighted.
+ */
+class Colors {
+    ColorCache & cache;
+    const Resolver & resolver;
+    const bool hover;
+    const std::uint64_t focusedObject;
+    const ColorCache::Entry * cached{nullptr};
+public:
+    Colors(ColorCache & cache, const Resolver & resolver, const bool hover, const std::uint64_t focusedObject);
+    const ColorCache::Entry & lookup(const std::uint64_t subobjectId) {
+        if (cached == nullptr || cached->subobjectId != subobjectId) {// neighbouring voxels mostly share their id
+            cached = cache.find(subobjectId);
+            if (cached == nullptr) {
+                cached = &cache.insert(resolver.resolve(subobjectId));
+            }
+        }
+        return *cached;
+    }
+    /**
+     * @brief Edge flags of a columns × rows id plane, valid until the next call on the same thread.
+     */
+    const std::vector<std::uint8_t> & edges(const std::uint64_t * ids, const int columns, const int rows);
+    void store(std::uint8_t * texel, const std::uint64_t subobjectId, const bool edge);
+};
+
+/**
+ * @brief Copies the ids of an orthogonal slice into a dense plane (rows are the outer traversal axis: y for xy, z for xz and zy).
+ */
+void gather(const std::uint64_t * cube, std::uint64_t * plane, const int cubeEdge, const RawSlice::Plane slicePlane);
+/**
+ * @brief Flags interior ids which differ from any of their 4 neighbours.
+ */
+void edges(const std::uint64_t * plane, std::uint8_t * edge, const int cubeEdge, const RawSlice::Isa isa = RawSlice::bestIsa());
+/**
+ * @brief Same for a plane of columns × rows ids.
+ */
+void edges(const std::uint64_t * plane, std::uint8_t * edge, const int columns, const int rows, const RawSlice::Isa isa = RawSlice::bestIsa());
+/**
+ * @brief Writes the plane starting at cube as cubeEdge × cubeEdge RGBA texels (zy transposed like RawSlice::extract),
+ * texels outside of insideRows × insideColumns are transparent.
+ */
+void colorize(const std::uint64_t * cube, std::uint8_t * rgba, const int cubeEdge, const RawSlice::Plane plane, Colors & colors, const RawSlice::Span insideRows, const RawSlice::Span insideColumns);
+}
+
+#endif//OVERLAYSLICE_H
@@ -0,0 +1,261 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#include "rawslice.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RAWSLICE_X86
+#include <immintrin.h>
+#define RAWSLICE_TARGET(isa) __attribute__((target(isa)))
+#define RAWSLICE_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace RawSlice {
+
+namespace {
+Table::Kind classify(const std::array<std::uint32_t, 256> & packed) {
+    bool identity = true;
+    bool grey = true;
+    for (std::uint32_t value = 0; value < packed.size(); ++value) {
+        const auto rgb = packed[value];
+        const auto r = rgb & 0xFF;
+        grey = grey && r == ((rgb >> 8) & 0xFF) && r == ((rgb >> 16) & 0xFF);
+        identity = identity && rgb == value * 0x010101;
+    }
+    return identity ? Table::Kind::Identity : grey ? Table::Kind::Grey : Table::Kind::Colour;
+}
+
+void finishTable(Table & table) {
+    for (std::size_t value = 0; value < table.packed.size(); ++value) {
+        for (std::size_t channel = 0; channel < 3; ++channel) {
+            table.planes[channel][value] = (table.packed[value] >> (8 * channel)) & 0xFF;
+        }
+    }
+    table.kind = classify(table.packed);
+}
+
+int floorDiv(const int numerator, const int denominator) {
+    return numerator / denominator - (numerator % denominator != 0 && (numerator < 0) != (denominator < 0));
+}
+
+void rowScalar(const std::uint8_t * src, std::uint8_t * dst, const int count, const Table & table) {
+    for (int i = 0; i < count; ++i) {
+        const auto rgb = table.packed[src[i]];
+        dst[3 * i + 0] = rgb;
+        dst[3 * i + 1] = rgb >> 8;
+        dst[3 * i + 2] = rgb >> 16;
+    }
+}
+
+#ifdef RAWSLICE_X86
+/**
+ * @brief pshufb masks which spread 16 pixels over 48 RGB bytes, [vector][channel] (channel 3 takes the grey value for all channels)
+ */
+struct InterleaveMasks {
+    alignas(16) std::uint8_t masks[3][4][16];
+    InterleaveMasks() {
+        for (int vector = 0; vector < 3; ++vector) {
+            for (int byte = 0; byte < 16; ++byte) {
+                const int pixel = (16 * vector + byte) / 3;
+                const int channel = (16 * vector + byte) % 3;
+                for (int c = 0; c < 3; ++c) {
+                    masks[vector][c][byte] = c == channel ? pixel : 0x80;//high bit → zero
+                }
+                masks[vector][3][byte] = pixel;
+            }
+        }
+    }
+};
+const InterleaveMasks interleave;
+
+RAWSLICE_TARGET("sse4.1") RAWSLICE_INLINE __m128i mask(const int vector, const int channel) {
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(interleave.masks[vector][channel]));
+}
+
+RAWSLICE_TARGET("sse4.1") RAWSLICE_INLINE void storeGrey(const __m128i grey, std::uint8_t * dst) {
+    for (int vector = 0; vector < 3; ++vector) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16 * vector), _mm_shuffle_epi8(grey, mask(vector, 3)));
+    }
+}
+
+RAWSLICE_TARGET("sse4.1") RAWSLICE_INLINE void storeRGB(const __m128i r, const __m128i g, const __m128i b, std::uint8_t * dst) {
+    for (int vector = 0; vector < 3; ++vector) {
+        const auto rgb = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, mask(vector, 0)), _mm_shuffle_epi8(g, mask(vector, 1))), _mm_shuffle_epi8(b, mask(vector, 2)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16 * vector), rgb);
+    }
+}
+
+RAWSLICE_TARGET("sse4.1") RAWSLICE_INLINE void pixelsSSE41(const std::uint8_t * src, std::uint8_t * dst, const Table & table) {
+    if (table.kind == Table::Kind::Identity) {
+        storeGrey(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)), dst);
+    } else {// grey
+        alignas(16) std::uint8_t grey[16];
+        for (int i = 0; i < 16; ++i) {//scalar lookups beat 16 pshufbs over the nibbles of the table
+            grey[i] = table.planes[0][src[i]];
+        }
+        storeGrey(_mm_load_si128(reinterpret_cast<const __m128i *>(grey)), dst);
+    }
+}
+
+RAWSLICE_TARGET("sse4.1") void rowSSE41(const std::uint8_t * src, std::uint8_t * dst, const int count, const Table & table) {
+    if (count < 16 || table.kind == Table::Kind::Colour) {//without gathers colour lookups are fastest as scalar loop
+        rowScalar(src, dst, count, table);
+        return;
+    }
+    for (int i = 0; i + 16 <= count; i += 16) {
+        pixelsSSE41(src + i, dst + 3 * i, table);
+    }
+    if (count % 16 != 0) {//overlap the last full vector instead of a scalar tail
+        pixelsSSE41(src + count - 16, dst + 3 * (count - 16), table);
+    }
+}
+
+RAWSLICE_TARGET("avx2") void rowAVX2(const std::uint8_t * src, std::uint8_t * dst, const int count, const Table & table) {
+    if (table.kind != Table::Kind::Colour) {
+        rowSSE41(src, dst, count, table);//grey expansion is shuffle bound, wider registers don’t help
+        return;
+    }
+    //drop the 4th byte of every gathered 0x00BBGGRR texel
+    const auto compact = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const auto * packed = reinterpret_cast<const int *>(table.packed.data());
+    if (count < 16) {
+        rowScalar(src, dst, count, table);
+        return;
+    }
+    for (int i = 0; i < count; i += 16) {
+        i = std::min(i, count - 16);//overlap the last full vector instead of a scalar tail
+        const auto values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const auto texels0 = _mm256_i32gather_epi32(packed, _mm256_cvtepu8_epi32(values), 4);
+        const auto texels1 = _mm256_i32gather_epi32(packed, _mm256_cvtepu8_epi32(_mm_srli_si128(values, 8)), 4);
+        const auto a = _mm_shuffle_epi8(_mm256_castsi256_si128(texels0), compact);//12 bytes each
+        const auto b = _mm_shuffle_epi8(_mm256_extracti128_si256(texels0, 1), compact);
+        const auto c = _mm_shuffle_epi8(_mm256_castsi256_si128(texels1), compact);
+        const auto d = _mm_shuffle_epi8(_mm256_extracti128_si256(texels1, 1), compact);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 3 * i), _mm_or_si128(a, _mm_slli_si128(b, 12)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 3 * i + 16), _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 3 * i + 32), _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+    }
+}
+#endif
+
+using RowKernel = void (*)(const std::uint8_t *, std::uint8_t *, const int, const Table &);
+
+RowKernel rowKernel(const Isa isa) {
+#ifdef RAWSLICE_X86
+    if (isa == Isa::AVX2) {
+        return rowAVX2;
+    } else if (isa == Isa::SSE41) {
+        return rowSSE41;
+    }
+#else
+    static_cast<void>(isa);
+#endif
+    return rowScalar;
+}
+
+}//unnamed namespace
+
+Tables makeTables(const std::vector<std::tuple<std::uint8_t, std::uint8_t, std::uint8_t>> * lut, const float outsideMovementAreaFactor) {
+    Tables tables;
+    const float dim = outsideMovementAreaFactor * 1.0 / 100;
+    for (std::uint32_t value = 0; value < 256; ++value) {
+        std::uint8_t r = value, g = value, b = value;
+        if (lut != nullptr) {
+            std::tie(r, g, b) = (*lut)[value];
+        }
+        tables.inside.packed[value] = r | (g << 8) | (b << 16);
+        r *= dim; g *= dim; b *= dim;// same truncation as the per voxel dimming
+        tables.outside.packed[value] = r | (g << 8) | (b << 16);
+    }
+    finishTable(tables.inside);
+    finishTable(tables.outside);
+    return tables;
+}
+
+Span insideSpan(const int cubeMin, const int areaMin, const int areaMax, const int magnification, const int cubeEdge) {
+    const int begin = std::min(cubeEdge, std::max(0, -floorDiv(cubeMin - areaMin, magnification)));//ceil((areaMin - cubeMin) / mag)
+    const int end = std::min(cubeEdge, std::max(0, floorDiv(areaMax - cubeMin, magnification) + 1));
+    return {begin, std::max(begin, end)};
+}
+
+Isa bestIsa() {
+#ifdef RAWSLICE_X86
+    static const Isa isa = [](){
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? Isa::AVX2 : __builtin_cpu_supports("sse4.1") ? Isa::SSE41 : Isa::Scalar;
+    }();
+    return isa;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+void extract(const std::uint8_t * cube, std::uint8_t * rgb, const int cubeEdge, const Plane plane, const Tables & tables, const Span insideRows, const Span insideColumns, const Isa isa) {
+    const std::size_t edge = cubeEdge;
+    const std::size_t area = edge * edge;
+    const std::size_t srcRowStride = plane == Plane::XY ? edge : area;
+    thread_local std::vector<std::uint8_t> zyRow;
+    zyRow.resize(edge);
+    const auto row = rowKernel(isa);
+    const bool columnsInside = insideColumns.begin < insideColumns.end;
+    for (int y = 0; y < cubeEdge; ++y, rgb += 3 * edge) {
+        const auto * src = cube + y * srcRowStride;
+        if (plane == Plane::ZY) {// z is strided by a whole area, gather the row first
+            const auto * voxel = cube + y * edge;
+            for (std::size_t z = 0; z < edge; ++z, voxel += area) {
+                zyRow[z] = *voxel;
+            }
+            src = zyRow.data();
+        }
+        if (!columnsInside || y < insideRows.begin || y >= insideRows.end) {
+            row(src, rgb, cubeEdge, tables.outside);
+            continue;
+        }
+        row(src, rgb, insideColumns.begin, tables.outside);
+        row(src + insideColumns.begin, rgb + 3 * insideColumns.begin, insideColumns.end - insideColumns.begin, tables.inside);
+        row(src + insideColumns.end, rgb + 3 * insideColumns.end, cubeEdge - insideColumns.end, tables.outside);
+    }
+}
+
+int mipLevels(const int cubeEdge, const int maxLevels) {
+    int levels = 0;
+    for (int edge = cubeEdge; levels < maxLevels && edge % 8 == 0; edge /= 2) {
+        ++levels;
+    }
+    return levels;
+}
+
+void halve(const std::uint8_t * rgb, std::uint8_t * half, const int edge) {
+    const std::size_t stride = 3 * static_cast<std::size_t>(edge);
+    for (int y = 0; y < edge / 2; ++y, rgb += 2 * stride) {
+        for (std::size_t x = 0; x < stride; x += 6) {
+            for (std::size_t channel = 0; channel < 3; ++channel) {
+                const auto sum = rgb[x + channel] + rgb[x + 3 + channel] + rgb[stride + x + channel] + rgb[stride + x + 3 + channel];
+                *half++ = (sum + 2) / 4;
+            }
+        }
+    }
+}
+}//namespace RawSlice
@@ -0,0 +1,99 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#ifndef RAWSLICE_H
+#define RAWSLICE_H
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+/**
+ * @brief Extraction of orthogonal grey value slices from raw datacubes into RGB textures.
+ *
+ * Kept free of Qt and viewer state so it can be benchmarked in isolation.
+ */
+namespace RawSlice {
+enum class Plane {
+    XY, XZ, ZY
+};
+enum class Isa {
+    Scalar, SSE41, AVX2
+};
+
+/**
+ * @brief Grey value → RGB lookup, packed (0x00BBGGRR) for gathers and planar for byte shuffles.
+ */
+struct Table {
+    enum class Kind {
+        Identity, Grey, Colour
+    };
+    alignas(16) std::array<std::uint32_t, 256> packed;
+    alignas(16) std::array<std::array<std::uint8_t, 256>, 3> planes;
+    Kind kind;
+};
+
+/**
+ * @brief Tables for voxels inside and outside (dimmed) of the movement area.
+ */
+struct Tables {
+    Table inside;
+    Table outside;
+};
+
+/**
+ * @brief [begin, end) of rows or columns of a slice.
+ */
+struct Span {
+    int begin;
+    int end;
+};
+
+Tables makeTables(const std::vector<std::tuple<std::uint8_t, std::uint8_t, std::uint8_t>> * lut, const float outsideMovementAreaFactor);
+/**
+ * @brief voxels with indices i satisfying areaMin <= cubeMin + i * magnification <= areaMax
+ */
+Span insideSpan(const int cubeMin, const int areaMin, const int areaMax, const int magnification, const int cubeEdge);
+Isa bestIsa();
+
+/**
+ * @brief Writes the plane starting at cube as cubeEdge × cubeEdge RGB texels into rgb.
+ *
+ * XY and XZ rows are contiguous in the cube, ZY rows are gathered along z first (texture rows are y, columns are z).
+ * Voxels in insideRows × insideColumns use the inside table, all others the outside table.
+ */
+void extract(const std::uint8_t * cube, std::uint8_t * rgb, const int cubeEdge, const Plane plane, const Tables & tables, const Span insideRows, const Span insideColumns, const Isa isa = bestIsa());
+
+/**
+ * @brief Mipmap levels kept below a cubeEdge × cubeEdge slice, at most maxLevels.
+ *
+ * Every level edge stays divisible by 4, so its RGB rows keep the default unpack alignment.
+ */
+int mipLevels(const int cubeEdge, const int maxLevels = 4);
+/**
+ * @brief Box filters edge × edge RGB texels into the (edge / 2) × (edge / 2) texels of the next mipmap level.
+ */
+void halve(const std::uint8_t * rgb, std::uint8_t * half, const int edge);
+}
+
+#endif//RAWSLICE_H
@@ -0,0 +1,87 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#include "texturestream.h"
+
+#include <QDebug>
+#include <QOpenGLContext>
+
+bool TextureStream::pboAvailable() {
+    if (!pboSupport) {
+        const auto * context = QOpenGLContext::currentContext();
+        pboSupport = context != nullptr && !context->isOpenGLES()
+                && (context->format().version() >= qMakePair(2, 1) || context->hasExtension("GL_ARB_pixel_buffer_object"));
+        if (!pboSupport.get()) {
+            qDebug() << "pixel buffer objects unavailable, textures are uploaded synchronously";
+        }
+    }
+    return pboSupport.get();
+}
+
+TextureStream::Staging TextureStream::stage(const std::size_t bytes) {
+    auto & slot = slots[next];
+    next = (next + 1) % slots.size();
+    if (pboAvailable()) {
+        // buffers of a destroyed context (e.g. after undocking a viewport) report not being created anymore
+        if ((slot.buffer.isCreated() || slot.buffer.create()) && slot.buffer.bind()) {
+            slot.buffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+            slot.buffer.allocate(static_cast<int>(bytes));// orphans the previous storage, the driver may still be reading from it
+            slot.mapped = static_cast<char *>(slot.buffer.map(QOpenGLBuffer::WriteOnly));
+            slot.buffer.release();
+        }
+        if (slot.mapped != nullptr) {
+            return {&slot, slot.mapped};
+        }
+        qDebug() << "mapping pixel buffer object failed, textures are uploaded synchronously";
+        pboSupport = false;
+    }
+    slot.client.resize(bytes);
+    return {&slot, slot.client.data()};
+}
+
+void TextureStream::upload(Staging & staging, const std::function<void(const char * pixels)> & transfer) {
+    auto & slot = *staging.slot;
+    if (slot.mapped != nullptr && staging.data == slot.mapped) {
+        slot.buffer.bind();
+        slot.buffer.unmap();
+        slot.mapped = nullptr;
+        transfer(nullptr);// the copy from the buffer into the texture happens asynchronously
+        slot.buffer.release();
+    } else {
+        transfer(staging.data);
+    }
+    staging.data = nullptr;
+}
+
+void TextureStream::destroy() {
+    for (auto & slot : slots) {
+        if (slot.mapped != nullptr) {
+            slot.buffer.bind();
+            slot.buffer.unmap();
+            slot.buffer.release();
+            slot.mapped = nullptr;
+        }
+        slot.buffer.destroy();
+        slot.client = {};
+    }
+    pboSupport = boost::none;
+}
@@ -0,0 +1,67 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#ifndef TEXTURESTREAM_H
+#define TEXTURESTREAM_H
+
+#include <QOpenGLBuffer>
+
+#include <boost/optional.hpp>
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Streams texture uploads through a small ring of orphaned GL_STREAM_DRAW pixel unpack buffers.
+ *
+ * stage() and upload() have to be called on the GL thread with the same context current,
+ * the staged memory itself may be filled from any thread in between.
+ * Without pixel buffer objects (or if mapping fails) client memory is staged and uploads are synchronous.
+ */
+class TextureStream {
+    struct Slot {
+        QOpenGLBuffer buffer{QOpenGLBuffer::PixelUnpackBuffer};
+        std::vector<char> client;
+        char * mapped{nullptr};
+    };
+    std::array<Slot, 3> slots;
+    std::size_t next{0};
+    boost::optional<bool> pboSupport;
+    bool pboAvailable();
+public:
+    struct Staging {
+        Slot * slot;
+        char * data;
+    };
+    Staging stage(const std::size_t bytes);
+    /**
+     * @brief transfer issues the gl(Sub)TexImage calls, pixels is the base of the staged data
+     *
+     * With a pixel unpack buffer bound pixels is nullptr, offsets from it are offsets into the buffer.
+     */
+    void upload(Staging & staging, const std::function<void(const char * pixels)> & transfer);
+    void destroy();
+};
+
+#endif//TEXTURESTREAM_H
@@ -0,0 +1,146 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#include "volumeslice.h"
+
+#include <algorithm>
+
+namespace VolumeSlice {
+
+int bricksPerAxis(const int texLen) {
+    return (texLen + brickEdge - 1) / brickEdge;
+}
+
+Box brick(const int index, const int texLen) {
+    const auto count = bricksPerAxis(texLen);
+    const std::array<int, 3> first{{index % count * brickEdge, index / count % count * brickEdge, index / count / count * brickEdge}};
+    return {first, {{std::min(texLen, first[0] + brickEdge), std::min(texLen, first[1] + brickEdge), std::min(texLen, first[2] + brickEdge)}}};
+}
+
+int cellsPerAxis(const int texLen) {
+    return (texLen + cellEdge - 1) / cellEdge;
+}
+
+std::vector<std::uint64_t> sample(const ArbSlice::Grid<std::uint64_t> & grid, const Box & box, std::uint64_t * ids) {
+    const std::size_t stride = grid.supercubeEdge;
+    const std::size_t cubeEdge = grid.cubeEdge;
+    std::vector<std::uint64_t> distinct;
+    for (int z = box.first[2]; z < box.end[2]; ++z)
+    for (int y = box.first[1]; y < box.end[1]; ++y) {
+        const std::size_t voxelY = y * stride;
+        const std::size_t voxelZ = z * stride;
+        const auto rowOffset = (voxelZ % cubeEdge * cubeEdge + voxelY % cubeEdge) * cubeEdge;
+        for (int x = box.first[0]; x < box.end[0]; ++x) {
+            const std::size_t voxelX = x * stride;
+            const auto * cube = grid.cube(voxelX / cubeEdge, voxelY / cubeEdge, voxelZ / cubeEdge);
+            const auto id = cube != nullptr ? cube[rowOffset + voxelX % cubeEdge] : missing;
+            if (id != missing && (distinct.empty() || distinct.back() != id)) {// runs are cheap to skip before sorting
+                distinct.emplace_back(id);
+            }
+            *ids++ = id;
+        }
+    }
+    std::sort(std::begin(distinct), std::end(distinct));
+    distinct.erase(std::unique(std::begin(distinct), std::end(distinct)), std::end(distinct));
+    return distinct;
+}
+
+void colorize(const std::uint64_t * ids, const Box & box, const std::unordered_map<std::uint64_t, Rgba> & colors, std::uint8_t * volume, const int texLen) {
+    const std::size_t len = texLen;
+    auto lastId = missing;
+    Rgba lastColor{{}};
+    for (int z = box.first[2]; z < box.end[2]; ++z)
+    for (int y = box.first[1]; y < box.end[1]; ++y) {
+        auto * texel = volume + 4 * ((z * len + y) * len + box.first[0]);
+        for (int x = box.first[0]; x < box.end[0]; ++x, ++ids, texel += 4) {
+            if (*ids != lastId) {
+                const auto it = colors.find(*ids);
+                lastColor = it != std::end(colors) ? it->second : Rgba{{}};
+                lastId = *ids;
+            }
+            std::copy(std::begin(lastColor), std::end(lastColor), texel);
+        }
+    }
+}
+
+namespace {
+// value after n successive truncating multiplications by 0.95
+struct ShadeTable {
+    std::array<std::array<std::uint8_t, 256>, 7> values;
+    ShadeTable() {
+        for (int value = 0; value < 256; ++value) {
+            values[0][value] = value;
+            for (std::size_t n = 1; n < values.size(); ++n) {
+                values[n][value] = values[n - 1][value] * 0.95f;
+            }
+        }
+    }
+};
+}//unnamed namespace
+
+void shade(const std::uint8_t * volume, const Box & box, const int texLen, std::uint8_t * shaded) {
+    static const ShadeTable table;
+    const std::ptrdiff_t len = texLen;
+    const std::ptrdiff_t area = len * len;
+    const auto width = box.end[0] - box.first[0];
+    std::vector<std::uint8_t> neighbours(width);
+    for (int z = box.first[2]; z < box.end[2]; ++z)
+    for (int y = box.first[1]; y < box.end[1]; ++y) {
+        const auto * row = volume + 4 * ((z * len + y) * len + box.first[0]);
+        std::fill(std::begin(neighbours), std::end(neighbours), 0);
+        if (y > 0 && z > 0 && y < texLen - 1 && z < texLen - 1) {// count occupied neighbours of the row, branch-free so it vectorises
+            const std::ptrdiff_t begin = box.first[0] == 0 ? 1 : 0;
+            const std::ptrdiff_t end = box.end[0] == texLen ? width - 1 : width;
+            const auto * alpha = row + 3;
+            for (std::ptrdiff_t x = begin; x < end; ++x) {
+                const auto * a = alpha + 4 * x;
+                neighbours[x] = (a[-4] != 0) + (a[4] != 0) + (a[-4 * len] != 0) + (a[4 * len] != 0) + (a[-4 * area] != 0) + (a[4 * area] != 0);
+            }
+        }
+        for (int x = 0; x < width; ++x, shaded += 4) {
+            const auto * texel = row + 4 * x;
+            const auto & values = table.values[texel[3] != 0 ? neighbours[x] : 0];
+            shaded[0] = values[texel[0]];
+            shaded[1] = values[texel[1]];
+            shaded[2] = values[texel[2]];
+            shaded[3] = texel[3];
+        }
+    }
+}
+void occupancy(const std::uint8_t * volume, const Box & box, const int texLen, std::uint8_t * cells) {
+    const std::size_t len = texLen;
+    const std::size_t count = cellsPerAxis(texLen);
+    for (int cz = box.first[2]; cz < box.end[2]; cz += cellEdge)
+    for (int cy = box.first[1]; cy < box.end[1]; cy += cellEdge)
+    for (int cx = box.first[0]; cx < box.end[0]; cx += cellEdge) {
+        bool occupied = false;
+        for (int z = cz; z < std::min(box.end[2], cz + cellEdge) && !occupied; ++z)
+        for (int y = cy; y < std::min(box.end[1], cy + cellEdge) && !occupied; ++y) {
+            const auto * alpha = volume + 4 * ((z * len + y) * len + cx) + 3;
+            for (int x = 0; x < std::min(box.end[0], cx + cellEdge) - cx; ++x) {
+                occupied |= alpha[4 * x] != 0;
+            }
+        }
+        cells[(cz / cellEdge * count + cy / cellEdge) * count + cx / cellEdge] = occupied;
+    }
+}
+}//namespace VolumeSlice
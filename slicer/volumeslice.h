@@ -0,0 +1,80 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#ifndef VOLUMESLICE_H
+#define VOLUMESLICE_H
+
+#include "slicer/arbslice.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Brick-wise generation of the segmentation volume texture, texel x samples voxel x * supercubeEdge of the supercube.
+ *
+ * Kept free of Qt and viewer state like ArbSlice, distinct bricks can be processed concurrently.
+ */
+namespace VolumeSlice {
+constexpr int brickEdge = 16;
+constexpr int cellEdge = 8;// of the occupancy grid, divides brickEdge
+// id of texels inside of missing cubes, never coloured
+constexpr std::uint64_t missing = ~std::uint64_t{0};
+
+using Rgba = std::array<std::uint8_t, 4>;
+
+/**
+ * @brief Texels [first, end) of the volume.
+ */
+struct Box {
+    std::array<int, 3> first;
+    std::array<int, 3> end;
+    std::size_t size() const {
+        return static_cast<std::size_t>(end[0] - first[0]) * (end[1] - first[1]) * (end[2] - first[2]);
+    }
+};
+
+int bricksPerAxis(const int texLen);
+Box brick(const int index, const int texLen);
+int cellsPerAxis(const int texLen);
+
+/**
+ * @brief Samples the ids of the box (x fastest) and returns the sorted distinct ids of loaded cubes among them.
+ */
+std::vector<std::uint64_t> sample(const ArbSlice::Grid<std::uint64_t> & grid, const Box & box, std::uint64_t * ids);
+/**
+ * @brief Writes the colours of the box-sized ids into the texLen³ rgba volume, ids without colour are transparent.
+ */
+void colorize(const std::uint64_t * ids, const Box & box, const std::unordered_map<std::uint64_t, Rgba> & colors, std::uint8_t * volume, const int texLen);
+/**
+ * @brief Darkens the occupied interior texels of the box by 0.95 per occupied face neighbour into box-sized rgba.
+ */
+void shade(const std::uint8_t * volume, const Box & box, const int texLen, std::uint8_t * shaded);
+/**
+ * @brief Sets the cells of the occupancy grid (cellsPerAxis³, x fastest) inside of the brick box to whether they contain an opaque texel.
+ */
+void occupancy(const std::uint8_t * volume, const Box & box, const int texLen, std::uint8_t * cells);
+}
+
+#endif//VOLUMESLICE_H
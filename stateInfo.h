@@ -31,6 +31,8 @@
 #include <QString>
 #include <QWaitCondition>
 
+#include <unordered_map>
+
 class stateInfo;
 extern stateInfo * state;
 
@@ -140,6 +142,10 @@ public:
     // this structure.
     coord2bytep_map_t Dc2Pointer[int_log(NUM_MAG_DATASETS)+1];
     coord2bytep_map_t Oc2Pointer[int_log(NUM_MAG_DATASETS)+1];
+    // Slots of cubes which the viewer reads after releasing protectCube2Pointer,
+    // with their pin count. The loader doesn’t write into a pinned slot.
+    // Also guarded by protectCube2Pointer.
+    std::unordered_map<const char *, int> pinnedCubes;
 
     struct ViewerState * viewerState;
     class MainWindow * mainWindow{nullptr};
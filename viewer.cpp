@@ -24,9 +24,12 @@
 
 #include "file_io.h"
 #include "functions.h"
+#include "segmentation/cubeloader.h"
 #include "segmentation/segmentation.h"
 #include "session.h"
 #include "skeleton/skeletonizer.h"
+#include "slicer/arbslice.h"
+#include "slicer/overlayslice.h"
 #include "widgets/mainwindow.h"
 #include "widgets/viewport.h"
 #include "widgets/widgetcontainer.h"
@@ -34,11 +37,16 @@
 #include <QApplication>
 #include <QDebug>
 #include <QDesktopWidget>
+#include <QMutexLocker>
+#include <QScreen>
+#include <QThread>
 #include <qopengl.h>
+#include <QtConcurrent>
 #include <QVector3D>
 
 #include <fstream>
 #include <cmath>
+#include <unordered_set>
 
 Viewer::Viewer() : layerVisibility(2, true) {
     state->viewer = this;
@@ -50,15 +58,46 @@ Viewer::Viewer() : layerVisibility(2, true) {
     rewire();
 
     timer.setSingleShot(true);
-    QObject::connect(&timer, &QTimer::timeout, this, &Viewer::run); // timer is started in Viewer::run.
+    timer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&timer, &QTimer::timeout, this, &Viewer::run); // timer is started by posting damage
+    qApp->installEventFilter(this);// user input damages the viewports
+    const auto damage = [this](){ postDamage(); };
+    QObject::connect(skeletonizer, &Skeletonizer::resetData, damage);
+    QObject::connect(skeletonizer, &Skeletonizer::nodeAddedSignal, damage);
+    QObject::connect(skeletonizer, &Skeletonizer::nodeChangedSignal, damage);
+    QObject::connect(skeletonizer, &Skeletonizer::nodeRemovedSignal, damage);
+    QObject::connect(skeletonizer, &Skeletonizer::treeAddedSignal, damage);
+    QObject::connect(skeletonizer, &Skeletonizer::treeChangedSignal, damage);
+    QObject::connect(skeletonizer, &Skeletonizer::treeRemovedSignal, damage);
+    QObject::connect(skeletonizer, &Skeletonizer::treesMerged, damage);
+    QObject::connect(skeletonizer, &Skeletonizer::nodeSelectionChangedSignal, damage);
+    QObject::connect(skeletonizer, &Skeletonizer::treeSelectionChangedSignal, damage);
 
     QObject::connect(&Segmentation::singleton(), &Segmentation::appendedRow, this, &Viewer::oc_reslice_notify_visible);
-    QObject::connect(&Segmentation::singleton(), &Segmentation::changedRow, this, &Viewer::oc_reslice_notify_visible);
-    QObject::connect(&Segmentation::singleton(), &Segmentation::changedRowSelection, this, &Viewer::oc_reslice_notify_visible);
+    QObject::connect(&Segmentation::singleton(), &Segmentation::changedRow, this, &Viewer::oc_reslice_notify_object);
+    QObject::connect(&Segmentation::singleton(), &Segmentation::changedRowSelection, this, &Viewer::oc_reslice_notify_object);
     QObject::connect(&Segmentation::singleton(), &Segmentation::removedRow, this, &Viewer::oc_reslice_notify_visible);
     QObject::connect(&Segmentation::singleton(), &Segmentation::resetData, this, &Viewer::oc_reslice_notify_visible);
     QObject::connect(&Segmentation::singleton(), &Segmentation::resetSelection, this, &Viewer::oc_reslice_notify_visible);
     QObject::connect(&Segmentation::singleton(), &Segmentation::renderOnlySelectedObjsChanged, this, &Viewer::oc_reslice_notify_visible);
+    // gpu overlay cubes keep their palette slots, only the colours of the affected slots change
+    const auto recolorAll = [this](){ recolorOverlayPalettes(); };
+    QObject::connect(&Segmentation::singleton(), &Segmentation::appendedRow, recolorAll);
+    QObject::connect(&Segmentation::singleton(), &Segmentation::removedRow, recolorAll);
+    QObject::connect(&Segmentation::singleton(), &Segmentation::resetData, recolorAll);
+    QObject::connect(&Segmentation::singleton(), &Segmentation::resetSelection, recolorAll);
+    QObject::connect(&Segmentation::singleton(), &Segmentation::renderOnlySelectedObjsChanged, recolorAll);
+    QObject::connect(&Segmentation::singleton(), &Segmentation::backgroundIdChanged, recolorAll);
+    QObject::connect(&Segmentation::singleton(), &Segmentation::changedRow, [this](const int index){
+        recolorOverlayPalettes(index);
+    });
+    QObject::connect(&Segmentation::singleton(), &Segmentation::changedRowSelection, [this](const int index){
+        if (Segmentation::singleton().renderOnlySelectedObjs) {// hides or shows unselected objects
+            recolorOverlayPalettes();
+        } else {
+            recolorOverlayPalettes(index);
+        }
+    });
 
     QObject::connect(&Session::singleton(), &Session::movementAreaChanged, this, &Viewer::updateCurrentPosition);
     QObject::connect(&Session::singleton(), &Session::movementAreaChanged, this, &Viewer::dc_reslice_notify_visible);
@@ -130,6 +169,7 @@ void Viewer::loadSettings() {
 
 void Viewer::setMovementAreaFactor(float alpha) {
     state->viewerState->outsideMovementAreaFactor = alpha;
+    rawSliceTables.fill(boost::none);
     emit movementAreaFactorChangedSignal();
 }
 
@@ -181,116 +221,95 @@ void Viewer::setMagnificationLock(const bool locked) {
     emit magnificationLockChanged(locked);
 }
 
-void Viewer::dcSliceExtract(char *datacube, Coordinate cubePosInAbsPx, char *slice, ViewportOrtho & vp, bool useCustomLUT) {
-    const auto & session = Session::singleton();
-    const Coordinate areaMinCoord = {session.movementAreaMin.x,
-                                     session.movementAreaMin.y,
-                                     session.movementAreaMin.z};
-    const Coordinate areaMaxCoord = {session.movementAreaMax.x,
-                                     session.movementAreaMax.y,
-                                     session.movementAreaMax.z};
-
-    const auto partlyInMovementArea =
-       areaMinCoord.x > cubePosInAbsPx.x || areaMaxCoord.x < cubePosInAbsPx.x + state->cubeEdgeLength * state->magnification ||
-       areaMinCoord.y > cubePosInAbsPx.y || areaMaxCoord.y < cubePosInAbsPx.y + state->cubeEdgeLength * state->magnification ||
-       areaMinCoord.z > cubePosInAbsPx.z || areaMaxCoord.z < cubePosInAbsPx.z + state->cubeEdgeLength * state->magnification;
-
-    const std::size_t voxelIncrement = vp.viewportType == VIEWPORT_ZY ? state->cubeEdgeLength : 1;
-    const std::size_t sliceIncrement = vp.viewportType == VIEWPORT_XY ? state->cubeEdgeLength : state->cubeSliceArea;
-    const std::size_t sliceSubLineIncrement = vp.viewportType == VIEWPORT_ZY ? 0 : sliceIncrement - state->cubeEdgeLength;
-    const std::size_t texNextLine = vp.viewportType == VIEWPORT_ZY ? state->cubeEdgeLength * 3 : 3;// RGB per pixel
-    const std::size_t texRevertToFirstLine = vp.viewportType == VIEWPORT_ZY ? (state->cubeSliceArea - 1) * 3 : 0;
-
-    int offsetX = 0, offsetY = 0;
-    const int coordsPerLine = state->cubeEdgeLength * state->magnification;
-    for (auto y = state->cubeEdgeLength; y != 0; --y) {
-        for (auto x = state->cubeEdgeLength; x != 0; --x) {// x and y’s values are not used
-            uint8_t r, g, b;
-            if(useCustomLUT) {
-                //extract data as unsigned number from the datacube
-                const uint8_t adjustIndex = reinterpret_cast<uint8_t*>(datacube)[0];
-                r = std::get<0>(state->viewerState->datasetAdjustmentTable[adjustIndex]);
-                g = std::get<1>(state->viewerState->datasetAdjustmentTable[adjustIndex]);
-                b = std::get<2>(state->viewerState->datasetAdjustmentTable[adjustIndex]);
-            } else {
-                r = g = b = reinterpret_cast<uint8_t*>(datacube)[0];
-            }
-            if(partlyInMovementArea) {
-                bool factor = false;
-                if((vp.viewportType == VIEWPORT_XY && (cubePosInAbsPx.y + offsetY < areaMinCoord.y || cubePosInAbsPx.y + offsetY > areaMaxCoord.y)) ||
-                    ((vp.viewportType == VIEWPORT_XZ || vp.viewportType == VIEWPORT_ZY) && (cubePosInAbsPx.z + offsetY < areaMinCoord.z || cubePosInAbsPx.z + offsetY > areaMaxCoord.z))) {
-                    // vertically out of movement area
-                    factor = true;
-                }
-                else if(((vp.viewportType == VIEWPORT_XY || vp.viewportType == VIEWPORT_XZ) && (cubePosInAbsPx.x + offsetX < areaMinCoord.x || cubePosInAbsPx.x + offsetX > areaMaxCoord.x)) ||
-                        (vp.viewportType == VIEWPORT_ZY && (cubePosInAbsPx.y + offsetX < areaMinCoord.y || cubePosInAbsPx.y + offsetX > areaMaxCoord.y))) {
-                    // horizontally out of movement area
-                    factor = true;
-                }
-                if (factor) {
-                    float d = state->viewerState->outsideMovementAreaFactor * 1.0 / 100;
-                    r *= d; g *= d; b *= d;
-                }
-            }
-            reinterpret_cast<uint8_t*>(slice)[0] = r;
-            reinterpret_cast<uint8_t*>(slice)[1] = g;
-            reinterpret_cast<uint8_t*>(slice)[2] = b;
-
-            datacube += voxelIncrement;
-            slice += texNextLine;
-            offsetX = (offsetX + state->magnification) % coordsPerLine;
-            offsetY += (offsetX == 0)? state->magnification : 0; // at end of line increment to next line
-        }
-        datacube += sliceSubLineIncrement;
-        slice -= texRevertToFirstLine;
+const RawSlice::Tables & Viewer::sliceTables(const bool useCustomLUT) {
+    auto & tables = rawSliceTables[useCustomLUT];
+    if (!tables) {
+        tables = RawSlice::makeTables(useCustomLUT ? &state->viewerState->datasetAdjustmentTable : nullptr, state->viewerState->outsideMovementAreaFactor);
     }
+    return tables.get();
 }
 
-void Viewer::dcSliceExtract(char *datacube, floatCoordinate *currentPxInDc_float, char *slice, int s, int *t, ViewportArb &vp, bool useCustomLUT) {
-    Coordinate currentPxInDc = {roundFloat(currentPxInDc_float->x), roundFloat(currentPxInDc_float->y), roundFloat(currentPxInDc_float->z)};
+void Viewer::dcSliceExtract(char *datacube, Coordinate cubePosInAbsPx, char *slice, ViewportOrtho & vp, bool useCustomLUT) {
+    const auto & session = Session::singleton();
+    const auto & areaMin = session.movementAreaMin;
+    const auto & areaMax = session.movementAreaMax;
+    const auto inside = [](const int cubeMin, const int min, const int max){
+        return RawSlice::insideSpan(cubeMin, min, max, state->magnification, state->cubeEdgeLength);
+    };
+    // texture rows and columns are y and x for xy, z and x for xz and y and z for zy
+    const auto plane = vp.viewportType == VIEWPORT_XY ? RawSlice::Plane::XY : vp.viewportType == VIEWPORT_XZ ? RawSlice::Plane::XZ : RawSlice::Plane::ZY;
+    const auto rows = plane == RawSlice::Plane::XZ ? inside(cubePosInAbsPx.z, areaMin.z, areaMax.z) : inside(cubePosInAbsPx.y, areaMin.y, areaMax.y);
+    const auto columns = plane == RawSlice::Plane::ZY ? inside(cubePosInAbsPx.z, areaMin.z, areaMax.z) : inside(cubePosInAbsPx.x, areaMin.x, areaMax.x);
+    RawSlice::extract(reinterpret_cast<const std::uint8_t *>(datacube), reinterpret_cast<std::uint8_t *>(slice), state->cubeEdgeLength, plane, sliceTables(useCustomLUT), rows, columns);
+}
 
-    if((currentPxInDc.x < 0) || (currentPxInDc.y < 0) || (currentPxInDc.z < 0) ||
-       (currentPxInDc.x >= state->cubeEdgeLength) || (currentPxInDc.y >= state->cubeEdgeLength) || (currentPxInDc.z >= state->cubeEdgeLength)) {
-        const int sliceIndex = 3 * ( s + *t  *  state->cubeEdgeLength * state->M);
-        slice[sliceIndex] = slice[sliceIndex + 1] = slice[sliceIndex + 2] = 0;
-        (*t)++;
-        if(*t < vp.texture.usedSizeInCubePixels) {
-            // Actually, although currentPxInDc_float is passed by reference and updated here,
-            // it is totally ignored (i.e. not read, then overwritten) by the calling function.
-            // But to keep the functionality here compatible after this bugfix, we also replicate
-            // this update here - from the originial below
-            *currentPxInDc_float -= vp.v2;
-        }
-        return;
+namespace {
+/**
+ * @brief Looks up colour, largest object and selection of subobjects in the segmentation.
+ */
+class SegmentationResolver : public OverlaySlice::Resolver {
+    Segmentation & seg = Segmentation::singleton();
+public:
+    OverlaySlice::ColorCache::Entry resolve(const std::uint64_t subobjectId) const override {
+        const auto color = seg.colorObjectFromSubobjectId(subobjectId);
+        const std::uint32_t rgba = std::get<0>(color) | std::get<1>(color) << 8 | std::get<2>(color) << 16 | static_cast<std::uint32_t>(std::get<3>(color)) << 24;
+        return {subobjectId, seg.tryLargestObjectContainingSubobject(subobjectId), rgba, 0, seg.isSubObjectIdSelected(subobjectId)};
     }
+};
 
-    while((0 <= currentPxInDc.x && currentPxInDc.x < state->cubeEdgeLength)
-          && (0 <= currentPxInDc.y && currentPxInDc.y < state->cubeEdgeLength)
-          && (0 <= currentPxInDc.z && currentPxInDc.z < state->cubeEdgeLength)) {
+/**
+ * @brief Colours overlay ids through the calling thread’s colour cache, which is dropped when the segmentation changes.
+ */
+class OverlayColors : public OverlaySlice::Colors {
+    static OverlaySlice::ColorCache & threadCache() {
+        thread_local OverlaySlice::ColorCache cache;
+        cache.validate(Segmentation::singleton().changeCounter << 8 | Segmentation::singleton().alpha);
+        return cache;
+    }
+    static const SegmentationResolver & resolver() {
+        static const SegmentationResolver resolver;
+        return resolver;
+    }
+public:
+    OverlayColors() : OverlaySlice::Colors(threadCache(), resolver(), Segmentation::singleton().hoverVersion, Segmentation::singleton().mouseFocusedObjectId) {}
+};
 
-        const int sliceIndex = 3 * ( s + *t  *  state->cubeEdgeLength * state->M);
-        const int dcIndex = currentPxInDc.x + currentPxInDc.y * state->cubeEdgeLength + currentPxInDc.z * state->cubeSliceArea;
-        if(datacube == NULL) {
-            slice[sliceIndex] = slice[sliceIndex + 1] = slice[sliceIndex + 2] = 0;
-        } else {
-            if(useCustomLUT) {
-                //extract data as unsigned number from the datacube
-                const unsigned char adjustIndex = reinterpret_cast<unsigned char*>(datacube)[dcIndex];
-                slice[sliceIndex + 0] = std::get<0>(state->viewerState->datasetAdjustmentTable[adjustIndex]);
-                slice[sliceIndex + 1] = std::get<1>(state->viewerState->datasetAdjustmentTable[adjustIndex]);
-                slice[sliceIndex + 2] = std::get<2>(state->viewerState->datasetAdjustmentTable[adjustIndex]);
-            }
-            else {
-                slice[sliceIndex] = slice[sliceIndex + 1] = slice[sliceIndex + 2] = datacube[dcIndex];
-            }
+/**
+ * @brief Pins cube slots against reuse by the loader, so they can be read after protectCube2Pointer was released.
+ */
+class CubePins {
+    std::vector<const char *> cubes;
+public:
+    CubePins() = default;
+    CubePins(const CubePins &) = delete;
+    CubePins & operator=(const CubePins &) = delete;
+    ~CubePins() {
+        release();
+    }
+    /**
+     * @brief protectCube2Pointer has to be held
+     */
+    char * pin(char * cube) {
+        if (cube != nullptr) {
+            ++state->pinnedCubes[cube];
+            cubes.emplace_back(cube);
+        }
+        return cube;
+    }
+    void release() {
+        if (cubes.empty()) {
+            return;
         }
-        (*t)++;
-        if(*t >= vp.texture.usedSizeInCubePixels) {
-            break;
+        QMutexLocker locker(&state->protectCube2Pointer);
+        for (const auto * cube : cubes) {
+            const auto it = state->pinnedCubes.find(cube);
+            if (--it->second == 0) {
+                state->pinnedCubes.erase(it);
+            }
         }
-        *currentPxInDc_float -= vp.v2;
-        currentPxInDc = {roundFloat(currentPxInDc_float->x), roundFloat(currentPxInDc_float->y), roundFloat(currentPxInDc_float->z)};
+        cubes.clear();
     }
+};
 }
 
 /**
@@ -300,130 +319,41 @@ void Viewer::dcSliceExtract(char *datacube, floatCoordinate *currentPxInDc_float
  * @param cubePosInAbsPx smallest coordinates inside the datacube in dataset pixels
  * @param slice pointer to a slice in which to draw the overlay
  *
- * In the first pass all pixels are filled with the color corresponding the subObject-ID.
- * In the second pass the datacube is traversed again to find edge voxels, i.e. all voxels
- * where at least one of their neighbors (left, right, top, bot) have a different ID than their own.
- * The opacity of these voxels is slightly increased to highlight the edges.
+ * The ids of the slice are first gathered into a dense plane in which edge voxels,
+ * i.e. all voxels where at least one of their neighbors (left, right, top, bot) have a different ID than their own,
+ * are flagged with vector compares. The opacity of these voxels is slightly increased to highlight the edges if they are selected.
  *
- * Before extraction we determine if the cube is partly outside of the movement area in which case
- * each pixel is tested for its position and is omitted if outside of the area.
+ * Colors and selection state per subobject are kept in a per thread cache across cubes and frames
+ * until the segmentation signals a change, cubes are sliced concurrently.
  *
+ * Voxels outside of the movement area are omitted.
  */
 void Viewer::ocSliceExtract(char *datacube, Coordinate cubePosInAbsPx, char *slice, ViewportOrtho & vp) {
     const auto & session = Session::singleton();
-    const Coordinate areaMinCoord = {session.movementAreaMin.x,
-                                     session.movementAreaMin.y,
-                                     session.movementAreaMin.z};
-    const Coordinate areaMaxCoord = {session.movementAreaMax.x,
-                                     session.movementAreaMax.y,
-                                     session.movementAreaMax.z};
-
-    const auto partlyInMovementArea =
-       areaMinCoord.x > cubePosInAbsPx.x || areaMaxCoord.x < cubePosInAbsPx.x + state->cubeEdgeLength * state->magnification ||
-       areaMinCoord.y > cubePosInAbsPx.y || areaMaxCoord.y < cubePosInAbsPx.y + state->cubeEdgeLength * state->magnification ||
-       areaMinCoord.z > cubePosInAbsPx.z || areaMaxCoord.z < cubePosInAbsPx.z + state->cubeEdgeLength * state->magnification;
-
-    const std::size_t voxelIncrement = vp.viewportType == VIEWPORT_ZY ? state->cubeEdgeLength * OBJID_BYTES : OBJID_BYTES;
-    const std::size_t sliceIncrement = vp.viewportType == VIEWPORT_XY ? state->cubeEdgeLength * OBJID_BYTES : state->cubeSliceArea * OBJID_BYTES;
-    const std::size_t sliceSubLineIncrement = vp.viewportType == VIEWPORT_ZY ? 0 : sliceIncrement - state->cubeEdgeLength * OBJID_BYTES;
-    const std::size_t texNextLine = vp.viewportType == VIEWPORT_ZY ? state->cubeEdgeLength * 4 : 4;// RGBA per pixel
-    const std::size_t textRevertToFirstLine = vp.viewportType == VIEWPORT_ZY ? (state->cubeSliceArea - 1) * 4 : 0;
-
-    auto & seg = Segmentation::singleton();
-    //cache
-    uint64_t subobjectIdCache = Segmentation::singleton().getBackgroundId();
-    bool selectedCache = seg.isSubObjectIdSelected(subobjectIdCache);
-    std::tuple<uint8_t, uint8_t, uint8_t, uint8_t> colorCache = seg.colorObjectFromSubobjectId(subobjectIdCache);
-    //first and last row boundaries
-    const std::size_t min = state->cubeEdgeLength;
-    const std::size_t max = state->cubeEdgeLength * (state->cubeEdgeLength - 1);
-    std::size_t counter = 0;//slice position
-    int offsetX = 0, offsetY = 0; // current texel's horizontal and vertical dataset pixel offset inside cube
-    int coordsPerLine = state->cubeEdgeLength*state->magnification;
-    for (auto y = state->cubeEdgeLength; y != 0; --y) {
-        for (auto x = state->cubeEdgeLength; x != 0; --x) {// x and y’s values are not used
-            bool hide = false;
-            if(partlyInMovementArea) {
-                if((vp.viewportType == VIEWPORT_XY && (cubePosInAbsPx.y + offsetY < areaMinCoord.y || cubePosInAbsPx.y + offsetY > areaMaxCoord.y)) ||
-                    ((vp.viewportType == VIEWPORT_XZ || vp.viewportType == VIEWPORT_ZY) && (cubePosInAbsPx.z + offsetY < areaMinCoord.z || cubePosInAbsPx.z + offsetY > areaMaxCoord.z))) {
-                    // vertically out of movement area
-                    reinterpret_cast<uint8_t*>(slice)[3] = 0;
-                    hide = true;
-                }
-                else if(((vp.viewportType == VIEWPORT_XY || vp.viewportType == VIEWPORT_XZ) && (cubePosInAbsPx.x + offsetX < areaMinCoord.x || cubePosInAbsPx.x + offsetX > areaMaxCoord.x)) ||
-                        (vp.viewportType == VIEWPORT_ZY && (cubePosInAbsPx.y + offsetX < areaMinCoord.y || cubePosInAbsPx.y + offsetX > areaMaxCoord.y))) {
-                    // horizontally out of movement area
-                    reinterpret_cast<uint8_t*>(slice)[3] = 0;
-                    hide = true;
-                }
-            }
-
-            if(hide == false) {
-                uint64_t subobjectId = *reinterpret_cast<uint64_t*>(datacube);
-
-                auto color = (subobjectIdCache == subobjectId) ? colorCache : seg.colorObjectFromSubobjectId(subobjectId);
-                reinterpret_cast<uint8_t*>(slice)[0] = std::get<0>(color);
-                reinterpret_cast<uint8_t*>(slice)[1] = std::get<1>(color);
-                reinterpret_cast<uint8_t*>(slice)[2] = std::get<2>(color);
-                reinterpret_cast<uint8_t*>(slice)[3] = std::get<3>(color);
-
-                const bool selected = (subobjectIdCache == subobjectId) ? selectedCache : seg.isSubObjectIdSelected(subobjectId);
-                const bool isPastFirstRow = counter >= min;
-                const bool isBeforeLastRow = counter < max;
-                const bool isNotFirstColumn = counter % state->cubeEdgeLength != 0;
-                const bool isNotLastColumn = (counter + 1) % state->cubeEdgeLength != 0;
-
-                // highlight edges where needed
-                if(seg.hoverVersion) {
-                    uint64_t objectId = seg.tryLargestObjectContainingSubobject(subobjectId);
-                    if (selected && seg.mouseFocusedObjectId == objectId) {
-                        if(isPastFirstRow && isBeforeLastRow && isNotFirstColumn && isNotLastColumn) {
-                            const uint64_t left = seg.tryLargestObjectContainingSubobject(*reinterpret_cast<uint64_t*>(datacube - voxelIncrement));
-                            const uint64_t right = seg.tryLargestObjectContainingSubobject(*reinterpret_cast<uint64_t*>(datacube + voxelIncrement));
-                            const uint64_t top = seg.tryLargestObjectContainingSubobject(*reinterpret_cast<uint64_t*>(datacube - sliceIncrement));
-                            const uint64_t bottom = seg.tryLargestObjectContainingSubobject(*reinterpret_cast<uint64_t*>(datacube + sliceIncrement));
-                            //enhance alpha of this voxel if any of the surrounding voxels belong to another object
-                            if (objectId != left || objectId != right || objectId != top || objectId != bottom) {
-                                reinterpret_cast<uint8_t*>(slice)[3] = std::min(255, reinterpret_cast<uint8_t*>(slice)[3]*4);
-                            }
-                        }
-                    }
-                }
-                else if (selected && isPastFirstRow && isBeforeLastRow && isNotFirstColumn && isNotLastColumn) {
-                    const uint64_t left = *reinterpret_cast<uint64_t*>(datacube - voxelIncrement);
-                    const uint64_t right = *reinterpret_cast<uint64_t*>(datacube + voxelIncrement);
-                    const uint64_t top = *reinterpret_cast<uint64_t*>(datacube - sliceIncrement);
-                    const uint64_t bottom = *reinterpret_cast<uint64_t*>(datacube + sliceIncrement);;
-                    //enhance alpha of this voxel if any of the surrounding voxels belong to another subobject
-                    if (subobjectId != left || subobjectId != right || subobjectId != top || subobjectId != bottom) {
-                        reinterpret_cast<uint8_t*>(slice)[3] = std::min(255, reinterpret_cast<uint8_t*>(slice)[3]*4);
-                    }
-                }
+    const auto & areaMin = session.movementAreaMin;
+    const auto & areaMax = session.movementAreaMax;
+    const auto inside = [](const int cubeMin, const int min, const int max){
+        return RawSlice::insideSpan(cubeMin, min, max, state->magnification, state->cubeEdgeLength);
+    };
+    // plane rows and columns are y and x for xy, z and x for xz and z and y for zy (the zy texture is transposed)
+    const auto plane = vp.viewportType == VIEWPORT_XY ? RawSlice::Plane::XY : vp.viewportType == VIEWPORT_XZ ? RawSlice::Plane::XZ : RawSlice::Plane::ZY;
+    const auto rows = plane == RawSlice::Plane::XY ? inside(cubePosInAbsPx.y, areaMin.y, areaMax.y) : inside(cubePosInAbsPx.z, areaMin.z, areaMax.z);
+    const auto columns = plane == RawSlice::Plane::ZY ? inside(cubePosInAbsPx.y, areaMin.y, areaMax.y) : inside(cubePosInAbsPx.x, areaMin.x, areaMax.x);
 
-                //fill cache
-                subobjectIdCache = subobjectId;
-                colorCache = color;
-                selectedCache = selected;
-            }
-            ++counter;
-            datacube += voxelIncrement;
-            slice += texNextLine;
-            offsetX = (offsetX + state->magnification) % coordsPerLine;
-            offsetY += (offsetX == 0)? state->magnification : 0; // at end of line increment to next line
-        }
-        datacube += sliceSubLineIncrement;
-        slice -= textRevertToFirstLine;
-    }
+    OverlayColors colors;
+    OverlaySlice::colorize(reinterpret_cast<const std::uint64_t *>(datacube), reinterpret_cast<std::uint8_t *>(slice), state->cubeEdgeLength, plane, colors, rows, columns);
 }
 
-static int texIndex(uint x, uint y, uint colorMultiplicationFactor, viewportTexture *texture) {
-    uint index = 0;
-
-    index = x * state->cubeSliceArea + y
-            * (texture->size * state->cubeEdgeLength)
-            * colorMultiplicationFactor;
+/**
+ * @brief number of cube slots along each axis of a toroidal ortho texture, 0 if it cannot be used as a ring
+ */
+static int ringSlots(const viewportTexture & texture) {
+    const auto slots = texture.size / state->cubeEdgeLength;
+    return texture.size % state->cubeEdgeLength == 0 && slots >= state->M ? slots : 0;
+}
 
-    return index;
+static int ringSlot(const int cube, const int slots) {
+    return (cube % slots + slots) % slots;// cube coordinates left of the origin are negative
 }
 
 bool Viewer::vpGenerateTexture(ViewportOrtho & vp) {
@@ -433,6 +363,10 @@ bool Viewer::vpGenerateTexture(ViewportOrtho & vp) {
         vpGenerateTexture(static_cast<ViewportArb&>(vp));
         return true;
     }
+    if (vp.texture.mipLevels != RawSlice::mipLevels(state->cubeEdgeLength)) {// the cube edge changed, the slots need other levels
+        vp.resetTexture();
+        vp.dcResliceNecessary = vp.ocResliceNecessary = true;
+    }
     const bool dc_reslice = vp.dcResliceNecessary;
     const bool oc_reslice = vp.ocResliceNecessary;
     vp.dcResliceNecessary = vp.ocResliceNecessary = false;
@@ -455,15 +389,81 @@ bool Viewer::vpGenerateTexture(ViewportOrtho & vp) {
     }
 
     const CoordOfCube upperLeftDc = Coordinate(vp.texture.leftUpperPxInAbsPx).cube(state->cubeEdgeLength, state->magnification);
+    const bool ocSlicing = Segmentation::enabled && oc_reslice && state->viewerState->showOnlyRawData == false;
+    if (oc_reslice && !ocSlicing) {// the overlay ring isn’t kept up to date while it’s not shown
+        vp.ocRingValid = false;
+    }
+    // cubes loaded since the last reslice, only their slots are resliced in a valid ring
+    std::unordered_set<Coordinate> dcArrived, ocArrived;
+    {
+        QMutexLocker arrivedLocker(&vp.arrivedCubesMutex);
+        if (dc_reslice) {
+            std::swap(dcArrived, vp.dcArrivedCubes);
+        }
+        if (oc_reslice) {
+            std::swap(ocArrived, vp.ocArrivedCubes);
+        }
+    }
+    std::unordered_set<CoordOfCube> dcDirtyCubes;
+    for (const auto & globalCoord : dcArrived) {
+        dcDirtyCubes.emplace(globalCoord.cube(state->cubeEdgeLength, state->magnification));
+    }
+    // overlay cubes loaded or with edits intersecting the slice
+    std::unordered_set<CoordOfCube> ocDirtyCubes;
+    for (const auto & globalCoord : ocArrived) {
+        ocDirtyCubes.emplace(globalCoord.cube(state->cubeEdgeLength, state->magnification));
+    }
+    if (oc_reslice) {
+        const auto depth = state->viewerState->currentPosition / state->magnification;// compare in voxels of the current mag
+        for (const auto & region : vp.ocDirtyRegions) {
+            const auto first = region.first / state->magnification;
+            const auto last = region.second / state->magnification;
+            const bool intersects = vp.viewportType == VIEWPORT_XY ? first.z <= depth.z && depth.z <= last.z
+                                  : vp.viewportType == VIEWPORT_XZ ? first.y <= depth.y && depth.y <= last.y
+                                  : first.x <= depth.x && depth.x <= last.x;
+            if (intersects) {
+                ocDirtyCubes.emplace(region.first.cube(state->cubeEdgeLength, state->magnification));
+            }
+        }
+        vp.ocDirtyRegions.clear();
+    }
+    if (!dc_reslice && !ocSlicing) {
+        return true;
+    }
 
-    std::vector<char> texData(4 * std::pow(state->viewerState->texEdgeLength, 2));
+    const auto & position = state->viewerState->currentPosition;
+    const ViewportOrtho::SliceRing ring{upperLeftDc, vp.viewportType == VIEWPORT_XY ? position.z : vp.viewportType == VIEWPORT_XZ ? position.y : position.x, state->magnification, state->cubeEdgeLength, state->M};
+    const auto slots = ringSlots(vp.texture);
+    // cubes of the previous ring can be kept if nothing but the in-plane position of the texture changed
+    const auto reusable = [&ring, slots](std::atomic_bool & valid, const ViewportOrtho::SliceRing & previous){
+        return valid.exchange(true) && slots != 0 && previous.depth == ring.depth && previous.magnification == ring.magnification && previous.cubeEdgeLength == ring.cubeEdgeLength && previous.supercubeEdge == ring.supercubeEdge;
+    };
+    const bool dcReusable = dc_reslice && reusable(vp.dcRingValid, vp.dcRing);
+    const bool ocReusable = ocSlicing && reusable(vp.ocRingValid, vp.ocRing);
+    const auto inRing = [&vp](const ViewportOrtho::SliceRing & previous, const CoordOfCube & cube){
+        const auto offset = cube - previous.upperLeftDc;
+        const auto u = vp.viewportType == VIEWPORT_ZY ? offset.z : offset.x;
+        const auto v = vp.viewportType == VIEWPORT_XZ ? offset.z : offset.y;
+        return u >= 0 && u < state->M && v >= 0 && v < state->M;
+    };
+
+    struct Job {
+        int x_px, y_px;
+        Coordinate cubePosInAbsPx;
+        char * datacube;
+        char * overlayCube;
+        bool dc, oc;
+        std::size_t dcRegion, ocRegion;// index of the slice in the staging buffer of its layer
+    };
+    std::vector<Job> jobs;
+    jobs.reserve(state->M * state->M);
+    // snapshot the cube pointers under one short lock, the pins keep the loader from reusing their slots until all slices are extracted
+    CubePins pins;
+    QMutexLocker cubeLocker(&state->protectCube2Pointer);
     // We iterate over the texture with x and y being in a temporary coordinate
     // system local to this texture.
     for(int x_dc = 0; x_dc < state->M; x_dc++) {
         for(int y_dc = 0; y_dc < state->M; y_dc++) {
-            const int x_px = x_dc * state->cubeEdgeLength;
-            const int y_px = y_dc * state->cubeEdgeLength;
-
             CoordOfCube currentDc;
 
             switch(vp.viewportType) {
@@ -485,68 +485,108 @@ bool Viewer::vpGenerateTexture(ViewportOrtho & vp) {
             default:
                 qDebug("No such slice type (%d) in vpGenerateTexture.", vp.viewportType);
             }
-            state->protectCube2Pointer.lock();
-            char * const datacube = Coordinate2BytePtr_hash_get_or_fail(state->Dc2Pointer[int_log(state->magnification)], currentDc);
-            char * const overlayCube = Coordinate2BytePtr_hash_get_or_fail(state->Oc2Pointer[int_log(state->magnification)], currentDc);
-            state->protectCube2Pointer.unlock();
-
-            // Take care of the data textures.
-
-            Coordinate cubePosInAbsPx = {currentDc.x * state->magnification * state->cubeEdgeLength,
-                                         currentDc.y * state->magnification * state->cubeEdgeLength,
-                                         currentDc.z * state->magnification * state->cubeEdgeLength};
-            if (dc_reslice) {
-                glBindTexture(GL_TEXTURE_2D, vp.texture.texHandle);
-
-                // This is used to index into the texture. overlayData[index] is the first
-                // byte of the datacube slice at position (x_dc, y_dc) in the texture.
-                const int index = texIndex(x_dc, y_dc, 3, &(vp.texture));
-
-                if (datacube != nullptr) {
-                    dcSliceExtract(datacube + slicePositionWithinCube,
-                                   cubePosInAbsPx,
-                                   texData.data() + index,
-                                   vp,
-                                   state->viewerState->datasetAdjustmentOn);
-                } else {
-                    std::fill(std::begin(texData), std::end(texData), 0);
-                }
-                glTexSubImage2D(GL_TEXTURE_2D,
-                                0,
-                                x_px,
-                                y_px,
-                                state->cubeEdgeLength,
-                                state->cubeEdgeLength,
-                                GL_RGB,
-                                GL_UNSIGNED_BYTE,
-                                texData.data() + index);
+            const bool dc = dc_reslice && !(dcReusable && inRing(vp.dcRing, currentDc) && dcDirtyCubes.count(currentDc) == 0);
+            const bool oc = ocSlicing && !(ocReusable && inRing(vp.ocRing, currentDc) && ocDirtyCubes.count(currentDc) == 0);
+            if (!dc && !oc) {
+                continue;
             }
-            //Take care of the overlay textures.
-            if (Segmentation::enabled && oc_reslice && state->viewerState->showOnlyRawData == false) {
-                glBindTexture(GL_TEXTURE_2D, vp.texture.overlayHandle);
-                // This is used to index into the texture. texData[index] is the first
-                // byte of the datacube slice at position (x_dc, y_dc) in the texture.
-                const int index = texIndex(x_dc, y_dc, 4, &(vp.texture));
-
-                if (overlayCube != nullptr) {
-                    ocSliceExtract(overlayCube + slicePositionWithinCube * OBJID_BYTES,
-                                   cubePosInAbsPx,
-                                   texData.data() + index,
-                                   vp);
-                } else {
-                    std::fill(std::begin(texData), std::end(texData), 0);
+            const Coordinate cubePosInAbsPx = {currentDc.x * state->magnification * state->cubeEdgeLength,
+                                               currentDc.y * state->magnification * state->cubeEdgeLength,
+                                               currentDc.z * state->magnification * state->cubeEdgeLength};
+            const int x_slot = slots != 0 ? ringSlot(vp.viewportType == VIEWPORT_ZY ? currentDc.z : currentDc.x, slots) : x_dc;
+            const int y_slot = slots != 0 ? ringSlot(vp.viewportType == VIEWPORT_XZ ? currentDc.z : currentDc.y, slots) : y_dc;
+            jobs.push_back({x_slot * state->cubeEdgeLength, y_slot * state->cubeEdgeLength, cubePosInAbsPx,
+                            dc ? pins.pin(Coordinate2BytePtr_hash_get_or_fail(state->Dc2Pointer[int_log(state->magnification)], currentDc)) : nullptr,
+                            oc ? pins.pin(Coordinate2BytePtr_hash_get_or_fail(state->Oc2Pointer[int_log(state->magnification)], currentDc)) : nullptr,
+                            dc, oc, 0, 0});
+        }
+    }
+    cubeLocker.unlock();
+    if (dc_reslice) {
+        vp.dcRing = ring;
+    }
+    if (ocSlicing) {
+        vp.ocRing = ring;
+    }
+    if (jobs.empty()) {// nothing newly exposed
+        return true;
+    }
+
+    // every cube is sliced into its own region of the staging buffers, data slices are followed by their mipmap levels
+    const auto mipLevels = vp.texture.mipLevels;
+    std::vector<std::size_t> dcLevelOffsets{0}, ocLevelOffsets{0};
+    for (int level = 0; level <= mipLevels; ++level) {
+        const std::size_t levelEdge = state->cubeEdgeLength >> level;
+        dcLevelOffsets.emplace_back(dcLevelOffsets.back() + 3 * levelEdge * levelEdge);
+    }
+    ocLevelOffsets.emplace_back(4 * state->cubeSliceArea);
+    const std::size_t dcSliceBytes = dcLevelOffsets.back();
+    const std::size_t ocSliceBytes = ocLevelOffsets.back();
+    // only layers with jobs are staged, each only for the slices it receives
+    std::size_t dcSlices = 0, ocSlices = 0;
+    for (auto & job : jobs) {
+        job.dcRegion = job.dc ? dcSlices++ : 0;
+        job.ocRegion = job.oc ? ocSlices++ : 0;
+    }
+    // slices are written straight into (mapped pixel buffer) memory of the texture stream
+    TextureStream::Staging dcStaging{}, ocStaging{};
+    if (dcSlices != 0) {
+        dcStaging = vp.textureStream.stage(dcSlices * dcSliceBytes);
+        sliceTables(state->viewerState->datasetAdjustmentOn);// build lazily initialized tables before they are shared
+    }
+    if (ocSlices != 0) {
+        ocStaging = vp.textureStream.stage(ocSlices * ocSliceBytes);
+    }
+    QtConcurrent::blockingMap(jobs, [&](const Job & job){
+        if (job.dc) {
+            auto * slice = dcStaging.data + job.dcRegion * dcSliceBytes;
+            if (job.datacube != nullptr) {
+                dcSliceExtract(job.datacube + slicePositionWithinCube, job.cubePosInAbsPx, slice, vp, state->viewerState->datasetAdjustmentOn);
+                for (int level = 0; level < mipLevels; ++level) {// only the levels of this cube’s slot
+                    RawSlice::halve(reinterpret_cast<std::uint8_t *>(slice + dcLevelOffsets[level]), reinterpret_cast<std::uint8_t *>(slice + dcLevelOffsets[level + 1]), state->cubeEdgeLength >> level);
                 }
-                glTexSubImage2D(GL_TEXTURE_2D,
-                                0,
-                                x_px,
-                                y_px,
-                                state->cubeEdgeLength,
-                                state->cubeEdgeLength,
-                                GL_RGBA,
-                                GL_UNSIGNED_BYTE,
-                                texData.data() + index);
+            } else {
+                std::fill(slice, slice + dcSliceBytes, 0);
             }
         }
+        if (job.oc) {
+            auto * slice = ocStaging.data + job.ocRegion * ocSliceBytes;
+            if (job.overlayCube != nullptr) {
+                ocSliceExtract(job.overlayCube + slicePositionWithinCube * OBJID_BYTES, job.cubePosInAbsPx, slice, vp);
+            } else {
+                std::fill(slice, slice + ocSliceBytes, 0);
+            }
+        }
+    });
+    pins.release();
+
+    const auto upload = [&vp, &jobs](const GLuint texture, const GLenum format, TextureStream::Staging & staging, const std::vector<std::size_t> & levelOffsets, bool Job::*layer, std::size_t Job::*region){
+        glBindTexture(GL_TEXTURE_2D, texture);
+        const auto sliceBytes = levelOffsets.back();
+        vp.textureStream.upload(staging, [&](const char * pixels){
+            for (const auto & job : jobs) {
+                if (job.*layer) {
+                    for (std::size_t level = 0; level + 1 < levelOffsets.size(); ++level) {
+                        glTexSubImage2D(GL_TEXTURE_2D,
+                                        level,
+                                        job.x_px >> level,
+                                        job.y_px >> level,
+                                        state->cubeEdgeLength >> level,
+                                        state->cubeEdgeLength >> level,
+                                        format,
+                                        GL_UNSIGNED_BYTE,
+                                        pixels + job.*region * sliceBytes + levelOffsets[level]);
+                    }
+                }
+            }
+        });
+    };
+    if (dcSlices != 0) {
+        upload(vp.texture.texHandle, GL_RGB, dcStaging, dcLevelOffsets, &Job::dc, &Job::dcRegion);
+    }
+    //Take care of the overlay textures.
+    if (ocSlices != 0) {
+        upload(vp.texture.overlayHandle, GL_RGBA, ocStaging, ocLevelOffsets, &Job::oc, &Job::ocRegion);
     }
     glBindTexture(GL_TEXTURE_2D, 0);
     return true;
@@ -648,6 +688,8 @@ void Viewer::arbCubes(ViewportArb & vp) {
                     auto cubeIt = layer.textures.find(gpuCoord);
                     if (cubeIt != std::end(layer.textures)) {
                         cubeIt->second->vertices = /*std::move*/(points);
+                    } else if (layer.restore(gpuCoord, state->magnification)) {
+                        layer.textures[gpuCoord]->vertices = points;
                     } else {
                         const auto cubeCoord = globalCoord.cube(state->cubeEdgeLength, state->magnification);
                         const auto offset = globalCoord - cubeCoord.cube2Global(state->cubeEdgeLength, state->magnification);
@@ -669,66 +711,114 @@ void Viewer::setDefaultVPSizeAndPos(const bool on) {
     emit changedDefaultVPSizeAndPos();
 }
 
+/**
+ * @brief dense snapshot of the cube pointers of the supercube starting at firstCube, whose cubes stay pinned while it’s used
+ */
+template<typename Voxel>
+static ArbSlice::Grid<Voxel> supercubeGrid(const coord2bytep_map_t & cube2Pointer, const CoordOfCube & firstCube, CubePins & pins) {
+    QMutexLocker locker(&state->protectCube2Pointer);
+    ArbSlice::Grid<Voxel> grid;
+    grid.supercubeEdge = state->M;
+    grid.cubeEdge = state->cubeEdgeLength;
+    grid.cubes.reserve(state->M * state->M * state->M);
+    for (int z = 0; z < state->M; ++z)
+    for (int y = 0; y < state->M; ++y)
+    for (int x = 0; x < state->M; ++x) {
+        const auto * cube = pins.pin(Coordinate2BytePtr_hash_get_or_fail(cube2Pointer, {firstCube.x + x, firstCube.y + y, firstCube.z + z}));
+        grid.cubes.emplace_back(reinterpret_cast<const Voxel *>(cube));
+    }
+    return grid;
+}
+
 void Viewer::vpGenerateTexture(ViewportArb &vp) {
-    if (!vp.dcResliceNecessary) {
+    const bool dc_reslice = vp.dcResliceNecessary;
+    const bool ocSlicing = vp.ocResliceNecessary && Segmentation::enabled && state->viewerState->showOnlyRawData == false;
+    vp.dcResliceNecessary = vp.ocResliceNecessary = false;
+    if (!dc_reslice && !ocSlicing) {
         return;
     }
-    vp.dcResliceNecessary = false;
 
-    // Load the texture for a viewport by going through all relevant datacubes and copying slices
-    // from those cubes into the texture.
-    floatCoordinate currentPxInDc_float, rowPx_float, currentPx_float;
-
-    char *datacube = NULL;
-
-    rowPx_float = vp.texture.leftUpperPxInAbsPx / state->magnification;
-    currentPx_float = rowPx_float;
-
-    std::vector<char> texData(3 * std::pow(state->viewerState->texEdgeLength, 2));
-
-    glBindTexture(GL_TEXTURE_2D, vp.texture.texHandle);
-
-    int s = 0, t = 0, t_old = 0;
-    while(s < vp.texture.usedSizeInCubePixels) {
-        t = 0;
-        while(t < vp.texture.usedSizeInCubePixels) {
-            Coordinate currentPx = {roundFloat(currentPx_float.x), roundFloat(currentPx_float.y), roundFloat(currentPx_float.z)};
-            Coordinate currentDc = currentPx / state->cubeEdgeLength;
-
-            if(currentPx.x < 0) { currentDc.x -= 1; }
-            if(currentPx.y < 0) { currentDc.y -= 1; }
-            if(currentPx.z < 0) { currentDc.z -= 1; }
-
-            state->protectCube2Pointer.lock();
-            datacube = Coordinate2BytePtr_hash_get_or_fail(state->Dc2Pointer[int_log(state->magnification)], {currentDc.x, currentDc.y, currentDc.z});
-            state->protectCube2Pointer.unlock();
-
-            currentPxInDc_float = currentPx_float - currentDc * state->cubeEdgeLength;
-            t_old = t;
-
-            dcSliceExtract(datacube,
-                           &currentPxInDc_float,
-                           texData.data(),
-                           s, &t,
-                           vp,
-                           state->viewerState->datasetAdjustmentOn);
-            currentPx_float = currentPx_float - vp.v2 * (t - t_old);
+    // resample the plane from snapshots of the supercube’s cubes, in bands of rows on the thread pool
+    const int M = state->M;
+    const int cubeEdge = state->cubeEdgeLength;
+    const auto firstCube = state->viewerState->currentPosition.cube(cubeEdge, state->magnification) - CoordOfCube{M / 2, M / 2, M / 2};
+    const auto gridOrigin = floatCoordinate(firstCube.cube2Global(cubeEdge, 1));
+    const auto rowBands = [](const int rows){
+        const int bandRows = 16;
+        std::vector<std::pair<int, int>> bands;
+        for (int row = 0; row < rows; row += bandRows) {
+            bands.emplace_back(row, std::min(row + bandRows, rows));
         }
-        s++;
-        rowPx_float += vp.v1;
-        currentPx_float = rowPx_float;
+        return bands;
+    };
+    CubePins pins;// cubes of the grids must not be overwritten before the resampling finished
+
+    const int texels = vp.texture.usedSizeInCubePixels;
+    TextureStream::Staging dcStaging{};
+    if (dc_reslice) {
+        const floatCoordinate start = vp.texture.leftUpperPxInAbsPx / state->magnification;
+        const auto origin = start - gridOrigin;
+        const ArbSlice::Plane plane{{{origin.x, origin.y, origin.z}}, {{vp.v1.x, vp.v1.y, vp.v1.z}}, {{-vp.v2.x, -vp.v2.y, -vp.v2.z}}};
+        const auto filter = vp.texture.textureFilter == GL_LINEAR ? ArbSlice::Filter::Trilinear : ArbSlice::Filter::Nearest;
+        const auto & table = sliceTables(state->viewerState->datasetAdjustmentOn).inside;
+        const auto grid = supercubeGrid<std::uint8_t>(state->Dc2Pointer[int_log(state->magnification)], firstCube, pins);
+        dcStaging = vp.textureStream.stage(3 * static_cast<std::size_t>(texels) * texels);
+        auto bands = rowBands(texels);
+        QtConcurrent::blockingMap(bands, [&](const std::pair<int, int> & band){
+            ArbSlice::resample(grid, plane, table, reinterpret_cast<std::uint8_t *>(dcStaging.data), texels, band.first, band.second, filter);
+        });
     }
 
-    glTexSubImage2D(GL_TEXTURE_2D,
-                    0,
-                    0,
-                    0,
-                    state->M*state->cubeEdgeLength,
-                    state->M*state->cubeEdgeLength,
-                    GL_RGB,
-                    GL_UNSIGNED_BYTE,
-                    texData.data());
+    const int overlayTexels = (M - 1) * cubeEdge / std::sqrt(2);
+    TextureStream::Staging ocStaging{};
+    if (ocSlicing) {
+        // voxels are truncated from the exact plane position like readVoxel, which equals rounding half a voxel earlier
+        const auto origin = vp.leftUpperPxInAbsPx_float / state->magnification - gridOrigin - floatCoordinate{0.5, 0.5, 0.5};
+        const ArbSlice::Plane plane{{{origin.x, origin.y, origin.z}}, {{vp.v1.x, vp.v1.y, vp.v1.z}}, {{-vp.v2.x, -vp.v2.y, -vp.v2.z}}};
+        const auto & session = Session::singleton();
+        const auto gridOriginPx = firstCube.cube2Global(cubeEdge, state->magnification);
+        const auto insideSpan = [M, cubeEdge](const int gridMin, const int areaMin, const int areaMax){
+            return RawSlice::insideSpan(gridMin, areaMin, areaMax, state->magnification, M * cubeEdge);
+        };
+        const auto x = insideSpan(gridOriginPx.x, session.movementAreaMin.x, session.movementAreaMax.x);
+        const auto y = insideSpan(gridOriginPx.y, session.movementAreaMin.y, session.movementAreaMax.y);
+        const auto z = insideSpan(gridOriginPx.z, session.movementAreaMin.z, session.movementAreaMax.z);
+        const ArbSlice::Box inside{{{x.begin, y.begin, z.begin}}, {{x.end - 1, y.end - 1, z.end - 1}}};
+        const auto backgroundId = Segmentation::singleton().getBackgroundId();
+        const auto grid = supercubeGrid<std::uint64_t>(state->Oc2Pointer[int_log(state->magnification)], firstCube, pins);
+        ocStaging = vp.textureStream.stage(4 * static_cast<std::size_t>(overlayTexels) * overlayTexels);
+        auto bands = rowBands(overlayTexels);
+        QtConcurrent::blockingMap(bands, [&](const std::pair<int, int> & band){
+            // a row of halo above and below the band for the edges
+            thread_local std::vector<std::uint64_t> ids;
+            const int rows = band.second - band.first + 2;
+            ids.resize(static_cast<std::size_t>(overlayTexels) * rows);
+            ArbSlice::gather(grid, plane, inside, backgroundId, ids.data(), overlayTexels, band.first - 1, band.second + 1);
+            OverlayColors colors;
+            const auto & edges = colors.edges(ids.data(), overlayTexels, rows);
+            for (int row = 1; row + 1 < rows; ++row) {
+                auto * texel = reinterpret_cast<std::uint8_t *>(ocStaging.data) + 4 * static_cast<std::size_t>(band.first + row - 1) * overlayTexels;
+                for (int column = 0; column < overlayTexels; ++column, texel += 4) {
+                    const auto index = static_cast<std::size_t>(row) * overlayTexels + column;
+                    colors.store(texel, ids[index], edges[index]);
+                }
+            }
+        });
+    }
+    pins.release();
 
+    if (dc_reslice) {
+        glBindTexture(GL_TEXTURE_2D, vp.texture.texHandle);
+        vp.textureStream.upload(dcStaging, [texels](const char * pixels){
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texels, texels, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+        });
+    }
+    if (ocSlicing) {
+        glBindTexture(GL_TEXTURE_2D, vp.texture.overlayHandle);
+        vp.textureStream.upload(ocStaging, [overlayTexels](const char * pixels){
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, overlayTexels, overlayTexels, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        });
+    }
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
@@ -772,7 +862,8 @@ void Viewer::zoom(const float factor) {
     const bool reachedMinZoom = viewportXY->texture.FOV * factor > VPZOOMMIN && reachedHighestMag;
     const bool reachedMaxZoom = viewportXY->texture.FOV * factor  < VPZOOMMAX && reachedLowestMag;
     const bool magUp = viewportXY->texture.FOV == VPZOOMMIN && factor > 1 && !reachedHighestMag;
-    const bool magDown = viewportXY->texture.FOV == 0.5 && factor < 1 && !reachedLowestMag;
+    const float zoomMax = zoomMaxFOV();
+    const bool magDown = viewportXY->texture.FOV <= zoomMax && factor < 1 && !reachedLowestMag;
 
     const auto updateFOV = [this](const float newFOV) {
         window->forEachOrthoVPDo([&newFOV](ViewportOrtho & orthoVP) { orthoVP.texture.FOV = newFOV; });
@@ -791,9 +882,8 @@ void Viewer::zoom(const float factor) {
         updateFOV(0.5);
     } else if (magDown) {
         newMag /= 2;
-        updateFOV(VPZOOMMIN);
+        updateFOV(std::min(2 * zoomMax, static_cast<float>(VPZOOMMIN)));// same scale in the finer mag
     } else {
-        const float zoomMax = static_cast<float>(state->magnification) == state->lowestAvailableMag ? VPZOOMMAX : 0.5;
         updateFOV(std::max(std::min(viewportXY->texture.FOV * factor, static_cast<float>(VPZOOMMIN)), zoomMax));
     }
 
@@ -804,6 +894,17 @@ void Viewer::zoom(const float factor) {
     emit zoomChanged();
 }
 
+float Viewer::zoomMaxFOV() {
+    if (static_cast<uint>(state->magnification) == state->lowestAvailableMag) {
+        return VPZOOMMAX;
+    }
+    // the finer mag covers half the fov, but it only adds detail once a data px spans more than a screen px,
+    // until then the mipmapped texture of the current mag minifies without aliasing and the reload is skipped
+    const bool mipmapped = !(state->gpuSlicer && gpuRendering) && viewportXY->texture.minFilter() == GL_LINEAR_MIPMAP_LINEAR;
+    const float oneToOneFOV = viewportXY->screenPxXPerDataPxForZoomFactor(1.f);// screen px per data px are inversely proportional to the fov
+    return mipmapped ? std::max(static_cast<float>(VPZOOMMAX), std::min(0.5f, oneToOneFOV)) : 0.5f;
+}
+
 void Viewer::zoomReset() {
     state->viewer->window->forEachOrthoVPDo([](ViewportOrtho & orthoVP){
         orthoVP.texture.FOV = 1;
@@ -815,6 +916,12 @@ void Viewer::zoomReset() {
 bool Viewer::updateDatasetMag(const uint mag) {
     if ((0 < mag) && ((mag & (mag - 1)) == 0)) { // mag is power of 2
         if (state->lowestAvailableMag <= mag && mag <= state->highestAvailableMag) {
+            for (auto & layer : layers) {// keep the gpu cubes of the previous mag resident for zooming back
+                layer.ctx.makeCurrent(&layer.surface);
+                while (!layer.textures.empty()) {
+                    layer.retire(std::begin(layer.textures)->first, state->magnification, gpucubeedge);
+                }
+            }
             state->magnification = mag;
             window->forEachOrthoVPDo([mag](ViewportOrtho & orthoVP) {
                 orthoVP.texture.texUnitsPerDataPx = 1. / state->viewerState->texEdgeLength / mag;
@@ -835,28 +942,89 @@ bool Viewer::updateDatasetMag(const uint mag) {
 }
 
 /**
-  * @brief This method is used for the Viewer-Thread declared in main(knossos.cpp)
-  * This is the old viewer() function from KNOSSOS 3.2
-  * It works as follows:
-  * - The viewer get initialized
-  * - The rendering loop starts:
-  *   - lists of pending texture parts are iterated and loaded if they are available
-  *   - TODO: The Eventhandling in QT works asnyc, new concept are currently in progress
-  * - the loadSignal occurs in three different locations:
-  *   - initViewer
-  *   - userMove
-  *
-  */
-//Entry point for viewer thread, general viewer coordination, "main loop"
+ * @brief Viewer::frameInterval is the refresh interval of the primary screen in ms, frames aren’t scheduled faster
+ */
+int Viewer::frameInterval() const {
+    const auto * screen = QGuiApplication::primaryScreen();
+    const auto refreshRate = screen != nullptr && screen->refreshRate() > 0 ? screen->refreshRate() : 60;
+    return std::max(1, qRound(1000 / refreshRate));
+}
+
+/**
+ * @brief Viewer::postDamage requests a frame, may be called from any thread
+ *
+ * All damage posted until the next frame starts is coalesced into that frame,
+ * which is scheduled at most once per refresh interval of the display.
+ */
+void Viewer::postDamage() {
+    const bool first = !damagePosted.exchange(true);
+    if (QThread::currentThread() == thread()) {
+        scheduleFrame();
+    } else if (first) {// only the first damage from the loader after a frame needs to be queued
+        QMetaObject::invokeMethod(this, "scheduleFrame", Qt::QueuedConnection);
+    }
+}
+
+void Viewer::scheduleFrame() {
+    if (state->quitSignal || !damagePosted) {
+        return;
+    }
+    //render interval is raised while dialogs are shown
+    const qint64 interval = QApplication::activeWindow() != nullptr ? std::max<int>(frameInterval(), state->viewerState->renderInterval) : SLOW;
+    const auto delay = std::max<qint64>(0, interval - (frameTimer.isValid() ? frameTimer.elapsed() : interval));
+    if (!timer.isActive() || timer.remainingTime() > delay) {
+        timer.start(delay);
+    }
+}
+
+bool Viewer::eventFilter(QObject * watched, QEvent * event) {
+    switch (event->type()) {
+    case QEvent::MouseMove:
+    case QEvent::Enter:
+    case QEvent::Leave:
+        if (qobject_cast<ViewportBase*>(watched) != nullptr) {// hovering other widgets doesn’t change what’s rendered
+            postDamage();
+        }
+        break;
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::Resize:
+    case QEvent::Show:
+    case QEvent::WindowActivate:
+    case QEvent::WindowDeactivate:
+        postDamage();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+/**
+ * @brief Viewer::run renders one frame, it’s started by the frame timer once damage was posted
+ *
+ * Pending slices are generated and all viewports are updated.
+ * Damage posted while the frame renders (e.g. by ongoing movement) schedules the next one.
+ */
 void Viewer::run() {
     if (state->quitSignal) {//don’t do anything, when the rest is already going to sleep
         qDebug() << "viewer returned";
         return;
     }
 
-    //start the timer before the rendering, else render interval and actual rendering time would accumulate
-    timer.stop();
-    timer.start(QApplication::activeWindow() != nullptr ? state->viewerState->renderInterval : SLOW);
+    damagePosted = false;// damage posted from here on schedules the next frame
+    handlePendingHovers();
+    const auto target = frameInterval();
+    qint64 frameTime = target;
+    if (frameTimer.isValid()) {
+        frameTime = frameTimer.restart();
+    } else {
+        frameTimer.start();
+    }
 
     if (viewerState.keyRepeat) {
         const double interval = 1000.0 / viewerState.movementSpeed;
@@ -866,39 +1034,85 @@ void Viewer::run() {
             keyRepeatTimer.restart();
             userMove(viewerState.repeatDirection * multiplier, USERMOVE_DRILL);
         }
+        postDamage();// keep moving until the key is released
     }
-    // Event and rendering loop.
-    // What happens is that we go through lists of pending texture parts and load
-    // them if they are available.
-    // While we are loading the textures, we check for events. Some events
-    // might cancel the current loading process. When all textures
-    // have been processed, we go into an idle state, in which we wait for events.
     if (state->gpuSlicer && gpuRendering) {
-        const auto & loadPendingCubes = [&](TextureLayer & layer, std::vector<std::pair<CoordOfGPUCube, Coordinate>> & pendingCubes, QElapsedTimer & timer) {
-            while (!pendingCubes.empty() && !timer.hasExpired(3)) {
-                const auto pair = pendingCubes.back();
-                pendingCubes.pop_back();
-                if (layer.textures.find(pair.first) == std::end(layer.textures)) {
-                    const auto globalCoord = pair.first.cube2Global(gpucubeedge, state->magnification);
-                    const auto cubeCoord = globalCoord.cube(state->cubeEdgeLength, state->magnification);
-                    state->protectCube2Pointer.lock();
-                    const auto * ptr = Coordinate2BytePtr_hash_get_or_fail((layer.isOverlayData ? state->Oc2Pointer : state->Dc2Pointer)[int_log(state->magnification)], cubeCoord);
-                    state->protectCube2Pointer.unlock();
-                    if (ptr != nullptr) {
-                        layer.cubeSubArray(ptr, state->cubeEdgeLength, gpucubeedge, pair.first, pair.second);
+        if (frameTime <= 2 * target) {// consecutive frames, so frame time reflects the work per frame
+            gpuCubeBudgetMs = frameTime > target * 5 / 4 ? std::max(1.0, gpuCubeBudgetMs * 0.75) : std::min(target / 2.0, gpuCubeBudgetMs + 0.5);
+        }
+        const auto magnification = state->magnification;
+        const auto cpucubeedge = state->cubeEdgeLength;
+        const auto edge = gpucubeedge;
+        // conversion of the cpu cubes happens in the layer’s pool, the gui thread only uploads the prepared texels
+        const auto & cpuCube = [magnification](const bool overlay, const CoordOfCube & cubeCoord){// protectCube2Pointer has to be locked
+            return Coordinate2BytePtr_hash_get_or_fail((overlay ? state->Oc2Pointer : state->Dc2Pointer)[int_log(magnification)], cubeCoord);
+        };
+        const auto & preparePendingCubes = [&](TextureLayer & layer, std::vector<std::pair<CoordOfGPUCube, Coordinate>> & pendingCubes) {
+            for (const auto & pair : pendingCubes) {
+                if (layer.textures.count(pair.first) != 0 || layer.preparing.count(pair.first) != 0) {
+                    continue;
+                }
+                const auto cubeCoord = pair.first.cube2Global(edge, magnification).cube(cpucubeedge, magnification);
+                state->protectCube2Pointer.lock();
+                const auto loaded = cpuCube(layer.isOverlayData, cubeCoord) != nullptr;
+                state->protectCube2Pointer.unlock();
+                if (!loaded) {// gets pending again when the loader delivers the cube
+                    continue;
+                }
+                layer.preparing.emplace(pair.first);
+                QtConcurrent::run(&layer.preparationPool, [this, &layer, cpuCube, pair, cubeCoord, magnification, cpucubeedge, edge, version = layer.version.load()](){
+                    PreparedGPUCube prepared{pair.first, magnification, version, {}};
+                    {
+                        QMutexLocker pin(&state->protectCube2Pointer);
+                        const auto * ptr = cpuCube(layer.isOverlayData, cubeCoord);
+                        if (ptr != nullptr) {
+                            prepared.texels = layer.prepare(ptr, cpucubeedge, edge, pair.second);
+                        }
                     }
+                    layer.pushPrepared(std::move(prepared));
+                    postDamage();
+                });
+            }
+            pendingCubes.clear();
+        };
+        const auto supercubeedge = state->M * state->cubeEdgeLength / gpucubeedge - (state->cubeEdgeLength / gpucubeedge - 1);
+        const auto & uploadPreparedCubes = [&](TextureLayer & layer, QElapsedTimer & timer) {
+            bool discarded = false;
+            PreparedGPUCube prepared;
+            while (timer.nsecsElapsed() < gpuCubeBudgetMs * 1e6 && layer.takePrepared(prepared)) {
+                layer.preparing.erase(prepared.pos);
+                const bool stale = layer.stale.erase(prepared.pos) != 0;
+                const auto globalCoord = prepared.pos.cube2Global(gpucubeedge, magnification);
+                const bool current = prepared.magnification == magnification && prepared.version == layer.version && !stale;
+                if (!prepared.texels.empty() && current && layer.textures.count(prepared.pos) == 0 && currentlyVisible(globalCoord, viewerState.currentPosition, supercubeedge, gpucubeedge)) {
+                    layer.upload(prepared, cpucubeedge, gpucubeedge);
                 }
+                discarded |= !current;// prepare it again
             }
+            return discarded;
         };
 
         QElapsedTimer timer;
         timer.start();
+        bool pending = false;
         for (auto & layer : layers) {
             calculateMissingOrthoGPUCubes(layer);
-            loadPendingCubes(layer, layer.pendingOrthoCubes, timer);
-            loadPendingCubes(layer, layer.pendingArbCubes, timer);
+            preparePendingCubes(layer, layer.pendingOrthoCubes);
+            preparePendingCubes(layer, layer.pendingArbCubes);
+            pending |= uploadPreparedCubes(layer, timer);
+            if (layer.isOverlayData) {
+                layer.ctx.makeCurrent(&layer.surface);
+                layer.palette.upload();// slots of the new cubes and recoloured objects
+            }
+            pending |= layer.hasPrepared();
+        }
+        if (pending) {// upload the rest during the next frames
+            postDamage();
         }
     }
+    if (state->skeletonState->definedSkeletonVpView == SKELVP_R90 || state->skeletonState->definedSkeletonVpView == SKELVP_R180) {
+        postDamage();// rotation animation advances once per frame
+    }
 
     window->forEachOrthoVPDo([this](ViewportOrtho & vp) {
         vp.update();
@@ -907,6 +1121,25 @@ void Viewer::run() {
     window->updateTitlebar(); //display changes after filename
 }
 
+void Viewer::handlePendingHovers() {
+    std::vector<std::pair<ViewportOrtho *, Coordinate>> hovers;
+    window->forEachOrthoVPDo([&hovers](ViewportOrtho & vp) {
+        if (vp.pendingHover) {
+            hovers.emplace_back(&vp, getCoordinateFromOrthogonalClick(vp.pendingHover->x(), vp.pendingHover->y(), vp));
+        }
+    });
+    std::vector<uint64_t> subobjectIds;
+    {// all lookups of this frame share one locked view of the cube pointers, the handlers run unlocked as they may read voxels themselves
+        QMutexLocker pin(&state->protectCube2Pointer);
+        for (const auto & hover : hovers) {
+            subobjectIds.emplace_back(readVoxelPinned(hover.second));
+        }
+    }
+    for (std::size_t i = 0; i < hovers.size(); ++i) {
+        hovers[i].first->handleHover(hovers[i].second, subobjectIds[i]);
+    }
+}
+
 void Viewer::applyTextureFilterSetting(const GLint texFiltering) {
     window->forEachOrthoVPDo([&texFiltering](ViewportOrtho & orthoVP) {
         orthoVP.texture.textureFilter = texFiltering;
@@ -915,10 +1148,12 @@ void Viewer::applyTextureFilterSetting(const GLint texFiltering) {
             glBindTexture(GL_TEXTURE_2D, orthoVP.texture.texHandle);
             // Set the parameters for the texture.
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texFiltering);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texFiltering);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, orthoVP.texture.minFilter());
         }
     });
     glBindTexture(GL_TEXTURE_2D, 0);
+    viewportArb->dcResliceNecessary = true;// the arb slice is resampled with the filter
+    postDamage();
 }
 
 void Viewer::updateCurrentPosition() {
@@ -974,8 +1209,12 @@ void Viewer::userMoveVoxels(const Coordinate & step, UserMoveType userMoveType,
     const auto newPosition_gpudc = viewerState.currentPosition.cube(gpucubeedge, state->magnification);
 
     if (newPosition_dc != lastPosition_dc) {
-        dc_reslice_notify_visible();
-        oc_reslice_notify_visible();
+        // only the newly exposed cubes have to be sliced into the texture rings
+        window->forEachOrthoVPDo([](ViewportOrtho & vpOrtho) {
+            vpOrtho.dcResliceNecessary = vpOrtho.ocResliceNecessary = true;
+        });
+        Segmentation::singleton().volume_update_partial = false;
+        Segmentation::singleton().volume_update_required = true;
 
         state->loaderUserMoveType = userMoveType;
         Coordinate direction = (userMoveType == USERMOVE_DRILL)? step : (userMoveType == USERMOVE_HORIZONTAL)? viewportNormal : Coordinate(0, 0, 0);
@@ -996,7 +1235,7 @@ void Viewer::userMoveVoxels(const Coordinate & step, UserMoveType userMoveType,
                 }
             }
             for (const auto & pos : obsoleteCubes) {
-                layer.textures.erase(pos);
+                layer.retire(pos, state->magnification, gpucubeedge);
             }
             calculateMissingOrthoGPUCubes(layer);
         }
@@ -1035,7 +1274,7 @@ void Viewer::calculateMissingOrthoGPUCubes(TextureLayer & layer) {
     for (int z = edge.z; z < end.z; ++z) {
         const auto gpuCoord = CoordOfGPUCube{x, y, z};
         const auto globalCoord = gpuCoord.cube2Global(gpucubeedge, state->magnification);
-        if (currentlyVisible(globalCoord, state->viewerState->currentPosition, gpusupercube, gpucubeedge) && layer.textures.count(gpuCoord) == 0) {
+        if (currentlyVisible(globalCoord, state->viewerState->currentPosition, gpusupercube, gpucubeedge) && layer.textures.count(gpuCoord) == 0 && !layer.restore(gpuCoord, state->magnification)) {
             const auto cubeCoord = globalCoord.cube(state->cubeEdgeLength, state->magnification);
             const auto offset = globalCoord - cubeCoord.cube2Global(state->cubeEdgeLength, state->magnification);
             layer.pendingOrthoCubes.emplace_back(gpuCoord, offset);
@@ -1043,34 +1282,172 @@ void Viewer::calculateMissingOrthoGPUCubes(TextureLayer & layer) {
     }
 }
 
+/**
+ * @brief markArrivedCube queues the slots of a loaded cube for reslicing without invalidating the rest of the ring
+ */
+static void markArrivedCube(ViewportOrtho & vp, std::unordered_set<Coordinate> & arrived, std::atomic_bool & ringValid, const Coordinate & globalCoord) {
+    const std::size_t maxArrivedCubes = 4096;// beyond that a complete reslice is cheaper
+    QMutexLocker locker(&vp.arrivedCubesMutex);
+    if (arrived.size() < maxArrivedCubes) {
+        arrived.emplace(globalCoord);
+    } else {
+        arrived.clear();
+        ringValid = false;
+    }
+}
+
 void Viewer::dc_reslice_notify_all(const Coordinate coord) {
     if (currentlyVisibleWrapWrap(state->viewerState->currentPosition, coord)) {
-        dc_reslice_notify_visible();
+        window->forEachOrthoVPDo([&coord](ViewportOrtho & vpOrtho) {
+            if (vpOrtho.viewportType != VIEWPORT_ARBITRARY) {// arb is always resliced completely
+                markArrivedCube(vpOrtho, vpOrtho.dcArrivedCubes, vpOrtho.dcRingValid, coord);
+            }
+            vpOrtho.dcResliceNecessary = true;
+        });
     }
     window->viewportArb->dcResliceNecessary = true;//arb visibility is not tested
+    postDamage();
 }
 
 void Viewer::dc_reslice_notify_visible() {
     window->forEachOrthoVPDo([](ViewportOrtho & vpOrtho) {
+        vpOrtho.dcRingValid = false;
         vpOrtho.dcResliceNecessary = true;
     });
+    postDamage();
+}
+
+/**
+ * @brief Viewer::resetGpuCubes drops all gpu cubes, e.g. after another dataset was loaded
+ */
+void Viewer::resetGpuCubes() {
+    for (auto & layer : layers) {
+        layer.reset(state->cubeEdgeLength, gpucubeedge);
+    }
+    postDamage();
+}
+
+/**
+ * @brief Viewer::invalidateOverlayGpuCubes the gpu overlay cubes overlapping the voxels globalFirst to globalLast have to be uploaded again
+ */
+void Viewer::invalidateOverlayGpuCubes(const Coordinate & globalFirst, const Coordinate & globalLast) {
+    for (auto & layer : layers) {
+        if (layer.isOverlayData) {
+            layer.invalidate(globalFirst, globalLast, state->magnification, gpucubeedge);
+        }
+    }
+}
+
+/**
+ * @brief Viewer::recolorOverlayPalettes updates the palette entries of the subobjects of an object or of all subobjects
+ */
+void Viewer::recolorOverlayPalettes(const boost::optional<uint64_t> objectIndex) {
+    const auto ids = objectIndex ? Segmentation::singleton().subobjectIdsOfObjectIndex(objectIndex.get()) : std::vector<uint64_t>{};
+    for (auto & layer : layers) {
+        if (!layer.isOverlayData) {
+            continue;
+        }
+        if (objectIndex) {
+            for (const auto id : ids) {
+                layer.palette.recolor(id);
+            }
+        } else {
+            layer.palette.recolorAll();
+        }
+    }
+    postDamage();
 }
 
 void Viewer::oc_reslice_notify_all(const Coordinate coord) {
     if (currentlyVisibleWrapWrap(state->viewerState->currentPosition, coord)) {
-        oc_reslice_notify_visible();
+        window->forEachOrthoVPDo([&coord](ViewportOrtho & vpOrtho) {
+            if (vpOrtho.viewportType != VIEWPORT_ARBITRARY) {// arb is always resliced completely
+                markArrivedCube(vpOrtho, vpOrtho.ocArrivedCubes, vpOrtho.ocRingValid, coord);
+            }
+            vpOrtho.ocResliceNecessary = true;
+        });
     }
     window->viewportArb->ocResliceNecessary = true;//arb visibility is not tested
     // if anything has changed, update the volume texture data
+    Segmentation::singleton().volume_update_partial = false;
     Segmentation::singleton().volume_update_required = true;
+    postDamage();
+}
+
+/**
+ * @brief Viewer::oc_reslice_notify_region marks the voxels globalFirst to globalLast (inclusive) of one overlay cube as modified
+ *
+ * Only the ortho tiles of this cube intersecting the edited voxels and the corresponding texels of the volume are regenerated.
+ */
+void Viewer::oc_reslice_notify_region(const CoordOfCube & cube, const Coordinate & globalFirst, const Coordinate & globalLast) {
+    const std::size_t maxDirtyRegions = 4096;// beyond that a complete reslice is cheaper
+    const auto cubeBegin = cube.cube2Global(state->cubeEdgeLength, state->magnification);
+    const auto cubeLast = cubeBegin + state->cubeEdgeLength * state->magnification - 1;
+    const auto region = std::make_pair(globalFirst.capped(cubeBegin, cubeLast), globalLast.capped(cubeBegin, cubeLast));
+    invalidateOverlayGpuCubes(region.first, region.second);
+    if (currentlyVisibleWrapWrap(state->viewerState->currentPosition, cubeBegin)) {
+        window->forEachOrthoVPDo([&region, maxDirtyRegions](ViewportOrtho & vpOrtho) {
+            if (vpOrtho.viewportType != VIEWPORT_ARBITRARY) {// arb is always resliced completely
+                if (vpOrtho.ocDirtyRegions.size() < maxDirtyRegions) {
+                    vpOrtho.ocDirtyRegions.emplace_back(region);
+                } else {
+                    vpOrtho.ocDirtyRegions.clear();
+                    vpOrtho.ocRingValid = false;
+                }
+            }
+            vpOrtho.ocResliceNecessary = true;
+        });
+    }
+    window->viewportArb->ocResliceNecessary = true;//arb visibility is not tested
+    auto & seg = Segmentation::singleton();
+    if (seg.volume_render_toggle && seg.volume_dirty_regions.size() < maxDirtyRegions) {
+        if (!seg.volume_update_required) {
+            seg.volume_update_partial = true;
+        }
+        seg.volume_dirty_regions.emplace_back(region);
+    } else {// regions are only consumed while the volume is shown
+        seg.volume_dirty_regions.clear();
+        seg.volume_update_partial = false;
+    }
+    seg.volume_update_required = true;
+    postDamage();
+}
+
+/**
+ * @brief Viewer::oc_reslice_notify_object the colour or selection of an object changed
+ *
+ * Only the volume bricks containing its subobjects are regenerated.
+ */
+void Viewer::oc_reslice_notify_object(const uint64_t objectIndex) {
+    window->forEachOrthoVPDo([](ViewportOrtho & vpOrtho) {
+        vpOrtho.ocRingValid = false;
+        vpOrtho.ocResliceNecessary = true;
+    });
+    const std::size_t maxRecolorIds = 1 << 16;// beyond that a complete rebuild is cheaper
+    auto & seg = Segmentation::singleton();
+    const auto ids = seg.subobjectIdsOfObjectIndex(objectIndex);
+    if (seg.volume_render_toggle && seg.volume_recolor_ids.size() + ids.size() < maxRecolorIds) {
+        if (!seg.volume_update_required) {
+            seg.volume_update_partial = true;
+        }
+        seg.volume_recolor_ids.insert(std::end(seg.volume_recolor_ids), std::begin(ids), std::end(ids));
+    } else {// ids are only consumed while the volume is shown
+        seg.volume_recolor_ids.clear();
+        seg.volume_update_partial = false;
+    }
+    seg.volume_update_required = true;
+    postDamage();
 }
 
 void Viewer::oc_reslice_notify_visible() {
     window->forEachOrthoVPDo([](ViewportOrtho & vpOrtho) {
+        vpOrtho.ocRingValid = false;
         vpOrtho.ocResliceNecessary = true;
     });
     // if anything has changed, update the volume texture data
+    Segmentation::singleton().volume_update_partial = false;
     Segmentation::singleton().volume_update_required = true;
+    postDamage();
 }
 
 void Viewer::recalcTextureOffsets() {
@@ -1096,6 +1473,13 @@ void Viewer::recalcTextureOffsets() {
             midX = 0.5 * texUsed;
             midY = 0.5 * texUsed;
         }
+        const auto slots = ringSlots(orthoVP.texture);
+        if (orthoVP.viewportType != VIEWPORT_ARBITRARY && slots != 0) {// shift by the ring slot of the upper left cube
+            const CoordOfCube upperLeftDc = Coordinate(orthoVP.texture.leftUpperPxInAbsPx).cube(state->cubeEdgeLength, state->magnification);
+            const auto slotEdge = static_cast<float>(state->cubeEdgeLength) / orthoVP.texture.size;
+            midX += slotEdge * ringSlot(orthoVP.viewportType == VIEWPORT_ZY ? upperLeftDc.z : upperLeftDc.x, slots);
+            midY += slotEdge * ringSlot(orthoVP.viewportType == VIEWPORT_XZ ? upperLeftDc.z : upperLeftDc.y, slots);
+        }
         // Calculate the vertices in texture coordinates
         // mid really means current pos inside the texture, in texture coordinates, relative to the texture origin 0., 0.
 //        if (orthoVP.viewportType != VIEWPORT_ARBITRARY) {
@@ -1119,6 +1503,7 @@ void Viewer::recalcTextureOffsets() {
 //            orthoVP.texture.texLLy = 0;
 //        }
     });
+    postDamage();
 }
 
 void Viewer::loader_notify() {
@@ -1156,6 +1541,7 @@ void Viewer::datasetColorAdjustmentsChanged() {
         }
     }
     state->viewerState->datasetAdjustmentOn = state->viewerState->datasetColortableOn || state->viewerState->luminanceBias > 0 || state->viewerState->luminanceRangeDelta < MAX_COLORVAL;
+    rawSliceTables.fill(boost::none);
 
     dc_reslice_notify_visible();
 }
@@ -1226,6 +1612,7 @@ void Viewer::resizeTexEdgeLength(const int cubeEdge, const int superCubeEdge) {
 
 void Viewer::loadNodeLUT(const QString & path) {
     state->viewerState->nodeColors = loadLookupTable(path);
+    postDamage();
 }
 
 void Viewer::loadTreeLUT(const QString & path) {
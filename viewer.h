@@ -26,6 +26,7 @@
 #include "functions.h"
 #include "remote.h"
 #include "slicer/gpucuber.h"
+#include "slicer/rawslice.h"
 #include "widgets/preferences/navigationtab.h"
 #include "widgets/mainwindow.h"
 #include "widgets/viewport.h"
@@ -39,6 +40,10 @@
 #include <QQuaternion>
 #include <QTimer>
 
+#include <boost/optional.hpp>
+
+#include <array>
+#include <atomic>
 #include <vector>
 
 #define SLOW 1000
@@ -176,18 +181,30 @@ private:
     QElapsedTimer keyRepeatTimer;
     floatCoordinate moveCache; //Cache for Movements smaller than pixel coordinate
 
+    // frames are only rendered after something posted damage
+    std::atomic_bool damagePosted{false};
+    QElapsedTimer frameTimer;// started with each frame
+    double gpuCubeBudgetMs{3};// time per frame for gpu cube uploads, adapted to the measured frame time
+    int frameInterval() const;
+    Q_INVOKABLE void scheduleFrame();
+    void handlePendingHovers();
+    bool eventFilter(QObject * watched, QEvent * event) override;
+
     ViewerState viewerState;
     void initViewer();
     void rewire();
 
     void vpGenerateTexture(ViewportArb & vp);
 
+    std::array<boost::optional<RawSlice::Tables>, 2> rawSliceTables;//without and with custom LUT
+    const RawSlice::Tables & sliceTables(const bool useCustomLUT);
     void dcSliceExtract(char *datacube, Coordinate cubePosInAbsPx, char *slice, ViewportOrtho & vp, bool useCustomLUT);
-    void dcSliceExtract(char *datacube, floatCoordinate *currentPxInDc_float, char *slice, int s, int *t, ViewportArb &vp, bool useCustomLUT);
 
     void ocSliceExtract(char *datacube, Coordinate cubePosInAbsPx, char *slice, ViewportOrtho & vp);
 
     void calcLeftUpperTexAbsPx();
+    void invalidateOverlayGpuCubes(const Coordinate & globalFirst, const Coordinate & globalLast);
+    void recolorOverlayPalettes(const boost::optional<uint64_t> objectIndex = boost::none);
 
     Remote remote;
 public:
@@ -207,12 +224,15 @@ public:
     ViewportArb *viewportArb;
     void zoom(const float factor);
     void zoomReset();
+    /** @brief Smallest ortho FOV of the current mag, zooming in beyond it switches to the next finer mag. */
+    float zoomMaxFOV();
     QTimer timer;
 
     void arbCubes(ViewportArb & vp);
     void setEnableArbVP(const bool on);
     void setDefaultVPSizeAndPos(const bool on);
     void resizeTexEdgeLength(const int cubeEdge, const int superCubeEdge);
+    void resetGpuCubes();
     void loadNodeLUT(const QString & path);
     void loadTreeLUT(const QString & path = ":/resources/color_palette/default.json");
     QColor getNodeColor(const nodeListElement & node) const;
@@ -237,6 +257,7 @@ public slots:
     void calcDisplayedEdgeLength();
     void applyTextureFilterSetting(const GLint texFiltering);
     void run();
+    void postDamage();
     void loader_notify();
     void defaultDatasetLUT();
     void loadDatasetLUT(const QString & path);
@@ -249,6 +270,8 @@ public slots:
     void dc_reslice_notify_all(const Coordinate coord);
     void oc_reslice_notify_visible();
     void oc_reslice_notify_all(const Coordinate coord);
+    void oc_reslice_notify_region(const CoordOfCube & cube, const Coordinate & globalFirst, const Coordinate & globalLast);
+    void oc_reslice_notify_object(const uint64_t objectIndex);
     void setMovementAreaFactor(float alpha);
     uint highestMag();
     uint lowestMag();
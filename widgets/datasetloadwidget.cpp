@@ -160,16 +160,27 @@ void DatasetLoadWidget::updateDatasetInfo() {
     bool bad = tableWidget.selectedItems().empty();
     QString dataset;
     bad = bad || (dataset = tableWidget.selectedItems().front()->text()).isEmpty();
-    decltype(Network::singleton().refresh(std::declval<QUrl>())) download;
-    const QUrl url{dataset + (!QUrl{dataset}.isLocalFile() ? "/" : "")};// add slash to avoid redirects
-    bad = bad || !(download = Network::singleton().refresh(url)).first;
     if (bad) {
         infoLabel.setText("");
         return;
     }
+    const QUrl url{dataset + (!QUrl{dataset}.isLocalFile() ? "/" : "")};// add slash to avoid redirects
+    Network::singleton().refreshDatasetConfig(url, this, [this, dataset, url](const bool success, const QString & config){
+        const bool stillSelected = !tableWidget.selectedItems().empty() && tableWidget.selectedItems().front()->text() == dataset;
+        if (!stillSelected) {
+            return;//a newer request is responsible
+        }
+        if (!success) {
+            infoLabel.setText("");
+            return;
+        }
+        showDatasetInfo(url, config);
+    });
+}
 
+void DatasetLoadWidget::showDatasetInfo(const QUrl & url, const QString & config) {
     const auto ocp = url.toString().contains("/ocp/ca/");
-    const auto datasetinfo = ocp ? Dataset::parseOpenConnectomeJson(url, download.second) : Dataset::fromLegacyConf(url, download.second);
+    const auto datasetinfo = ocp ? Dataset::parseOpenConnectomeJson(url, config) : Dataset::fromLegacyConf(url, config);
 
     //make sure supercubeedge is small again
     auto supercubeedge = (fovSpin.value() + cubeEdgeSpin.value()) / datasetinfo.cubeEdgeLength;
@@ -223,8 +234,12 @@ void DatasetLoadWidget::processButtonClicked() {
     const auto dataset = tableWidget.item(tableWidget.currentRow(), 0)->text();
     if (dataset.isEmpty()) {
         QMessageBox::information(this, "Unable to load", "No path selected");
-    } else if (loadDataset(boost::none, dataset)) {
-        hide(); //hide datasetloadwidget only if we could successfully load a dataset
+    } else {
+        loadDataset(boost::none, dataset, false, [this](const bool loaded){
+            if (loaded) {
+                hide(); //hide datasetloadwidget only if we could successfully load a dataset
+            }
+        });
     }
 }
 
@@ -233,15 +248,45 @@ void DatasetLoadWidget::processButtonClicked() {
  * 2. for multires datasets: by selecting the dataset folder (the folder containing the "magX" subfolders)
  * 3. by specifying a .conf directly.
  */
-bool DatasetLoadWidget::loadDataset(const boost::optional<bool> loadOverlay, QUrl path,  const bool silent) {
-    if (path.isEmpty() && datasetUrl.isEmpty()) {//no dataset available to load
+QUrl DatasetLoadWidget::configUrl(QUrl path) const {
+    if (path.isEmpty()) {//if empty reload previous
+        path = datasetUrl;
+    }
+    if (!path.isEmpty()) {
+        path.setPath(path.path() + (!path.isLocalFile() ? "/" : ""));// add slash to avoid redirects
+    }
+    return path;
+}
+
+void DatasetLoadWidget::loadDataset(const boost::optional<bool> loadOverlay, const QUrl & path, const bool silent, std::function<void(bool)> done) {
+    const auto url = configUrl(path);
+    if (url.isEmpty()) {//no dataset available to load
+        open();
+        return;
+    }
+    const auto request = ++loadRequest;
+    Network::singleton().refreshDatasetConfig(url, this, [this, loadOverlay, url, silent, done, request](const bool success, const QString & config){
+        if (request != loadRequest) {
+            return;//a newer request is responsible
+        }
+        const bool loaded = applyDataset(loadOverlay, url, {success, config}, silent);
+        if (done) {
+            done(loaded);
+        }
+    });
+}
+
+bool DatasetLoadWidget::loadDatasetBlocking(const boost::optional<bool> loadOverlay, const QUrl & path, const bool silent) {
+    const auto url = configUrl(path);
+    if (url.isEmpty()) {//no dataset available to load
         open();
         return false;
-    } else if (path.isEmpty()) {//if empty reload previous
-        path = datasetUrl;
     }
-    path.setPath(path.path() + (!path.isLocalFile() ? "/" : ""));// add slash to avoid redirects
-    const auto download = Network::singleton().refresh(path);
+    ++loadRequest;// supersedes asynchronous requests
+    return applyDataset(loadOverlay, url, Network::singleton().refreshDatasetConfig(url), silent);
+}
+
+bool DatasetLoadWidget::applyDataset(const boost::optional<bool> loadOverlay, const QUrl & path, const QPair<bool, QString> & download, const bool silent) {
     if (!download.first) {
         if (!silent) {
             QMessageBox box(this);
@@ -271,24 +316,13 @@ bool DatasetLoadWidget::loadDataset(const boost::optional<bool> loadOverlay, QUr
 
     Dataset info;
     Dataset::CubeType raw_compression;
+    bool probeMags = false;
     if (path.toString().contains("/ocp/ca/")) {
         info = Dataset::parseOpenConnectomeJson(path, download.second);
     } else {
         info = Dataset::fromLegacyConf(path, download.second);
-        try {
-            info.checkMagnifications();
-        } catch (std::exception &) {
-            if (!silent) {
-                QMessageBox box(this);
-                box.setIcon(QMessageBox::Warning);
-                box.setText("Dataset will not be loaded.");
-                box.setInformativeText("No magnifications could be detected. (knossos.conf in mag folder)");
-                box.exec();
-                open();
-            }
-            qDebug() << "no mags";
-            return false;
-        }
+        info.restoreMagnifications(download.second);//until revalidated the cached mags or only the mag of the config are available
+        probeMags = true;
     }
     datasetUrl = {path};//remember config url
     Loader::Controller::singleton().suspendLoader();//we change variables the loader uses
@@ -307,6 +341,7 @@ bool DatasetLoadWidget::loadDataset(const boost::optional<bool> loadOverlay, QUr
     state->viewer->resizeTexEdgeLength(state->cubeEdgeLength, state->M);
 
     applyGeometrySettings();
+    state->viewer->resetGpuCubes();// resident gpu cubes of the previous dataset must not be restored
 
     emit datasetSwitchZoomDefaults();
 
@@ -326,6 +361,31 @@ bool DatasetLoadWidget::loadDataset(const boost::optional<bool> loadOverlay, QUr
     state->viewer->userMove({0, 0, 0}, USERMOVE_NEUTRAL);
     emit datasetChanged(segmentationOverlayCheckbox.isChecked());
 
+    if (probeMags) {//the loader already fetches the center while the mags are probed, the server layout may have changed since they were cached
+        info.checkMagnifications(download.second, this, [this, path](const int lowest, const int highest){
+            if (datasetUrl != path) {
+                return;//another dataset was loaded meanwhile
+            }
+            if (lowest > highest) {
+                qDebug() << "no mags detected, keeping mag" << state->magnification << "of the config";
+                return;
+            }
+            if (static_cast<uint>(lowest) == state->lowestAvailableMag && static_cast<uint>(highest) == state->highestAvailableMag) {
+                return;
+            }
+            state->lowestAvailableMag = lowest;
+            state->highestAvailableMag = highest;
+            Loader::Controller::singleton().availableMagsChanged();
+            const auto mag = std::min(std::max(static_cast<uint>(state->magnification), state->lowestAvailableMag), state->highestAvailableMag);
+            if (static_cast<uint>(state->magnification) != mag) {
+                state->viewer->updateDatasetMag(mag);
+            } else {
+                state->viewer->loader_notify();//continue loading after the loader was suspended
+            }
+            emit datasetMagsChanged();
+        });
+    }
+
     return true;
 }
 
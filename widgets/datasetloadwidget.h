@@ -35,6 +35,7 @@
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QListWidget>
+#include <QPair>
 #include <QTextDocument>
 #include <QSpinBox>
 #include <QString>
@@ -42,6 +43,8 @@
 #include <QTableWidget>
 #include <QVBoxLayout>
 
+#include <functional>
+
 class FOVSpinBox : public QSpinBox {
 public:
     uint cubeEdge{128};
@@ -86,16 +89,27 @@ class DatasetLoadWidget : public DialogVisibilityNotify {
     QHBoxLayout buttonHLayout;
     QPushButton processButton{"Load Dataset"};
     QPushButton cancelButton{"Close"};
+    std::size_t loadRequest{0};// only the most recent load is applied
+    QUrl configUrl(QUrl path) const;
+    bool applyDataset(const boost::optional<bool> loadOverlay, const QUrl & path, const QPair<bool, QString> & download, const bool silent);
 public:
     QUrl datasetUrl;//meh
 
     explicit DatasetLoadWidget(QWidget *parent = 0);
     void changeDataset(bool isGUI);
-    bool loadDataset(const boost::optional<bool> loadOverlay = boost::none, QUrl path = {}, const bool silent = false);
+    /**
+     * @brief fetches the config without blocking and switches to the dataset, done receives whether it was loaded
+     */
+    void loadDataset(const boost::optional<bool> loadOverlay = boost::none, const QUrl & path = {}, const bool silent = false, std::function<void(bool)> done = {});
+    /**
+     * @brief switches to the dataset before returning, for callers which continue with the state of the new dataset
+     */
+    bool loadDatasetBlocking(const boost::optional<bool> loadOverlay, const QUrl & path, const bool silent);
     void saveSettings();
     void loadSettings();
     void applyGeometrySettings();
     void updateDatasetInfo();
+    void showDatasetInfo(const QUrl & url, const QString & config);
     void insertDatasetRow(const QString & dataset, const int pos);
     void datasetCellChanged(int row, int col);
     QStringList getRecentPathItems();
@@ -103,6 +117,7 @@ public:
 signals:
     void updateDatasetCompression();
     void datasetChanged(bool showOverlays);
+    void datasetMagsChanged();
     void datasetSwitchZoomDefaults();
 public slots:
     void adaptMemoryConsumption();
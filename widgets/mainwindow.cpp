@@ -403,7 +403,7 @@ void MainWindow::setJobModeUI(bool enabled) {
 }
 
 void MainWindow::updateTodosLeft() {
-    int todosLeft = Segmentation::singleton().todolist().size();
+    int todosLeft = Segmentation::singleton().todosLeft();
     auto & job = Segmentation::singleton().job;
 
     if(todosLeft > 0) {
@@ -1420,7 +1420,7 @@ void MainWindow::updateCompressionRatioDisplay() {
 
 bool MainWindow::event(QEvent *event) {
     if (event->type() == QEvent::WindowActivate) {
-        state->viewer->run();
+        state->viewer->postDamage();
     }
     return QMainWindow::event(event);
 }
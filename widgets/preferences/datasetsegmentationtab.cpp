@@ -117,6 +117,7 @@ DatasetAndSegmentationTab::DatasetAndSegmentationTab(QWidget *parent) : QWidget(
         volumeColorLabel.setEnabled(checked);
         volumeColorButton.setEnabled(checked);
         emit volumeRenderToggled();
+        state->viewer->postDamage();
     });
     QObject::connect(&volumeColorButton, &QPushButton::clicked, [this]() {
         state->viewerState->renderInterval = SLOW;
@@ -125,17 +126,20 @@ DatasetAndSegmentationTab::DatasetAndSegmentationTab(QWidget *parent) : QWidget(
         if (color.isValid() == QColorDialog::Accepted) {
             Segmentation::singleton().volume_background_color = color;
             volumeColorButton.setStyleSheet("background-color: " + color.name() + ";");
+            state->viewer->postDamage();
         }
     });
     QObject::connect(&volumeOpaquenessSlider, &QSlider::valueChanged, [this](int value){
         volumeOpaquenessSpinBox.setValue(value);
         Segmentation::singleton().volume_opacity = value;
         Segmentation::singleton().volume_update_required = true;
+        state->viewer->postDamage();
     });
     QObject::connect(&volumeOpaquenessSpinBox, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), [this](int value){
         volumeOpaquenessSlider.setValue(value);
         Segmentation::singleton().volume_opacity = value;
         Segmentation::singleton().volume_update_required = true;
+        state->viewer->postDamage();
     });
 
     QObject::connect(&state->viewer->mainWindow, &MainWindow::overlayOpacityChanged, [this]() { segmentationOverlaySlider.setValue(Segmentation::singleton().alpha); });
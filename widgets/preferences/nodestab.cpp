@@ -119,14 +119,25 @@ NodesTab::NodesTab(QWidget *parent) : QWidget(parent) {
 
     QObject::connect(&idCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [](const int index) {
         state->viewerState->idDisplay = index == 2 ? IdDisplay::AllNodes : index == 1 ? IdDisplay::ActiveNode : IdDisplay::None;
+        state->viewer->postDamage();
+    });
+    QObject::connect(&overrideNodeRadiusSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [](const double value ) {
+        state->viewerState->overrideNodeRadiusVal = value;
+        state->viewer->postDamage();
+    });
+    QObject::connect(&nodeCommentsCheck, &QCheckBox::clicked, [](const bool checked) {
+        ViewportOrtho::showNodeComments = checked;
+        state->viewer->postDamage();
     });
-    QObject::connect(&overrideNodeRadiusSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [](const double value ) { state->viewerState->overrideNodeRadiusVal = value; });
-    QObject::connect(&nodeCommentsCheck, &QCheckBox::clicked, [](const bool checked) { ViewportOrtho::showNodeComments = checked; });
     QObject::connect(&overrideNodeRadiusCheck, &QCheckBox::clicked, [this](const bool on) {
         state->viewerState->overrideNodeRadiusBool = on;
         overrideNodeRadiusSpin.setEnabled(on);
+        state->viewer->postDamage();
+    });
+    QObject::connect(&edgeNodeRatioSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [](const double value) {
+        state->viewerState->segRadiusToNodeRadius = value;
+        state->viewer->postDamage();
     });
-    QObject::connect(&edgeNodeRatioSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [](const double value) { state->viewerState->segRadiusToNodeRadius = value; });
     // properties
     static auto propertyConversionCheck = [this](auto index, auto property, auto & combo){
         if (index > Skeletonizer::singleton().getNumberProperties().size()) {
@@ -155,9 +166,13 @@ NodesTab::NodesTab(QWidget *parent) : QWidget(parent) {
         if (propertyConversionCheck(index, property, propertyRadiusCombo)) {
             state->viewerState->highlightedNodePropertyByRadius = property;
             propertyRadiusScaleSpin.setEnabled(index > 0);
+            state->viewer->postDamage();
         }
     });
-    QObject::connect(&propertyRadiusScaleSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [](const double value) { state->viewerState->nodePropertyRadiusScale = value; });
+    QObject::connect(&propertyRadiusScaleSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [](const double value) {
+        state->viewerState->nodePropertyRadiusScale = value;
+        state->viewer->postDamage();
+    });
     QObject::connect(&propertyColorCombo, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this](const int index) {
         const auto property = (index > 0) ? propertyModel.properties[index] : "";
         if (propertyConversionCheck(index, property, propertyColorCombo)) {
@@ -171,14 +186,17 @@ NodesTab::NodesTab(QWidget *parent) : QWidget(parent) {
                 findAndSetPropertyRange(state->viewerState->highlightedNodePropertyByColor);
                 loadNodeLUTRequest(lutPath);
             }
+            state->viewer->postDamage();
         }
     });
     QObject::connect(&propertyMinSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [this](const double value){
         state->viewerState->nodePropertyColorMapMin = value;
+        state->viewer->postDamage();
         propertyMinMaxButton.setEnabled(true);
     });
     QObject::connect(&propertyMaxSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [this](const double value){
         state->viewerState->nodePropertyColorMapMax = value;
+        state->viewer->postDamage();
         propertyMinMaxButton.setEnabled(true);
     });
     QObject::connect(&propertyMinMaxButton, &QPushButton::clicked, [this]() { findAndSetPropertyRange(state->viewerState->highlightedNodePropertyByColor); });
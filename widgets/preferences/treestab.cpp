@@ -61,11 +61,18 @@ TreesTab::TreesTab(QWidget *parent) : QWidget(parent) {
     setLayout(&mainLayout);
 
     // trees render options
-    QObject::connect(&highlightActiveTreeCheck, &QCheckBox::clicked, [](const bool on) { state->viewerState->highlightActiveTree = on; });
+    QObject::connect(&highlightActiveTreeCheck, &QCheckBox::clicked, [](const bool on) {
+        state->viewerState->highlightActiveTree = on;
+        state->viewer->postDamage();
+    });
     QObject::connect(&highlightIntersectionsCheck, &QCheckBox::clicked, [this](const bool checked) {
         state->viewerState->showIntersections = checked;
+        state->viewer->postDamage();
+    });
+    QObject::connect(&lightEffectsCheck, &QCheckBox::clicked, [](const bool on) {
+        state->viewerState->lightOnOff = on;
+        state->viewer->postDamage();
     });
-    QObject::connect(&lightEffectsCheck, &QCheckBox::clicked, [](const bool on) { state->viewerState->lightOnOff = on; });
     QObject::connect(&msaaSpin, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged), [](const int samples){
         if (samples != state->viewerState->sampleBuffers) {
             state->viewerState->sampleBuffers = samples;
@@ -92,7 +99,10 @@ TreesTab::TreesTab(QWidget *parent) : QWidget(parent) {
         }
     });
     QObject::connect(&loadTreeLUTButton, &QPushButton::clicked, [this]() { loadTreeLUTButtonClicked(); });
-    QObject::connect(&depthCutoffSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [](const double value) { state->viewerState->depthCutOff = value; });
+    QObject::connect(&depthCutoffSpin, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), [](const double value) {
+        state->viewerState->depthCutOff = value;
+        state->viewer->postDamage();
+    });
     QObject::connect(&renderQualityCombo, static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [](const int value){
         if(value == 0) { // tubes and spheres
             state->viewerState->cumDistRenderThres = 1.f;
@@ -101,12 +111,16 @@ TreesTab::TreesTab(QWidget *parent) : QWidget(parent) {
         } else { // lines and points
             state->viewerState->cumDistRenderThres = 20.f;
         }
+        state->viewer->postDamage();
     });
 
     // tree visibility
     QObject::connect(&wholeSkeletonRadio, &QRadioButton::clicked, this, &TreesTab::updateTreeDisplay);
     QObject::connect(&selectedTreesRadio, &QRadioButton::clicked, this, &TreesTab::updateTreeDisplay);
-    QObject::connect(&meshCheck, &QCheckBox::toggled, this, [](const bool checked) { state->viewerState->meshVisibilityOn = checked; });
+    QObject::connect(&meshCheck, &QCheckBox::toggled, this, [](const bool checked) {
+        state->viewerState->meshVisibilityOn = checked;
+        state->viewer->postDamage();
+    });
     QObject::connect(&skeletonInOrthoVPsCheck, &QCheckBox::clicked, this, &TreesTab::updateTreeDisplay);
     QObject::connect(&skeletonIn3DVPCheck, &QCheckBox::clicked, this, &TreesTab::updateTreeDisplay);
 
@@ -132,6 +146,7 @@ void TreesTab::updateTreeDisplay() {
     if (skeletonInOrthoVPsCheck.isChecked()) {
         state->viewerState->skeletonDisplay |= SkeletonDisplay::ShowInOrthoVPs;
     }
+    state->viewer->postDamage();
 }
 
 void TreesTab::loadTreeLUTButtonClicked(QString path) {
@@ -60,16 +60,24 @@ ViewportTab::ViewportTab(QWidget *parent) : QWidget(parent) {
     mainLayout.addWidget(&viewport3DBox);
     setLayout(&mainLayout);
 
-    QObject::connect(&showScalebarCheckBox, &QCheckBox::clicked, [] (bool checked) { state->viewerState->showScalebar = checked; });
+    QObject::connect(&showScalebarCheckBox, &QCheckBox::clicked, [] (bool checked) {
+        state->viewerState->showScalebar = checked;
+        state->viewer->postDamage();
+    });
     QObject::connect(&showVPDecorationCheckBox, &QCheckBox::clicked, this, [] (const bool checked) {
         state->viewerState->showVpDecorations = checked;
         state->viewer->mainWindow.forEachVPDo([&checked](ViewportBase & vp) { vp.showHideButtons(checked); });
+        state->viewer->postDamage();
+    });
+    QObject::connect(&drawIntersectionsCrossHairCheckBox, &QCheckBox::clicked, [](const bool on) {
+        state->viewerState->drawVPCrosshairs = on;
+        state->viewer->postDamage();
     });
-    QObject::connect(&drawIntersectionsCrossHairCheckBox, &QCheckBox::clicked, [](const bool on) { state->viewerState->drawVPCrosshairs = on; });
     QObject::connect(&addArbVPCheckBox, &QCheckBox::clicked, [this](const bool on){
         showArbPlaneCheckBox.setEnabled(on);
         state->viewerState->enableArbVP = on;
         state->viewer->viewportArb->setVisible(on);
+        state->viewer->postDamage();
     });
     QObject::connect(state->viewer, &Viewer::enabledArbVP, [this] (const bool on) {
         addArbVPCheckBox.setChecked(on);
@@ -77,16 +85,30 @@ ViewportTab::ViewportTab(QWidget *parent) : QWidget(parent) {
     });
 
     // 3D viewport
-    QObject::connect(&showXYPlaneCheckBox, &QCheckBox::clicked, [](bool checked) { state->viewerState->showXYplane = checked; });
-    QObject::connect(&showXZPlaneCheckBox, &QCheckBox::clicked, [](bool checked) { state->viewerState->showXZplane = checked; });
-    QObject::connect(&showZYPlaneCheckBox, &QCheckBox::clicked, [](bool checked) { state->viewerState->showZYplane = checked; });
-    QObject::connect(&showArbPlaneCheckBox, &QCheckBox::clicked, [](bool checked) { state->viewerState->showArbplane = checked; });
+    QObject::connect(&showXYPlaneCheckBox, &QCheckBox::clicked, [](bool checked) {
+        state->viewerState->showXYplane = checked;
+        state->viewer->postDamage();
+    });
+    QObject::connect(&showXZPlaneCheckBox, &QCheckBox::clicked, [](bool checked) {
+        state->viewerState->showXZplane = checked;
+        state->viewer->postDamage();
+    });
+    QObject::connect(&showZYPlaneCheckBox, &QCheckBox::clicked, [](bool checked) {
+        state->viewerState->showZYplane = checked;
+        state->viewer->postDamage();
+    });
+    QObject::connect(&showArbPlaneCheckBox, &QCheckBox::clicked, [](bool checked) {
+        state->viewerState->showArbplane = checked;
+        state->viewer->postDamage();
+    });
     QObject::connect(&boundaryGroup, static_cast<void(QButtonGroup::*)(QAbstractButton *, bool)>(&QButtonGroup::buttonToggled), [this](const QAbstractButton *, bool) {
         Viewport3D::showBoundariesInUm = boundariesPhysicalRadioBtn.isChecked();
+        state->viewer->postDamage();
     });
     QObject::connect(&rotationCenterGroup, static_cast<void(QButtonGroup::*)(int, bool)>(&QButtonGroup::buttonToggled), [this](const int id, const bool checked) {
         if (checked) {
             state->viewerState->rotationCenter = static_cast<RotationCenter>(id);
+            state->viewer->postDamage();
         }
     });
 }
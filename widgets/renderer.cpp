@@ -29,6 +29,7 @@
 #include "skeleton/node.h"
 #include "skeleton/skeletonizer.h"
 #include "skeleton/tree.h"
+#include "slicer/volumeslice.h"
 #include "viewer.h"
 
 #include <QMatrix4x4>
@@ -36,6 +37,7 @@
 #include <QOpenGLTimeMonitor>
 #include <QPainter>
 #include <QQuaternion>
+#include <QVector2D>
 #include <QVector3D>
 #include <QOpenGLBuffer>
 #include <QOpenGLFramebufferObject>
@@ -253,7 +255,7 @@ void ViewportBase::renderText(const Coordinate & pos, const QString & str, const
     backup_gl_state();
     QOpenGLPaintDevice paintDevice(gl_viewport[2], gl_viewport[3]);//create paint device from viewport size and current context
     QPainter painter(&paintDevice);
-    painter.setFont(QFont(painter.font().family(), (fontScaling ? std::ceil(0.02*gl_viewport[2]) : defaultFontSize) * devicePixelRatio()));
+    painter.setFont(QFont(painter.font().family(), (fontScaling ? std::ceil(0.02 * gl_viewport[2] * tileScale) : defaultFontSize) * devicePixelRatio()));
     gluProject(pos.x, pos.y - 0.01*edgeLength, pos.z, &model[0], &projection[0], &gl_viewport[0], &x, &y, &z);
     painter.setPen(Qt::black);
     painter.drawText(centered ? x - QFontMetrics(painter.font()).width(str)/2. : x, gl_viewport[3] - y, str);//inverse y coordinate, extract height from gl viewport
@@ -367,9 +369,13 @@ void ViewportOrtho::renderSegPlaneIntersection(const segmentListElement & segmen
     }
 }
 
-void ViewportBase::setFrontFacePerspective() {
+void ViewportBase::loadProjection() {
     glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
+    glLoadMatrixf(tileProjection.constData());
+}
+
+void ViewportBase::setFrontFacePerspective() {
+    loadProjection();
     /* define coordinate system for our viewport: left right bottom top near far */
     glOrtho(0, edgeLength, edgeLength, 0, 25, -25);
 
@@ -589,8 +595,10 @@ void ViewportOrtho::renderViewportFast() {
     overlay_data_shader.setUniformValue("view_matrix", viewMatrix);
     overlay_data_shader.setUniformValue("projection_matrix", projectionMatrix);
     overlay_data_shader.setUniformValue("indexTexture", 0);
-    overlay_data_shader.setUniformValue("textureLUT", 1);
-    overlay_data_shader.setUniformValue("factor", static_cast<float>(std::numeric_limits<gpu_lut_cube::gpu_index>::max()));
+    overlay_data_shader.setUniformValue("palette", 1);
+    overlay_data_shader.setUniformValue("objects", 2);
+    overlay_data_shader.setUniformValue("texelStepX", QVector3D{v1} / gpucubeedge);
+    overlay_data_shader.setUniformValue("texelStepY", QVector3D{v2} / gpucubeedge);
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -601,6 +609,12 @@ void ViewportOrtho::renderViewportFast() {
             if (layer.isOverlayData) {
                 overlay_data_shader.bind();
                 overlay_data_shader.setUniformValue("textureOpacity", Segmentation::singleton().alpha / 256.0f);
+                overlay_data_shader.setUniformValue("paletteSize", QVector2D(layer.palette.texture.width(), layer.palette.texture.height()));
+                // hover and selection only change uniforms and palette entries, the cubes are never touched
+                const auto & seg = Segmentation::singleton();
+                overlay_data_shader.setUniformValue("hoveredObject", seg.hoverVersion ? static_cast<float>(seg.mouseFocusedObjectId + 1) : 0.0f);
+                layer.palette.texture.bind(1);
+                layer.palette.attributeTexture.bind(2);
             } else {
                 raw_data_shader.bind();
                 raw_data_shader.setUniformValue("textureOpacity", layer.opacity);
@@ -608,11 +622,8 @@ void ViewportOrtho::renderViewportFast() {
 
             auto render = [&](auto & cube, const QMatrix4x4 modelMatrix = {}){
                 if (layer.isOverlayData) {
-                    auto & punned = static_cast<gpu_lut_cube&>(cube);
-                    punned.cube.bind(0);
-                    punned.lut.bind(1);
+                    cube.cube.bind(0);
                     overlay_data_shader.setUniformValue("model_matrix", modelMatrix);
-                    overlay_data_shader.setUniformValue("lutSize", static_cast<float>(punned.lut.width() * punned.lut.height() * punned.lut.depth()));
                 } else {
                     raw_data_shader.setUniformValue("model_matrix", modelMatrix);
                     cube.cube.bind(0);
@@ -692,8 +703,7 @@ void ViewportOrtho::renderViewport(const RenderOptions &options) {
     const auto fars = -state->scale.x * state->viewerState->depthCutOff;
     const auto nearVal = -nears;
     const auto farVal = -fars;
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
+    loadProjection();
     glOrtho(-displayedIsoPx, +displayedIsoPx, -displayedIsoPx, +displayedIsoPx, nearVal, farVal);// gluLookAt relies on an unaltered cartesian Projection
 
     const auto isoCurPos = state->scale.componentMul(state->viewerState->currentPosition);
@@ -821,9 +831,21 @@ void Viewport3D::renderVolumeVP() {
         static Profiler render_profiler;
 
         render_profiler.start(); // ----------------------------------------------------------- profiling
+        // the duration of this pass drives the slice count, on the gpu if timer queries are available, otherwise on the cpu
+        if (!volumePassQuerySupport) {
+            volumePassQuerySupport = volumePassQuery.create();
+        }
+        if (volumePassQueryPending && volumePassQuery.isResultAvailable()) {// results arrive some frames later, waiting for them would stall
+            volumePassMs = volumePassQuery.waitForResult() / 1e6;
+            volumePassQueryPending = false;
+        }
+        const bool queryPass = volumePassQuerySupport.get() && !volumePassQueryPending;
+        if (queryPass) {
+            volumePassQuery.begin();
+        }
+        volumePassTimer.restart();
 
-        glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
+        loadProjection();
         glOrtho(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f);
 
         // volume viewport rotation
@@ -879,45 +901,108 @@ void Viewport3D::renderVolumeVP() {
         float scaley = 1.0f / (datascale.y / biggestScale);
         float scalez = 1.0f / (datascale.z / biggestScale);
 
-        glMatrixMode(GL_TEXTURE);
-        glLoadIdentity();
-
+        // slices are view aligned quads, the texture matrix maps them into the volume
+        QMatrix4x4 textureMatrix;
         // dataset translation adjustment
-        glTranslatef((static_cast<float>(state->viewerState->currentPosition.x % cubeLen) / cubeLen - 0.5f) / state->M,
-                     (static_cast<float>(state->viewerState->currentPosition.y % cubeLen) / cubeLen - 0.5f) / state->M,
-                     (static_cast<float>(state->viewerState->currentPosition.z % cubeLen) / cubeLen - 0.5f) / state->M);
-
-        glTranslatef(0.5f, 0.5f, 0.5f);
-        glScalef(volumeClippingAdjust, volumeClippingAdjust, volumeClippingAdjust); // scale to remove cube corner clipping
-        glScalef(scalex, scaley, scalez); // dataset scaling adjustment
-        glMultMatrixf(volRotMatrix.data()); // volume viewport rotation
-        glScalef(1.0f/zoom, 1.0f/zoom, 1.0f/zoom*2.0f); // volume viewport zoom
-        glTranslatef(-0.5f, -0.5f, -0.5f);
-        glTranslatef(transx, transy, 0.0f); // volume viewport translation
+        textureMatrix.translate((static_cast<float>(state->viewerState->currentPosition.x % cubeLen) / cubeLen - 0.5f) / state->M,
+                                (static_cast<float>(state->viewerState->currentPosition.y % cubeLen) / cubeLen - 0.5f) / state->M,
+                                (static_cast<float>(state->viewerState->currentPosition.z % cubeLen) / cubeLen - 0.5f) / state->M);
+
+        textureMatrix.translate(0.5f, 0.5f, 0.5f);
+        textureMatrix.scale(volumeClippingAdjust); // scale to remove cube corner clipping
+        textureMatrix.scale(scalex, scaley, scalez); // dataset scaling adjustment
+        textureMatrix *= volRotMatrix; // volume viewport rotation
+        textureMatrix.scale(1.0f/zoom, 1.0f/zoom, 1.0f/zoom*2.0f); // volume viewport zoom
+        textureMatrix.translate(-0.5f, -0.5f, -0.5f);
+        textureMatrix.translate(transx, transy, 0.0f); // volume viewport translation
+
+        glMatrixMode(GL_TEXTURE);
+        glLoadMatrixf(textureMatrix.constData());
 
         glMatrixMode(GL_MODELVIEW);
         glLoadIdentity();
 
+        // the slice count follows the zoom (constant spacing in texels) and is reduced while the volume pass takes too long
+        const double targetPassMs = 1000.0 / 30;
+        if (volumePassMs >= 0) {// every measurement is used once
+            volumeSliceQuality = volumePassMs > 1.25 * targetPassMs ? std::max(0.25f, volumeSliceQuality * 0.8f) : volumePassMs < targetPassMs ? std::min(1.0f, volumeSliceQuality + 0.05f) : volumeSliceQuality;
+            volumePassMs = -1;
+        }
+        const float fullSliceCount = texLen * volumeClippingAdjust * maxScaleRatio;
+        const int sliceCount = std::max(16.0f, std::min(2 * fullSliceCount, fullSliceCount * volumeSliceQuality / zoom));
+
+        // tighten each slice to the occupied cells of the volume it intersects
+        struct Rect {
+            float left{1}, top{1}, right{0}, bottom{0};// (u, v) of the quad, empty
+        };
+        std::vector<Rect> rects(sliceCount);
+        const auto cells = VolumeSlice::cellsPerAxis(texLen);
+        if (volumeOccupancy.size() == static_cast<std::size_t>(cells * cells * cells)) {
+            const auto sliceMatrix = textureMatrix.inverted();// volume → (u, v, depth)
+            const float cellSize = static_cast<float>(VolumeSlice::cellEdge) / texLen;
+            const QVector3D axisX = sliceMatrix.mapVector({cellSize, 0, 0}), axisY = sliceMatrix.mapVector({0, cellSize, 0}), axisZ = sliceMatrix.mapVector({0, 0, cellSize});
+            const QVector3D extent{std::abs(axisX.x()) + std::abs(axisY.x()) + std::abs(axisZ.x()), std::abs(axisX.y()) + std::abs(axisY.y()) + std::abs(axisZ.y()), std::abs(axisX.z()) + std::abs(axisY.z()) + std::abs(axisZ.z())};
+            for (int z = 0; z < cells; ++z)
+            for (int y = 0; y < cells; ++y)
+            for (int x = 0; x < cells; ++x) {
+                if (volumeOccupancy[(z * cells + y) * cells + x] == 0) {
+                    continue;
+                }
+                const auto center = sliceMatrix * QVector3D((x + 0.5f) * cellSize, (y + 0.5f) * cellSize, (z + 0.5f) * cellSize);
+                const auto first = center - extent / 2, last = center + extent / 2;
+                const int firstSlice = std::max(0, static_cast<int>(std::ceil(first.z() * sliceCount)));
+                const int lastSlice = std::min(sliceCount - 1, static_cast<int>(std::floor(last.z() * sliceCount)));
+                for (int i = firstSlice; i <= lastSlice; ++i) {
+                    auto & rect = rects[i];
+                    rect.left = std::min(rect.left, first.x());
+                    rect.right = std::max(rect.right, last.x());
+                    rect.top = std::min(rect.top, first.y());
+                    rect.bottom = std::max(rect.bottom, last.y());
+                }
+            }
+        }
+
+        // opacity per slice is corrected for the slice count, the composite matches the full slice count
+        const float volume_opacity = 1.0f - std::pow(1.0f - seg.volume_opacity / 255.0f, fullSliceCount / sliceCount);
+        std::vector<GLfloat> vertices;// x y z, s t r, r g b a per vertex
+        vertices.reserve(sliceCount * 4 * 10);
+        for (int i = 0; i < sliceCount; ++i) {
+            const auto & rect = rects[i];
+            const float left = std::max(0.0f, rect.left), right = std::min(1.0f, rect.right), top = std::max(0.0f, rect.top), bottom = std::min(1.0f, rect.bottom);
+            if (left >= right || top >= bottom) {
+                continue;
+            }
+            const float depth = static_cast<float>(i) / sliceCount;
+            for (const auto & corner : {std::make_pair(left, bottom), std::make_pair(right, bottom), std::make_pair(right, top), std::make_pair(left, top)}) {
+                vertices.insert(std::end(vertices), {2.0f * corner.first - 1.0f, 1.0f - 2.0f * corner.second, 1.0f - depth * 2.0f, corner.first, corner.second, depth, depth, depth, depth, volume_opacity});
+            }
+        }
+
         glEnable(GL_DEPTH_TEST);
         glEnable(GL_TEXTURE_3D);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         glBindTexture(GL_TEXTURE_3D, volTexId);
-        float volume_opacity = seg.volume_opacity / 255.0f;
-        for(int i = 0; i < texLen * volumeClippingAdjust * maxScaleRatio; ++i) {
-            float depth = i/(texLen * volumeClippingAdjust * maxScaleRatio);
-            glColor4f(depth, depth, depth, volume_opacity);
-            glBegin(GL_QUADS);
-                glTexCoord3f(0.0f, 1.0f, depth);
-                glVertex3f(-1.0f, -1.0f,  1.0f-depth*2.0f);
-                glTexCoord3f(1.0f, 1.0f, depth);
-                glVertex3f( 1.0f, -1.0f,  1.0f-depth*2.0f);
-                glTexCoord3f(1.0f, 0.0f, depth);
-                glVertex3f( 1.0f,  1.0f,  1.0f-depth*2.0f);
-                glTexCoord3f(0.0f, 0.0f, depth);
-                glVertex3f(-1.0f,  1.0f,  1.0f-depth*2.0f);
-            glEnd();
+        if (!vertices.empty()) {
+            if (!volumeSliceBuffer.isCreated()) {
+                volumeSliceBuffer.create();
+                volumeSliceBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+            }
+            volumeSliceBuffer.bind();
+            volumeSliceBuffer.allocate(vertices.data(), vertices.size() * sizeof(GLfloat));
+            const auto stride = 10 * sizeof(GLfloat);
+            glEnableClientState(GL_VERTEX_ARRAY);
+            glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+            glEnableClientState(GL_COLOR_ARRAY);
+            glVertexPointer(3, GL_FLOAT, stride, reinterpret_cast<const GLvoid *>(0));
+            glTexCoordPointer(3, GL_FLOAT, stride, reinterpret_cast<const GLvoid *>(3 * sizeof(GLfloat)));
+            glColorPointer(4, GL_FLOAT, stride, reinterpret_cast<const GLvoid *>(6 * sizeof(GLfloat)));
+            glDrawArrays(GL_QUADS, 0, vertices.size() / 10);
+            glDisableClientState(GL_COLOR_ARRAY);
+            glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+            glDisableClientState(GL_VERTEX_ARRAY);
+            volumeSliceBuffer.release();
         }
 
         glMatrixMode(GL_TEXTURE);
@@ -932,6 +1017,12 @@ void Viewport3D::renderVolumeVP() {
         glDisable(GL_LIGHTING);
         glDisable(GL_DEPTH_TEST);
 
+        if (queryPass) {
+            volumePassQuery.end();
+            volumePassQueryPending = true;
+        } else if (!volumePassQuerySupport.get()) {
+            volumePassMs = volumePassTimer.nsecsElapsed() / 1e6;
+        }
         render_profiler.end(); // ----------------------------------------------------------- profiling
 
         // --------------------- display some profiling information ------------------------
@@ -1172,8 +1263,7 @@ void Viewport3D::pickMeshIdAtPosition() {
 }
 
 void Viewport3D::renderSkeletonVP(const RenderOptions &options) {
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
+    loadProjection();
     glEnable(GL_MULTISAMPLE);
     const auto zoomedHalfBoundary = 0.5 * state->skeletonState->volBoundary / zoomFactor;
     const auto scaledBoundary = state->scale.componentMul(state->boundary);
@@ -1190,7 +1280,7 @@ void Viewport3D::renderSkeletonVP(const RenderOptions &options) {
 
     std::array<GLint, 4> vp;
     glGetIntegerv(GL_VIEWPORT, vp.data());
-    edgeLength = vp[2];// retrieve adjusted size for snapshot
+    edgeLength = std::round(vp[2] * tileScale);// retrieve adjusted size for snapshot
     screenPxXPerDataPx = edgeLength / (2.0 * zoomedHalfBoundary);
     displayedlengthInNmX = edgeLength / screenPxXPerDataPx;
 
@@ -83,7 +83,7 @@ SnapshotWidget::SnapshotWidget(QWidget *parent) : DialogVisibilityNotify(SNAPSHO
 
     QObject::connect(&snapshotButton, &QPushButton::clicked, [this]() {
         state->viewerState->renderInterval = SLOW;
-        const auto path = QFileDialog::getSaveFileName(this, tr("Save path"), saveDir + defaultFilename(), tr("Images (*.png *.xpm *.xbm *.jpg *.bmp)"));
+        const auto path = QFileDialog::getSaveFileName(this, tr("Save path"), saveDir + defaultFilename(), tr("Images (*.png *.tif *.tiff *.xpm *.xbm *.jpg *.bmp)"));
         state->viewerState->renderInterval = FAST;
         if(path.isEmpty() == false) {
             QFileInfo info(path);
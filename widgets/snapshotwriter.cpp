@@ -0,0 +1,287 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#include "snapshotwriter.h"
+
+#include <QFileInfo>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <array>
+
+namespace {
+void putLE16(QByteArray & bytes, const std::uint32_t value) {
+    bytes.append(static_cast<char>(value & 0xFF));
+    bytes.append(static_cast<char>((value >> 8) & 0xFF));
+}
+
+void putLE32(QByteArray & bytes, const std::uint32_t value) {
+    putLE16(bytes, value & 0xFFFF);
+    putLE16(bytes, value >> 16);
+}
+
+void putBE32(QByteArray & bytes, const std::uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        bytes.append(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+void appendRgb(QByteArray & bytes, const QImage & band, const int y) {
+    const auto * pixels = reinterpret_cast<const QRgb *>(band.scanLine(y));
+    for (int x = 0; x < band.width(); ++x) {
+        bytes.append(static_cast<char>(qRed(pixels[x])));
+        bytes.append(static_cast<char>(qGreen(pixels[x])));
+        bytes.append(static_cast<char>(qBlue(pixels[x])));
+    }
+}
+}
+
+SnapshotWriter::SnapshotWriter(const QString & path, const int width, const int height) : path{path}, width{width}, height{height}, file{path} {
+    pool.setMaxThreadCount(1);
+    worker = QtConcurrent::run(&pool, [this](){ return write(); });
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    finish();
+}
+
+void SnapshotWriter::append(QImage band) {
+    QMutexLocker locker(&mutex);
+    while (bands.size() >= maxQueuedBands) {
+        changed.wait(&mutex);
+    }
+    bands.emplace_back(std::move(band));
+    changed.wakeAll();
+}
+
+bool SnapshotWriter::finish() {
+    {
+        QMutexLocker locker(&mutex);
+        closed = true;
+        changed.wakeAll();
+    }
+    return worker.result();
+}
+
+/**
+ * @brief chooses the format once the first band shows whether the image has to be streamed at all
+ */
+void SnapshotWriter::start(const bool singleBand) {
+    const auto suffix = QFileInfo(path).suffix().toLower();
+    format = singleBand ? Format::Assembled : suffix == "tif" || suffix == "tiff" ? Format::Tiff : suffix == "png" ? Format::Png : Format::Assembled;
+    if (format == Format::Assembled) {
+        assembled = QImage(width, height, QImage::Format_RGB32);
+        ok = !assembled.isNull();
+    } else {
+        ok = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    writeHeader();
+}
+
+bool SnapshotWriter::write() {
+    bool started = false;
+    while (true) {
+        QImage band;
+        {
+            QMutexLocker locker(&mutex);
+            while (bands.empty() && !closed) {
+                changed.wait(&mutex);
+            }
+            if (bands.empty()) {
+                break;
+            }
+            band = std::move(bands.front());
+            bands.pop_front();
+            changed.wakeAll();
+        }
+        if (!started) {
+            start(band.height() >= height);
+            started = true;
+        }
+        writeBand(band);// keep draining on errors, append would block otherwise
+    }
+    ok = started && ok && rowsWritten == height;
+    writeTrailer();
+    if (deflating) {
+        deflateEnd(&deflater);
+    }
+    if (file.isOpen()) {
+        file.close();
+        ok = ok && file.error() == QFileDevice::NoError;
+    }
+    return ok;
+}
+
+void SnapshotWriter::writeBytes(const char * data, const qint64 size) {
+    ok = ok && file.write(data, size) == size;
+}
+
+void SnapshotWriter::writePngChunk(const char * type, const QByteArray & data) {
+    QByteArray chunk;
+    putBE32(chunk, data.size());
+    chunk.append(type, 4);
+    chunk.append(data);
+    QByteArray crc;
+    putBE32(crc, ::crc32(0, reinterpret_cast<const Bytef *>(chunk.constData() + 4), chunk.size() - 4));
+    chunk.append(crc);
+    writeBytes(chunk.constData(), chunk.size());
+}
+
+/**
+ * @brief compresses the filtered rows of a band, every filled output buffer becomes an IDAT chunk
+ */
+void SnapshotWriter::deflateIntoPng(const QByteArray & raw, const bool last) {
+    std::vector<char> buffer(1 << 18);
+    deflater.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(raw.constData()));
+    deflater.avail_in = raw.size();
+    do {
+        deflater.next_out = reinterpret_cast<Bytef *>(buffer.data());
+        deflater.avail_out = buffer.size();
+        if (deflate(&deflater, last ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR) {
+            ok = false;
+            return;
+        }
+        const auto size = buffer.size() - deflater.avail_out;
+        if (size != 0) {
+            writePngChunk("IDAT", QByteArray::fromRawData(buffer.data(), size));
+        }
+    } while (deflater.avail_out == 0);
+}
+
+void SnapshotWriter::writeHeader() {
+    if (!ok) {
+        return;
+    }
+    if (format == Format::Tiff) {
+        QByteArray header("II");
+        putLE16(header, 42);
+        putLE32(header, 0);// ifd offset, patched in writeTrailer
+        writeBytes(header.constData(), header.size());
+    } else if (format == Format::Png) {
+        writeBytes("\x89PNG\r\n\x1a\n", 8);
+        QByteArray ihdr;
+        putBE32(ihdr, width);
+        putBE32(ihdr, height);
+        ihdr.append(static_cast<char>(8));// bit depth
+        ihdr.append(static_cast<char>(2));// truecolor
+        ihdr.append(3, static_cast<char>(0));// deflate, adaptive filtering, no interlace
+        writePngChunk("IHDR", ihdr);
+        deflating = deflateInit(&deflater, Z_DEFAULT_COMPRESSION) == Z_OK;
+        ok = ok && deflating;
+    }
+}
+
+void SnapshotWriter::writeBand(const QImage & band) {
+    const auto rows = std::min(band.height(), height - rowsWritten);
+    if (!ok || rows <= 0 || band.width() != width) {
+        ok = false;
+        return;
+    }
+    if (format == Format::Assembled) {
+        for (int y = 0; y < rows; ++y) {
+            std::copy(band.scanLine(y), band.scanLine(y) + 4 * width, assembled.scanLine(rowsWritten + y));
+        }
+    } else if (format == Format::Tiff) {
+        QByteArray strip;
+        strip.reserve(3 * width * rows);
+        for (int y = 0; y < rows; ++y) {
+            appendRgb(strip, band, y);
+        }
+        if (stripOffsets.empty()) {
+            rowsPerStrip = rows;
+        }
+        stripOffsets.emplace_back(file.pos());
+        stripByteCounts.emplace_back(strip.size());
+        writeBytes(strip.constData(), strip.size());
+    } else {
+        QByteArray raw;
+        raw.reserve((1 + 3 * width) * rows);
+        for (int y = 0; y < rows; ++y) {
+            raw.append(static_cast<char>(0));// filter type none
+            appendRgb(raw, band, y);
+        }
+        deflateIntoPng(raw, rowsWritten + rows == height);
+    }
+    rowsWritten += rows;
+}
+
+void SnapshotWriter::writeTrailer() {
+    if (!ok) {
+        return;
+    }
+    if (format == Format::Assembled) {
+        ok = assembled.save(path);
+    } else if (format == Format::Png) {
+        writePngChunk("IEND", {});
+    } else {
+        if (file.pos() % 2 != 0) {
+            writeBytes("", 1);// tiff offsets are word aligned
+        }
+        const std::uint32_t bitsPerSampleOffset = file.pos();
+        const std::uint32_t resolutionOffset = bitsPerSampleOffset + 6;
+        const std::uint32_t stripOffsetsOffset = resolutionOffset + 8;
+        const std::uint32_t stripByteCountsOffset = stripOffsetsOffset + 4 * stripOffsets.size();
+        const std::uint32_t ifdOffset = stripByteCountsOffset + 4 * stripByteCounts.size();
+        QByteArray trailer;
+        for (int sample = 0; sample < 3; ++sample) {
+            putLE16(trailer, 8);
+        }
+        putLE32(trailer, 72);// 72 dpi
+        putLE32(trailer, 1);
+        for (const auto offset : stripOffsets) {
+            putLE32(trailer, offset);
+        }
+        for (const auto count : stripByteCounts) {
+            putLE32(trailer, count);
+        }
+        const bool singleStrip = stripOffsets.size() == 1;// values fitting into 4 bytes are stored inside the entry
+        enum : std::uint16_t { SHORT = 3, LONG = 4, RATIONAL = 5 };
+        const std::array<std::array<std::uint32_t, 4>, 13> entries{{
+            {{256, LONG, 1, static_cast<std::uint32_t>(width)}},
+            {{257, LONG, 1, static_cast<std::uint32_t>(height)}},
+            {{258, SHORT, 3, bitsPerSampleOffset}},
+            {{259, SHORT, 1, 1}},// no compression
+            {{262, SHORT, 1, 2}},// rgb
+            {{273, LONG, static_cast<std::uint32_t>(stripOffsets.size()), singleStrip ? stripOffsets.front() : stripOffsetsOffset}},
+            {{277, SHORT, 1, 3}},// samples per pixel
+            {{278, LONG, 1, static_cast<std::uint32_t>(rowsPerStrip)}},
+            {{279, LONG, static_cast<std::uint32_t>(stripByteCounts.size()), singleStrip ? stripByteCounts.front() : stripByteCountsOffset}},
+            {{282, RATIONAL, 1, resolutionOffset}},
+            {{283, RATIONAL, 1, resolutionOffset}},
+            {{284, SHORT, 1, 1}},// chunky
+            {{296, SHORT, 1, 2}},// inch
+        }};
+        putLE16(trailer, entries.size());
+        for (const auto & entry : entries) {
+            putLE16(trailer, entry[0]);
+            putLE16(trailer, entry[1]);
+            putLE32(trailer, entry[2]);
+            putLE32(trailer, entry[3]);// shorts are left aligned, which little endian gives for free
+        }
+        putLE32(trailer, 0);// no further ifd
+        writeBytes(trailer.constData(), trailer.size());
+        QByteArray header;
+        putLE32(header, ifdOffset);
+        ok = ok && file.seek(4);
+        writeBytes(header.constData(), header.size());
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ *  This file is a part of KNOSSOS.
+ *
+ *  (C) Copyright 2007-2016
+ *  Max-Planck-Gesellschaft zur Foerderung der Wissenschaften e.V.
+ *
+ *  KNOSSOS is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 of
+ *  the License as published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ *  For further information, visit https://knossostool.org
+ *  or contact knossos-team@mpimf-heidelberg.mpg.de
+ */
+
+#ifndef SNAPSHOTWRITER_H
+#define SNAPSHOTWRITER_H
+
+#include <QFile>
+#include <QFuture>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * @brief Writes an image band by band on a worker thread, so a snapshot never has to exist in memory as a whole.
+ *
+ * Bands are horizontal stripes of the final image in top to bottom order (QImage::Format_RGB32, full width).
+ * .tif/.tiff is written as an uncompressed baseline tiff with one strip per band,
+ * .png as a png whose bands are streamed through one zlib deflate stream.
+ * All other formats and snapshots arriving as a single band are assembled into one image and handed to QImage::save at the end.
+ */
+class SnapshotWriter {
+    enum class Format { Tiff, Png, Assembled };
+    const QString path;
+    const int width;
+    const int height;
+    Format format;
+    QFile file;
+    bool ok{true};
+    int rowsWritten{0};
+    // tiff
+    std::vector<std::uint32_t> stripOffsets;
+    std::vector<std::uint32_t> stripByteCounts;
+    int rowsPerStrip{0};
+    // png
+    z_stream deflater{};
+    bool deflating{false};
+    // everything else
+    QImage assembled;
+
+    static constexpr std::size_t maxQueuedBands = 2;
+    QMutex mutex;
+    QWaitCondition changed;
+    std::deque<QImage> bands;
+    bool closed{false};
+    QThreadPool pool;// single worker
+    QFuture<bool> worker;
+
+    bool write();
+    void start(const bool singleBand);
+    void writeBand(const QImage & band);
+    void writeBytes(const char * data, const qint64 size);
+    void writeHeader();
+    void writeTrailer();
+    void writePngChunk(const char * type, const QByteArray & data);
+    void deflateIntoPng(const QByteArray & raw, const bool last);
+public:
+    SnapshotWriter(const QString & path, const int width, const int height);
+    ~SnapshotWriter();
+    /** @brief Queues the next band, blocks while the worker is behind by more than a few bands. */
+    void append(QImage band);
+    /** @brief Waits for all queued bands to be written and returns wether the file was written successfully. */
+    bool finish();
+};
+
+#endif// SNAPSHOTWRITER_H
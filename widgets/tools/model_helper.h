@@ -37,6 +37,13 @@ template<typename Elem>
 Elem & getElem(const std::reference_wrapper<Elem> & elem) {
     return elem.get();
 }
+template<typename Elem>
+bool isElemSelected(const Elem & elem) {
+    return getElem(elem).selected;
+}
+inline bool isElemSelected(const bool selected) {// selection column
+    return selected;
+}
 
 auto deltaBlockSelection = [](const auto & model, const auto & data, const auto isAlreadySelected, const bool inverter = false){
     QItemSelection selectedItems;
@@ -45,9 +52,9 @@ auto deltaBlockSelection = [](const auto & model, const auto & data, const auto
     std::size_t blockStartIndex{0};
 
     std::size_t rowIndex{0};
-    for (auto & elem : data) {
+    for (auto && elem : data) {
         const auto alreadySelected = isAlreadySelected(rowIndex) ? !inverter : inverter;
-        const auto selected = getElem(elem).selected ? !inverter : inverter;
+        const auto selected = isElemSelected(elem) ? !inverter : inverter;
         if (!blockSelection && selected && !alreadySelected) {// start block selection
             blockSelection = true;
             blockStartIndex = rowIndex;
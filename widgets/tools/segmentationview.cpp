@@ -55,17 +55,19 @@ int TouchedObjectModel::rowCount(const QModelIndex &) const {
 
 QVariant TouchedObjectModel::data(const QModelIndex & index, int role) const {
     if (index.isValid()) {
-        //http://coliru.stacked-crooked.com/a/98276b01d551fb41
-        const auto & obj = objectCache[index.row()].get();
-        return objectGet(obj, index, role);
+        if (const auto objectIndex = Segmentation::singleton().objectIndex(objectCache[index.row()])) {//the object may be gone already
+            return objectGet(objectIndex.get(), index, role);
+        }
     }
     return QVariant();//return invalid QVariant
 }
 
 bool TouchedObjectModel::setData(const QModelIndex & index, const QVariant & value, int role) {
     if (index.isValid()) {
-        auto & obj = objectCache[index.row()].get();
-        return objectSet(obj, index, value, role);
+        if (const auto objectIndex = Segmentation::singleton().objectIndex(objectCache[index.row()])) {
+            return objectSet(objectIndex.get(), index, value, role);
+        }
+        return false;
     }
     return true;
 }
@@ -92,28 +94,30 @@ QVariant SegmentationObjectModel::headerData(int section, Qt::Orientation orient
     }
 }
 
-QVariant SegmentationObjectModel::objectGet(const Segmentation::Object &obj, const QModelIndex & index, int role) const {
+QVariant SegmentationObjectModel::objectGet(const uint64_t objectIndex, const QModelIndex & index, int role) const {
+    const auto & objects = Segmentation::singleton().objects;
     if (index.column() == 0 && (role == Qt::BackgroundRole || role == Qt::DecorationRole)) {
-        const auto color = Segmentation::singleton().colorObjectFromIndex(obj.index);
+        const auto color = Segmentation::singleton().colorObjectFromIndex(objectIndex);
         return QColor(std::get<0>(color), std::get<1>(color), std::get<2>(color));
     } else if (index.column() == 2 && role == Qt::CheckStateRole) {
-        return (obj.immutable ? Qt::Checked : Qt::Unchecked);
+        return (objects.immutable[objectIndex] ? Qt::Checked : Qt::Unchecked);
     } else if (role == Qt::DisplayRole || role == Qt::EditRole) {
+        const auto subobjects = objects.subobjects(objectIndex);
         switch (index.column()) {
-        case 1: return static_cast<quint64>(obj.id);
-        case 3: return obj.category;
-        case 4: return obj.comment;
-        case 5: return static_cast<quint64>(obj.subobjects.size());
+        case 1: return static_cast<quint64>(objects.id[objectIndex]);
+        case 3: return Segmentation::singleton().categories[objects.category[objectIndex]];
+        case 4: return objects.comment[objectIndex];
+        case 5: return static_cast<quint64>(subobjects.size());
         case 6: {
             QString output;
-            const auto elemCount = std::min(MAX_SHOWN_SUBOBJECTS, obj.subobjects.size());
-            auto subobjectIt = std::begin(obj.subobjects);
+            const auto elemCount = std::min(MAX_SHOWN_SUBOBJECTS, subobjects.size());
+            auto subobjectIt = std::begin(subobjects);
             for (std::size_t i = 0; i < elemCount; ++i) {
-                output += QString::number(subobjectIt->get().id) + ", ";
+                output += QString::number((*subobjectIt)->id) + ", ";
                 subobjectIt = std::next(subobjectIt);
             }
             output.chop(2);
-            output += (obj.subobjects.size() > MAX_SHOWN_SUBOBJECTS) ? "…" : "";;
+            output += (subobjects.size() > MAX_SHOWN_SUBOBJECTS) ? "…" : "";;
             return output;
         }
         }
@@ -123,30 +127,29 @@ QVariant SegmentationObjectModel::objectGet(const Segmentation::Object &obj, con
 
 QVariant SegmentationObjectModel::data(const QModelIndex & index, int role) const {
     if (index.isValid()) {
-        const auto & obj = Segmentation::singleton().objects[index.row()];
-        return objectGet(obj, index, role);
+        return objectGet(index.row(), index, role);
     }
     return QVariant();//return invalid QVariant
 }
 
-bool SegmentationObjectModel::objectSet(Segmentation::Object & obj, const QModelIndex & index, const QVariant & value, int role) {
+bool SegmentationObjectModel::objectSet(const uint64_t objectIndex, const QModelIndex & index, const QVariant & value, int role) {
     if (index.column() == 2 && role == Qt::CheckStateRole) {
         QMessageBox prompt;
         prompt.setWindowFlags(Qt::WindowStaysOnTopHint);
         prompt.setIcon(QMessageBox::Question);
-        const auto lock = obj.immutable ? tr("Unlock") : tr("Lock");
+        const auto lock = Segmentation::singleton().objects.immutable[objectIndex] ? tr("Unlock") : tr("Lock");
         prompt.setWindowTitle(lock + tr(" Object"));
-        prompt.setText(lock + tr(" the object with id %1?").arg(obj.id));
+        prompt.setText(lock + tr(" the object with id %1?").arg(Segmentation::singleton().objects.id[objectIndex]));
         const auto & lockButton = prompt.addButton(lock, QMessageBox::YesRole);
         prompt.addButton(tr("Cancel"), QMessageBox::NoRole);
         prompt.exec();
         if (prompt.clickedButton() == lockButton) {
-            obj.immutable = value.toBool();
+            Segmentation::singleton().changeImmutable(objectIndex, value.toBool());
         }
     } else if (role == Qt::DisplayRole || role == Qt::EditRole) {
         switch (index.column()) {
-        case 3: Segmentation::singleton().changeCategory(obj, value.toString()); break;
-        case 4: Segmentation::singleton().changeComment(obj, value.toString()); break;
+        case 3: Segmentation::singleton().changeCategory(objectIndex, value.toString()); break;
+        case 4: Segmentation::singleton().changeComment(objectIndex, value.toString()); break;
         default:
             return false;
         }
@@ -156,8 +159,7 @@ bool SegmentationObjectModel::objectSet(Segmentation::Object & obj, const QModel
 
 bool SegmentationObjectModel::setData(const QModelIndex & index, const QVariant & value, int role) {
     if (index.isValid()) {
-        auto & obj = Segmentation::singleton().objects[index.row()];
-        return objectSet(obj, index, value, role);
+        return objectSet(index.row(), index, value, role);
     }
     return true;
 }
@@ -336,8 +338,8 @@ SegmentationView::SegmentationView(QWidget * const parent) : QWidget(parent), ca
     QObject::connect(&Segmentation::singleton(), &Segmentation::beforeRemoveRow, [this](){
         objectSelectionProtection = true;
         objectModel.popRowBegin();
-        if (Segmentation::singleton().objects.back().selected) {
-            const auto index = Segmentation::singleton().objects.back().index;
+        if (Segmentation::singleton().objects.selected.back()) {
+            const auto index = Segmentation::singleton().objects.size() - 1;
             const auto & proxyIndex = objectProxyModelComment.mapFromSource(objectProxyModelCategory.mapFromSource(objectModel.index(index, 0)));
             objectsTable.selectionModel()->select(proxyIndex, QItemSelectionModel::Deselect | QItemSelectionModel::Rows);
         }
@@ -349,8 +351,8 @@ SegmentationView::SegmentationView(QWidget * const parent) : QWidget(parent), ca
     QObject::connect(&Segmentation::singleton(), &Segmentation::appendedRow, [this](){
         objectSelectionProtection = true;
         objectModel.appendRow();
-        if (Segmentation::singleton().objects.back().selected) {
-            const auto index = Segmentation::singleton().objects.back().index;
+        if (Segmentation::singleton().objects.selected.back()) {
+            const auto index = Segmentation::singleton().objects.size() - 1;
             const auto & proxyIndex = objectProxyModelComment.mapFromSource(objectProxyModelCategory.mapFromSource(objectModel.index(index, 0)));
             objectsTable.selectionModel()->setCurrentIndex(proxyIndex, QItemSelectionModel::Select | QItemSelectionModel::Rows);
         }
@@ -375,9 +377,9 @@ SegmentationView::SegmentationView(QWidget * const parent) : QWidget(parent), ca
             const auto & proxyIndex = objectProxyModelComment.mapFromSource(objectProxyModelCategory.mapFromSource(objectModel.index(index, 0)));
             //selection lookup is way cheaper than reselection (sadly)
             const bool alreadySelected = objectsTable.selectionModel()->isSelected(proxyIndex);
-            if (Segmentation::singleton().objects[index].selected && !alreadySelected) {
+            if (Segmentation::singleton().objects.selected[index] && !alreadySelected) {
                 objectsTable.selectionModel()->setCurrentIndex(proxyIndex, QItemSelectionModel::Select | QItemSelectionModel::Rows);
-            } else if (!Segmentation::singleton().objects[index].selected && alreadySelected) {
+            } else if (!Segmentation::singleton().objects.selected[index] && alreadySelected) {
                 objectsTable.selectionModel()->setCurrentIndex(proxyIndex, QItemSelectionModel::Deselect | QItemSelectionModel::Rows);
             }
             touchedObjectModel.recreate();
@@ -408,7 +410,7 @@ SegmentationView::SegmentationView(QWidget * const parent) : QWidget(parent), ca
         if (overlapObjIndices.empty() == false) {
              text += " (part of: ";
             for (const uint64_t index : overlapObjIndices) {
-                text += QString::number(Segmentation::singleton().objects[index].id) + ", ";
+                text += QString::number(Segmentation::singleton().objects.id[index]) + ", ";
             }
             text.chop(2);
             text += ")";
@@ -422,9 +424,11 @@ SegmentationView::SegmentationView(QWidget * const parent) : QWidget(parent), ca
             colorDialog.setCurrentColor(table.model()->data(index, Qt::BackgroundRole).value<QColor>());
             state->viewerState->renderInterval = SLOW;
             if (colorDialog.exec() == QColorDialog::Accepted) {
-                auto & obj = (&table == &objectsTable) ? Segmentation::singleton().objects[index.row()] : touchedObjectModel.objectCache[index.row()].get();
+                const auto objectIndex = (&table == &objectsTable) ? boost::make_optional<uint64_t>(index.row()) : Segmentation::singleton().objectIndex(touchedObjectModel.objectCache[index.row()]);
                 auto color = colorDialog.currentColor();
-                Segmentation::singleton().changeColor(obj, std::make_tuple(color.red(), color.green(), color.blue()));
+                if (objectIndex) {//a touched object may have been removed while the dialog was open
+                    Segmentation::singleton().changeColor(objectIndex.get(), std::make_tuple(color.red(), color.green(), color.blue()));
+                }
             }
             state->viewerState->renderInterval = FAST;
         }
@@ -518,7 +522,7 @@ void SegmentationView::touchedObjSelectionChanged(const QItemSelection & selecte
         commitSelection(QItemSelection{}, objectsTable.selectionModel()->selection());
     }
     commitSelection(selected, deselected, [this](const int & i){
-        return touchedObjectModel.objectCache[i].get().index;
+        return indexFromRow(touchedObjectModel, touchedObjectModel.index(i, 0));
     });
     updateSelection();
 }
@@ -533,7 +537,12 @@ void SegmentationView::selectionChanged(const QItemSelection & selected, const Q
 }
 
 void SegmentationView::updateTouchedObjSelection() {
-    const auto & selectedItems = blockSelection(touchedObjectModel, touchedObjectModel.objectCache);
+    std::vector<bool> touchedSelected;
+    for (const auto & handle : touchedObjectModel.objectCache) {
+        const auto objectIndex = Segmentation::singleton().objectIndex(handle);
+        touchedSelected.emplace_back(objectIndex && Segmentation::singleton().objects.selected[objectIndex.get()]);
+    }
+    const auto & selectedItems = blockSelection(touchedObjectModel, touchedSelected);
 
     touchedObjectSelectionProtection = true;//using block signals prevents update of the tableview
     touchedObjsTable.selectionModel()->select(selectedItems, QItemSelectionModel::ClearAndSelect);
@@ -541,7 +550,7 @@ void SegmentationView::updateTouchedObjSelection() {
 }
 
 void SegmentationView::updateSelection() {
-    const auto & selectedItems = blockSelection(objectModel, Segmentation::singleton().objects);
+    const auto & selectedItems = blockSelection(objectModel, Segmentation::singleton().objects.selected);
     const auto & proxySelection = objectProxyModelComment.mapSelectionFromSource(objectProxyModelCategory.mapSelectionFromSource(selectedItems));
 
     objectSelectionProtection = true;//using block signals prevents update of the tableview
@@ -573,5 +582,6 @@ uint64_t SegmentationView::indexFromRow(const SegmentationObjectModel &, const Q
     return objectProxyModelCategory.mapSelectionToSource(objectProxyModelComment.mapSelectionToSource({index, index})).indexes().front().row();
 }
 uint64_t SegmentationView::indexFromRow(const TouchedObjectModel & model, const QModelIndex index) const {
-    return model.objectCache[index.row()].get().index;
+    //the cache is recreated on every row change, so its handles are valid
+    return Segmentation::singleton().objectIndex(model.objectCache[index.row()]).get();
 }
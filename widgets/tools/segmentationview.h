@@ -62,9 +62,9 @@ public:
     virtual int rowCount(const QModelIndex & parent = QModelIndex()) const override;
     virtual int columnCount(const QModelIndex & parent = QModelIndex()) const override;
     virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
-    QVariant objectGet(const Segmentation::Object & obj, const QModelIndex & index, int role) const;
+    QVariant objectGet(const uint64_t objectIndex, const QModelIndex & index, int role) const;
     virtual QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
-    bool objectSet(Segmentation::Object & obj, const QModelIndex & index, const QVariant & value, int role);
+    bool objectSet(const uint64_t objectIndex, const QModelIndex & index, const QVariant & value, int role);
     virtual bool setData(const QModelIndex & index, const QVariant & value, int role = Qt::EditRole) override;
     virtual Qt::ItemFlags flags(const QModelIndex & index) const override;
     void recreate();
@@ -78,7 +78,7 @@ public:
 class TouchedObjectModel : public SegmentationObjectModel {
     Q_OBJECT
 public:
-    std::vector<std::reference_wrapper<Segmentation::Object>> objectCache;
+    std::vector<Segmentation::ObjectHandle> objectCache;
     virtual int rowCount(const QModelIndex & parent = QModelIndex()) const override;
     virtual QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
     virtual bool setData(const QModelIndex & index, const QVariant & value, int role = Qt::EditRole) override;
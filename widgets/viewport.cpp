@@ -30,17 +30,28 @@
 #include "segmentation/cubeloader.h"
 #include "segmentation/segmentation.h"
 #include "skeleton/skeletonizer.h"
+#include "slicer/rawslice.h"
+#include "slicer/volumeslice.h"
+#include "widgets/snapshotwriter.h"
 #include "viewer.h"
 
 #include <QApplication>
 #include <QHBoxLayout>
 #include <QMenu>
+#include <QMutexLocker>
 #include <QOpenGLFramebufferObject>
 #include <QPainter>
 #include <QPushButton>
+#include <QtConcurrent>
 #include <QVBoxLayout>
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
 bool ViewportBase::oglDebug = false;
+constexpr int ViewportBase::snapshotTileEdge;
 bool Viewport3D::showBoundariesInUm = false;
 bool ViewportOrtho::showNodeComments = false;
 
@@ -293,6 +304,7 @@ ViewportOrtho::ViewportOrtho(QWidget *parent, ViewportType viewportType) : Viewp
 
 ViewportOrtho::~ViewportOrtho() {
     makeCurrent();
+    textureStream.destroy();
     if (texture.texHandle != 0) {
         glDeleteTextures(1, &texture.texHandle);
     }
@@ -313,10 +325,18 @@ void ViewportOrtho::mousePressEvent(QMouseEvent *event) {
 }
 
 void ViewportOrtho::resetTexture() {
+    dcRingValid = ocRingValid = false;
     if (texture.texHandle != 0) {
         glBindTexture(GL_TEXTURE_2D, texture.texHandle);
         std::vector<char> texData(static_cast<std::size_t>(3 * std::pow(texture.size, 2)));// RGB
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, texture.size, texture.size, 0, GL_RGB, GL_UNSIGNED_BYTE, texData.data());
+        // the ring’s cube slots are mipmapped individually, the arb texture is resampled as a whole
+        texture.mipLevels = viewportType == VIEWPORT_ARBITRARY ? 0 : RawSlice::mipLevels(state->cubeEdgeLength);
+        for (int level = 1; level <= texture.mipLevels; ++level) {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGB, texture.size >> level, texture.size >> level, 0, GL_RGB, GL_UNSIGNED_BYTE, texData.data());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.mipLevels);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.minFilter());
     }
     if (texture.overlayHandle != 0) {
         glBindTexture(GL_TEXTURE_2D, texture.overlayHandle);
@@ -390,11 +410,14 @@ Viewport3D::Viewport3D(QWidget *parent, ViewportType viewportType) : ViewportBas
         if (wiggle == -2 || wiggle == 2) {
             wiggleDirection = !wiggleDirection;
         }
+        state->viewer->postDamage();
     });
 }
 
 Viewport3D::~Viewport3D() {
     makeCurrent();
+    volumeStream.destroy();
+    volumePassQuery.destroy();
     if (Segmentation::singleton().volume_tex_id != 0) {
         glDeleteTextures(1, &Segmentation::singleton().volume_tex_id);
     }
@@ -589,10 +612,12 @@ void ViewportOrtho::initializeGL() {
 
     glBindTexture(GL_TEXTURE_2D, texture.texHandle);
 
+    // orthogonal textures are ring buffers, their texture coordinates wrap around
+    const GLint wrap = viewportType == VIEWPORT_ARBITRARY ? GL_CLAMP_TO_BORDER : GL_REPEAT;
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture.textureFilter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.textureFilter);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
 
     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
 
@@ -603,8 +628,8 @@ void ViewportOrtho::initializeGL() {
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
 
     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
 
@@ -655,15 +680,39 @@ void ViewportOrtho::initializeGL() {
         #version 110
         uniform float textureOpacity;
         uniform sampler3D indexTexture;
-        uniform sampler1D textureLUT;
-        uniform float lutSize;//float(textureSize1D(textureLUT, 0));
-        uniform float factor;//expand float to uint8 range
+        uniform sampler2D palette;
+        uniform sampler2D objects;//largest object + 1 and selection per palette slot
+        uniform vec2 paletteSize;//vec2(textureSize2D(palette, 0));
+        uniform vec3 texelStepX;//one voxel along the viewport axes in texture coordinates
+        uniform vec3 texelStepY;
+        uniform float hoveredObject;//object index + 1, 0 if only selected objects are outlined
         varying vec3 texCoordFrag;//in
+        vec2 paletteCoord(vec3 texCoord) {
+            vec3 bytes = floor(texture3D(indexTexture, texCoord).rgb * 255.0 + 0.5);//24 bit palette slot, little endian
+            float column = bytes.r + 256.0 * mod(bytes.g, paletteSize.x / 256.0);
+            float row = floor(bytes.g / (paletteSize.x / 256.0)) + bytes.b * (65536.0 / paletteSize.x);
+            return (vec2(column, row) + 0.5) / paletteSize;
+        }
+        float objectOf(vec2 slot) {
+            vec3 bytes = floor(texture2D(objects, slot).rgb * 255.0 + 0.5);
+            return bytes.r + 256.0 * bytes.g + 65536.0 * bytes.b;
+        }
+        bool differs(vec2 center, vec3 texCoord) {//subobject edges, or object edges while hovering
+            vec2 neighbor = paletteCoord(texCoord);
+            return hoveredObject > 0.0 ? objectOf(neighbor) != objectOf(center) : neighbor != center;
+        }
         void main() {
-            float index = texture3D(indexTexture, texCoordFrag).r;
-            index *= factor;
-            gl_FragColor = texture1D(textureLUT, (index + 0.5) / lutSize);
-            gl_FragColor.a = textureOpacity;
+            vec2 slot = paletteCoord(texCoordFrag);
+            vec4 color = texture2D(palette, slot);
+            gl_FragColor = vec4(color.rgb, color.a > 0.0 ? textureOpacity : 0.0);//background and hidden objects are transparent
+            bool selected = texture2D(objects, slot).a > 0.5;
+            if (selected && (hoveredObject == 0.0 || objectOf(slot) == hoveredObject)) {
+                bool edge = differs(slot, texCoordFrag - texelStepX) || differs(slot, texCoordFrag + texelStepX)
+                        || differs(slot, texCoordFrag - texelStepY) || differs(slot, texCoordFrag + texelStepY);
+                if (edge) {
+                    gl_FragColor.a = min(1.0, 4.0 * gl_FragColor.a);
+                }
+            }
         })shaderSource");
 
         overlay_data_shader.link();
@@ -870,126 +919,147 @@ void Viewport3D::updateVolumeTexture() {
     int cubeLen = state->cubeEdgeLength;
     int M = state->M;
     int M_radius = (M - 1) / 2;
-    GLubyte* colcube = new GLubyte[4*texLen*texLen*texLen];
-    std::tuple<uint64_t, std::tuple<uint8_t, uint8_t, uint8_t, uint8_t>> lastIdColor;
-
-    state->protectCube2Pointer.lock();
-
-    dcfetch_profiler.start(); // ----------------------------------------------------------- profiling
-    uint64_t** rawcubes = new uint64_t*[M*M*M];
-    for(int z = 0; z < M; ++z)
-    for(int y = 0; y < M; ++y)
-    for(int x = 0; x < M; ++x) {
-        auto cubeIndex = z*M*M + y*M + x;
-        Coordinate cubeCoordRelative{x - M_radius, y - M_radius, z - M_radius};
-        rawcubes[cubeIndex] = reinterpret_cast<uint64_t*>(
-            Coordinate2BytePtr_hash_get_or_fail(state->Oc2Pointer[int_log(state->magnification)],
-            {currentPosDc.x + cubeCoordRelative.x, currentPosDc.y + cubeCoordRelative.y, currentPosDc.z + cubeCoordRelative.z}));
-    }
-    dcfetch_profiler.end(); // ----------------------------------------------------------- profiling
-
-    colorfetch_profiler.start(); // ----------------------------------------------------------- profiling
-
-    for(int z = 0; z < texLen; ++z)
-    for(int y = 0; y < texLen; ++y)
-    for(int x = 0; x < texLen; ++x) {
-        Coordinate DcCoord{(x * M)/cubeLen, (y * M)/cubeLen, (z * M)/cubeLen};
-        auto cubeIndex = DcCoord.z*M*M + DcCoord.y*M + DcCoord.x;
-        auto& rawcube = rawcubes[cubeIndex];
-
-        if(rawcube != nullptr) {
-            auto indexInDc  = ((z * M)%cubeLen)*cubeLen*cubeLen + ((y * M)%cubeLen)*cubeLen + (x * M)%cubeLen;
-            auto indexInTex = z*texLen*texLen + y*texLen + x;
-            auto subobjectId = rawcube[indexInDc];
-            if(subobjectId == std::get<0>(lastIdColor)) {
-                auto idColor = std::get<1>(lastIdColor);
-                colcube[4*indexInTex+0] = std::get<0>(idColor);
-                colcube[4*indexInTex+1] = std::get<1>(idColor);
-                colcube[4*indexInTex+2] = std::get<2>(idColor);
-                colcube[4*indexInTex+3] = std::get<3>(idColor);
-            } else if (seg.isSubObjectIdSelected(subobjectId)) {
-                auto idColor = seg.colorObjectFromSubobjectId(subobjectId);
-                std::get<3>(idColor) = 255; // ignore color alpha
-                colcube[4*indexInTex+0] = std::get<0>(idColor);
-                colcube[4*indexInTex+1] = std::get<1>(idColor);
-                colcube[4*indexInTex+2] = std::get<2>(idColor);
-                colcube[4*indexInTex+3] = std::get<3>(idColor);
-                lastIdColor = std::make_tuple(subobjectId, idColor);
-            } else {
-                colcube[4*indexInTex+0] = 0;
-                colcube[4*indexInTex+1] = 0;
-                colcube[4*indexInTex+2] = 0;
-                colcube[4*indexInTex+3] = 0;
+    const auto volumeBytes = std::size_t{4} * texLen * texLen * texLen;
+    // the volume is built from bricks, only bricks containing changed voxels or recoloured subobjects are sampled again
+    const auto bricksPerAxis = VolumeSlice::bricksPerAxis(texLen);
+    const auto brickCount = bricksPerAxis * bricksPerAxis * bricksPerAxis;
+    std::vector<char> resample(brickCount, false);
+    const bool partial = seg.volume_update_partial.exchange(false) && volumeBase.size() == volumeBytes && volumeOrigin == currentPosDc && volumeSupercubeEdge == M;
+    if (partial) {
+        // texel x samples voxel x * M of the supercube
+        const auto originVx = (currentPosDc - M_radius) * cubeLen;
+        for (const auto & region : seg.volume_dirty_regions) {
+            const auto firstVx = region.first / state->magnification - originVx;
+            const auto lastVx = region.second / state->magnification - originVx;
+            const auto ceilDiv = [M](const int value){ return value >= 0 ? (value + M - 1) / M : -(-value / M); };
+            const auto floorDiv = [M](const int value){ return value >= 0 ? value / M : -((-value + M - 1) / M); };
+            auto first = Coordinate{ceilDiv(firstVx.x), ceilDiv(firstVx.y), ceilDiv(firstVx.z)}.capped({0, 0, 0}, {texLen, texLen, texLen});
+            auto end = Coordinate{floorDiv(lastVx.x) + 1, floorDiv(lastVx.y) + 1, floorDiv(lastVx.z) + 1}.capped({0, 0, 0}, {texLen, texLen, texLen});
+            if (first.x < end.x && first.y < end.y && first.z < end.z) {// otherwise no sampled voxel changed
+                first = first / VolumeSlice::brickEdge;
+                end = (end - 1) / VolumeSlice::brickEdge;
+                for (int z = first.z; z <= end.z; ++z)
+                for (int y = first.y; y <= end.y; ++y)
+                for (int x = first.x; x <= end.x; ++x) {
+                    resample[(z * bricksPerAxis + y) * bricksPerAxis + x] = true;
+                }
             }
-        } else {
-            auto indexInTex = z*texLen*texLen + y*texLen + x;
-            colcube[4*indexInTex+0] = 0;
-            colcube[4*indexInTex+1] = 0;
-            colcube[4*indexInTex+2] = 0;
-            colcube[4*indexInTex+3] = 0;
         }
+        auto & recolored = seg.volume_recolor_ids;
+        std::sort(std::begin(recolored), std::end(recolored));
+        for (int brick = 0; brick < brickCount; ++brick) {
+            const auto & ids = volumeBrickIds[brick];
+            resample[brick] = resample[brick] || std::any_of(std::begin(ids), std::end(ids), [&recolored](const std::uint64_t id){
+                return std::binary_search(std::begin(recolored), std::end(recolored), id);
+            });
+        }
+    } else {
+        volumeBase.resize(volumeBytes);
+        volumeOrigin = currentPosDc;
+        volumeSupercubeEdge = M;
+        volumeBrickIds.assign(brickCount, {});
+        volumeOccupancy.assign(std::pow(VolumeSlice::cellsPerAxis(texLen), 3), false);
+        std::fill(std::begin(resample), std::end(resample), true);
+        glBindTexture(GL_TEXTURE_3D, seg.volume_tex_id);
+        glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA, texLen, texLen, texLen, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
     }
-
-    delete[] rawcubes;
-
-    state->protectCube2Pointer.unlock();
-
-    colorfetch_profiler.end(); // ----------------------------------------------------------- profiling
-
-    occlusion_profiler.start(); // ----------------------------------------------------------- profiling
-    for(int z = 1; z < texLen - 1; ++z)
-    for(int y = 1; y < texLen - 1; ++y)
-    for(int x = 1; x < texLen - 1; ++x) {
-        auto indexInTex = (z)*texLen*texLen + (y)*texLen + x;
-        if(colcube[4*indexInTex+3] != 0) {
-            for(int xi = -1; xi <= 1; ++xi) {
-                auto othrIndexInTex = (z)*texLen*texLen + (y)*texLen + x+xi;
-                if((xi != 0) && colcube[4*othrIndexInTex+3] != 0) {
-                    colcube[4*indexInTex+0] *= 0.95f;
-                    colcube[4*indexInTex+1] *= 0.95f;
-                    colcube[4*indexInTex+2] *= 0.95f;
-                }
+    seg.volume_dirty_regions.clear();
+    seg.volume_recolor_ids.clear();
+
+    std::vector<int> resampled;
+    std::vector<char> reshade(brickCount, false);
+    for (int brick = 0; brick < brickCount; ++brick) {
+        if (resample[brick]) {// occlusion of a texel depends on the alpha of its neighbours, which may lie in the adjacent bricks
+            resampled.emplace_back(brick);
+            const auto x = brick % bricksPerAxis, y = brick / bricksPerAxis % bricksPerAxis, z = brick / bricksPerAxis / bricksPerAxis;
+            for (int dz = std::max(0, z - 1); dz <= std::min(bricksPerAxis - 1, z + 1); ++dz)
+            for (int dy = std::max(0, y - 1); dy <= std::min(bricksPerAxis - 1, y + 1); ++dy)
+            for (int dx = std::max(0, x - 1); dx <= std::min(bricksPerAxis - 1, x + 1); ++dx) {
+                reshade[(dz * bricksPerAxis + dy) * bricksPerAxis + dx] = true;
             }
         }
     }
-
-    for(int z = 1; z < texLen - 1; ++z)
-    for(int y = 1; y < texLen - 1; ++y)
-    for(int x = 1; x < texLen - 1; ++x) {
-        auto indexInTex = (z)*texLen*texLen + (y)*texLen + x;
-        if(colcube[4*indexInTex+3] != 0) {
-            for(int yi = -1; yi <= 1; ++yi) {
-                auto othrIndexInTex = (z)*texLen*texLen + (y+yi)*texLen + x;
-                if((yi != 0) && colcube[4*othrIndexInTex+3] != 0) {
-                    colcube[4*indexInTex+0] *= 0.95f;
-                    colcube[4*indexInTex+1] *= 0.95f;
-                    colcube[4*indexInTex+2] *= 0.95f;
-                }
-            }
+    if (resampled.empty()) {
+        tex_gen_profiler.end(); // ----------------------------------------------------------- profiling
+        return;
+    }
+    std::vector<int> shaded;
+    for (int brick = 0; brick < brickCount; ++brick) {
+        if (reshade[brick]) {
+            shaded.emplace_back(brick);
         }
     }
 
-    for(int z = 1; z < texLen - 1; ++z)
-    for(int y = 1; y < texLen - 1; ++y)
-    for(int x = 1; x < texLen - 1; ++x) {
-        auto indexInTex = (z)*texLen*texLen + (y)*texLen + x;
-        if(colcube[4*indexInTex+3] != 0) {
-            for(int zi = -1; zi <= 1; ++zi) {
-                auto othrIndexInTex = (z+zi)*texLen*texLen + (y)*texLen + x;
-                if((zi != 0) && colcube[4*othrIndexInTex+3] != 0) {
-                    colcube[4*indexInTex+0] *= 0.95f;
-                    colcube[4*indexInTex+1] *= 0.95f;
-                    colcube[4*indexInTex+2] *= 0.95f;
-                }
+    colorfetch_profiler.start(); // ----------------------------------------------------------- profiling
+    std::vector<std::vector<std::uint64_t>> brickIds(resampled.size());
+    {
+        QMutexLocker pin(&state->protectCube2Pointer);// the cubes stay loaded while sampling
+        dcfetch_profiler.start(); // ----------------------------------------------------------- profiling
+        ArbSlice::Grid<std::uint64_t> grid;
+        grid.supercubeEdge = M;
+        grid.cubeEdge = cubeLen;
+        for(int z = 0; z < M; ++z)
+        for(int y = 0; y < M; ++y)
+        for(int x = 0; x < M; ++x) {
+            Coordinate cubeCoordRelative{x - M_radius, y - M_radius, z - M_radius};
+            grid.cubes.emplace_back(reinterpret_cast<const std::uint64_t *>(
+                Coordinate2BytePtr_hash_get_or_fail(state->Oc2Pointer[int_log(state->magnification)],
+                {currentPosDc.x + cubeCoordRelative.x, currentPosDc.y + cubeCoordRelative.y, currentPosDc.z + cubeCoordRelative.z})));
+        }
+        dcfetch_profiler.end(); // ----------------------------------------------------------- profiling
+        std::vector<std::size_t> jobs(resampled.size());
+        std::iota(std::begin(jobs), std::end(jobs), 0);
+        QtConcurrent::blockingMap(jobs, [&](const std::size_t job){
+            const auto box = VolumeSlice::brick(resampled[job], texLen);
+            brickIds[job].resize(box.size());
+            volumeBrickIds[resampled[job]] = VolumeSlice::sample(grid, box, brickIds[job].data());
+        });
+    }
+    // colours are resolved once per distinct id, the segmentation is only accessed from this thread
+    std::unordered_map<std::uint64_t, VolumeSlice::Rgba> colors;
+    for (const auto brick : resampled)
+    for (const auto id : volumeBrickIds[brick]) {
+        if (colors.find(id) == std::end(colors)) {
+            VolumeSlice::Rgba color{{}};
+            if (seg.isSubObjectIdSelected(id)) {
+                const auto idColor = seg.colorObjectFromSubobjectId(id);
+                color = {{std::get<0>(idColor), std::get<1>(idColor), std::get<2>(idColor), 255}};// ignore color alpha
             }
+            colors.emplace(id, color);
         }
     }
+    std::vector<std::size_t> colorJobs(resampled.size());
+    std::iota(std::begin(colorJobs), std::end(colorJobs), 0);
+    QtConcurrent::blockingMap(colorJobs, [&](const std::size_t job){
+        const auto box = VolumeSlice::brick(resampled[job], texLen);
+        VolumeSlice::colorize(brickIds[job].data(), box, colors, volumeBase.data(), texLen);
+        VolumeSlice::occupancy(volumeBase.data(), box, texLen, volumeOccupancy.data());
+    });
+    colorfetch_profiler.end(); // ----------------------------------------------------------- profiling
+
+    occlusion_profiler.start(); // ----------------------------------------------------------- profiling
+    std::vector<std::size_t> offsets;
+    std::size_t stagingBytes = 0;
+    for (const auto brick : shaded) {
+        offsets.emplace_back(stagingBytes);
+        stagingBytes += 4 * VolumeSlice::brick(brick, texLen).size();
+    }
+    auto staging = volumeStream.stage(stagingBytes);// shaded straight into upload memory
+    std::vector<std::size_t> shadeJobs(shaded.size());
+    std::iota(std::begin(shadeJobs), std::end(shadeJobs), 0);
+    QtConcurrent::blockingMap(shadeJobs, [&](const std::size_t job){
+        VolumeSlice::shade(volumeBase.data(), VolumeSlice::brick(shaded[job], texLen), texLen, reinterpret_cast<std::uint8_t *>(staging.data + offsets[job]));
+    });
     occlusion_profiler.end(); // ----------------------------------------------------------- profiling
 
     tex_transfer_profiler.start(); // ----------------------------------------------------------- profiling
     glBindTexture(GL_TEXTURE_3D, seg.volume_tex_id);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA, texLen, texLen, texLen, 0, GL_RGBA, GL_UNSIGNED_BYTE, colcube);
-    delete[] colcube;
+    volumeStream.upload(staging, [&shaded, &offsets, texLen](const char * pixels){
+        for (std::size_t i = 0; i < shaded.size(); ++i) {
+            const auto box = VolumeSlice::brick(shaded[i], texLen);
+            glTexSubImage3D(GL_TEXTURE_3D, 0, box.first[0], box.first[1], box.first[2], box.end[0] - box.first[0], box.end[1] - box.first[1], box.end[2] - box.first[2], GL_RGBA, GL_UNSIGNED_BYTE, pixels + offsets[i]);
+        }
+    });
     tex_transfer_profiler.end(); // ----------------------------------------------------------- profiling
 
     tex_gen_profiler.end(); // ----------------------------------------------------------- profiling
@@ -1023,22 +1093,42 @@ void ViewportBase::takeSnapshot(const QString & path, const int size, const bool
     makeCurrent();
     glEnable(GL_MULTISAMPLE);
     glPushAttrib(GL_VIEWPORT_BIT); // remember viewport setting
-    glViewport(0, 0, size, size);
+    // large snapshots are rendered tile by tile into a small fbo and written band by band
+    const auto tileEdge = std::min(size, snapshotTileEdge);
+    const auto tiles = (size + tileEdge - 1) / tileEdge;
+    glViewport(0, 0, tileEdge, tileEdge);
     QOpenGLFramebufferObjectFormat format;
     format.setSamples(state->viewerState->sampleBuffers);
     format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
-    QOpenGLFramebufferObject fbo(size, size, format);
+    QOpenGLFramebufferObject fbo(tileEdge, tileEdge, format);
     const auto options = RenderOptions::snapshotRenderOptions(withAxes, withBox, withOverlay, true, withSkeleton, withVpPlanes);
-    fbo.bind();
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Qt does not clear it?
-    renderViewport(options);
-    if(withScale) {
-        setFrontFacePerspective();
-        renderScaleBar();
+    SnapshotWriter writer(path, size, size);
+    tileScale = static_cast<float>(size) / tileEdge;
+    for (int tileY = 0; tileY < tiles; ++tileY) {
+        QImage band(size, std::min(tileEdge, size - tileY * tileEdge), QImage::Format_RGB32);
+        for (int tileX = 0; tileX < tiles; ++tileX) {
+            // move the tile center into the ndc origin and magnify, image rows go top down, ndc y goes up
+            tileProjection.setToIdentity();
+            tileProjection.scale(tileScale, tileScale);
+            tileProjection.translate(1 - (2.0 * tileX + 1) * tileEdge / size, (2.0 * tileY + 1) * tileEdge / size - 1);
+            fbo.bind();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Qt does not clear it?
+            renderViewport(options);
+            if(withScale) {// drawn through the tile projection as well, so it continues across tile borders
+                setFrontFacePerspective();
+                renderScaleBar();
+            }
+            const QImage tile(fbo.toImage());// 32 bit, alpha is ignored like QImage::Format_RGB32 does
+            const auto columns = std::min(tileEdge, size - tileX * tileEdge);
+            for (int y = 0; y < band.height(); ++y) {
+                std::copy(tile.scanLine(y), tile.scanLine(y) + 4 * columns, band.scanLine(y) + 4 * tileX * tileEdge);
+            }
+        }
+        writer.append(std::move(band));
     }
-    QImage fboImage(fbo.toImage());
-    QImage image(fboImage.constBits(), fboImage.width(), fboImage.height(), QImage::Format_RGB32);
-    qDebug() << tr("snapshot ") + (!image.save(path) ? "un" : "") + tr("successful.");
+    tileProjection.setToIdentity();
+    tileScale = 1;
+    qDebug() << tr("snapshot ") + (!writer.finish() ? "un" : "") + tr("successful.");
     glPopAttrib(); // restore viewport setting
     fbo.release();
 }
@@ -1073,8 +1163,6 @@ void ViewportArb::paintGL() {
     glClear(GL_DEPTH_BUFFER_BIT);
     if (state->gpuSlicer && state->viewer->gpuRendering) {
         state->viewer->arbCubes(*this);
-    } else if (Segmentation::enabled && state->viewerState->showOnlyRawData == false) {
-        updateOverlayTexture();
     }
     ViewportOrtho::paintGL();
 }
@@ -1086,32 +1174,3 @@ void ViewportArb::hideVP() {
 void ViewportArb::showHideButtons(bool isShow) {
     ViewportBase::showHideButtons(isShow);
 }
-
-void ViewportArb::updateOverlayTexture() {
-    if (!ocResliceNecessary) {
-        return;
-    }
-    ocResliceNecessary = false;
-    const int width = (state->M - 1) * state->cubeEdgeLength / std::sqrt(2);
-    const int height = width;
-    const auto begin = leftUpperPxInAbsPx_float;
-    std::vector<char> texData(4 * std::pow(state->viewerState->texEdgeLength, 2));
-    boost::multi_array_ref<uint8_t, 3> viewportView(reinterpret_cast<uint8_t *>(texData.data()), boost::extents[width][height][4]);
-    for (int y = 0; y < height; ++y)
-    for (int x = 0; x < width; ++x) {
-        const auto dataPos = static_cast<Coordinate>(begin + v1 * state->magnification * x - v2 * state->magnification * y);
-        if (dataPos.x < 0 || dataPos.y < 0 || dataPos.z < 0) {
-            viewportView[y][x][0] = viewportView[y][x][1] = viewportView[y][x][2] = viewportView[y][x][3] = 0;
-        } else {
-            const auto soid = readVoxel(dataPos);
-            const auto color = Segmentation::singleton().colorObjectFromSubobjectId(soid);
-            viewportView[y][x][0] = std::get<0>(color);
-            viewportView[y][x][1] = std::get<1>(color);
-            viewportView[y][x][2] = std::get<2>(color);
-            viewportView[y][x][3] = std::get<3>(color);
-        }
-    }
-    glBindTexture(GL_TEXTURE_2D, texture.overlayHandle);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, texData.data());
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
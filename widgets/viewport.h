@@ -25,18 +25,23 @@
 
 #include "coordinate.h"
 #include "mesh/mesh.h"
+#include "slicer/texturestream.h"
 #include "stateInfo.h"
 
 #include <QAction>
 #include <QDebug>
 #include <QDialog>
 #include <QDockWidget>
+#include <QElapsedTimer>
 #include <QFont>
+#include <QMatrix4x4>
 #include <QMouseEvent>
+#include <QMutex>
 #include <QOpenGLDebugLogger>
 #include <QOpenGLFunctions_2_0>
 #include <QOpenGLBuffer>
 #include <QOpenGLShaderProgram>
+#include <QOpenGLTimerQuery>
 #include <QOpenGLWidget>
 #include <QPushButton>
 #include <QToolButton>
@@ -48,6 +53,8 @@
 #include <boost/multi_array.hpp>
 #include <boost/optional.hpp>
 
+#include <unordered_set>
+
 enum ViewportType {VIEWPORT_XY, VIEWPORT_XZ, VIEWPORT_ZY, VIEWPORT_ARBITRARY, VIEWPORT_SKELETON, VIEWPORT_UNDEFINED};
 Q_DECLARE_METATYPE(ViewportType)
 
@@ -63,6 +70,8 @@ struct viewportTexture {
     //Handles for OpenGl
     uint texHandle{0};
     GLint textureFilter{GL_LINEAR};
+    int mipLevels{0};// of the data texture below its base level, updated per cube by Viewer::vpGenerateTexture
+    GLint minFilter() const { return mipLevels > 0 && textureFilter == GL_LINEAR ? GL_LINEAR_MIPMAP_LINEAR : textureFilter; }
     uint overlayHandle{0};
 
     //The absPx coordinate of the upper left corner of the texture actually stored in *texture
@@ -169,6 +178,11 @@ protected:
     // rendering
     virtual void initializeGL() override;
     virtual void hideVP();
+    // tiled snapshots render the viewport as a grid of sub-frusta, the tile projection maps the current tile onto the whole gl viewport
+    static constexpr int snapshotTileEdge = 1024;
+    QMatrix4x4 tileProjection;
+    float tileScale{1};// snapshot edge length per tile edge length
+    void loadProjection();
     void setFrontFacePerspective();
     void renderScaleBar();
     virtual void renderViewport(const RenderOptions & options = RenderOptions()) = 0;
@@ -287,6 +301,19 @@ class Viewport3D : public ViewportBase {
     bool wiggleDirection{true};
     int wiggle{0};
     QTimer wiggletimer;
+    TextureStream volumeStream;
+    std::vector<GLubyte> volumeBase;// rgba before occlusion shading
+    Coordinate volumeOrigin;// supercube center cube of volumeBase
+    int volumeSupercubeEdge{0};
+    std::vector<std::vector<std::uint64_t>> volumeBrickIds;// sorted distinct subobject ids per brick of volumeBase
+    std::vector<std::uint8_t> volumeOccupancy;// cells of volumeBase containing opaque texels, see VolumeSlice::occupancy
+    QOpenGLBuffer volumeSliceBuffer{QOpenGLBuffer::VertexBuffer};
+    QOpenGLTimerQuery volumePassQuery;
+    boost::optional<bool> volumePassQuerySupport;
+    bool volumePassQueryPending{false};
+    QElapsedTimer volumePassTimer;// without timer queries
+    double volumePassMs{-1};// last unused measurement of the volume pass
+    float volumeSliceQuality{1};// fraction of the full slice count, adapted to the frame time
     void renderVolumeVP();
     void renderMesh();
     void renderMeshBuffer(Mesh & buf);
@@ -367,12 +394,36 @@ public:
 
     void sendCursorPosition();
     Coordinate getMouseCoordinate();
+    // latest mouse move, hovering is handled once per frame by Viewer::handlePendingHovers
+    boost::optional<QMouseEvent> pendingHover;
+    void handleHover(const Coordinate & coord, const uint64_t subObjectId);
     // vp vectors relative to the first cartesian octant
     floatCoordinate v1;// vector in x direction
     floatCoordinate v2;// vector in y direction
     floatCoordinate  n;// faces away from the vp plane towards the camera
     std::atomic_bool dcResliceNecessary{true};
     std::atomic_bool ocResliceNecessary{true};
+    // the textures are toroidal, cube c is kept in slot c mod (texture.size / cubeEdgeLength) along both texture axes
+    // cubes already in the ring are only resliced after their content changed (ring invalidated) or the slice depth moved
+    struct SliceRing {
+        CoordOfCube upperLeftDc;
+        int depth{-1};// position along the viewport normal in dataset pixels
+        int magnification{0};
+        int cubeEdgeLength{0};
+        int supercubeEdge{0};
+    };
+    SliceRing dcRing;
+    SliceRing ocRing;
+    // invalidate before setting *ResliceNecessary, so a concurrent vpGenerateTexture cannot miss it
+    std::atomic_bool dcRingValid{false};
+    std::atomic_bool ocRingValid{false};
+    // global positions of cubes loaded since the last reslice, only their slots of a valid ring are resliced, guarded by arrivedCubesMutex
+    QMutex arrivedCubesMutex;
+    std::unordered_set<Coordinate> dcArrivedCubes;
+    std::unordered_set<Coordinate> ocArrivedCubes;
+    // voxel regions (global first and last) of single overlay cubes edited since the last reslice, gui thread only
+    std::vector<std::pair<Coordinate, Coordinate>> ocDirtyRegions;
+    TextureStream textureStream;
     float displayedIsoPx;
     float screenPxYPerDataPx;
     float displayedlengthInNmY;
@@ -388,7 +439,6 @@ public:
 class ViewportArb : public ViewportOrtho {
     Q_OBJECT
     QAction resetAction{"Reset rotation", &menuButton};
-    void updateOverlayTexture();
 
 protected:
     virtual void paintGL() override;
@@ -105,15 +105,30 @@ void segmentation_brush_work(const QMouseEvent *event, ViewportOrtho & vp) {
 
 
 void ViewportOrtho::handleMouseHover(const QMouseEvent *event) {
-    auto coord = getCoordinateFromOrthogonalClick(event->x(), event->y(), *this);
+    pendingHover = *event;// mice with high polling rates send many moves per frame, only the latest one is handled
+    state->viewer->postDamage();
+    ViewportBase::handleMouseHover(event);
+}
+
+void ViewportOrtho::handleHover(const Coordinate & coord, const uint64_t subObjectId) {
+    const auto event = *pendingHover;
+    pendingHover = boost::none;
     emit cursorPositionChanged(coord, viewportType);
-    auto subObjectId = readVoxel(coord);
-    Segmentation::singleton().hoverSubObject(subObjectId);
-    EmitOnCtorDtor eocd(&SignalRelay::Signal_EventModel_handleMouseHover, state->signalRelay, coord, subObjectId, viewportType, event);
-    if(Segmentation::singleton().hoverVersion && Segmentation::enabled) {
-        Segmentation::singleton().mouseFocusedObjectId = Segmentation::singleton().tryLargestObjectContainingSubobject(subObjectId);
+    auto & seg = Segmentation::singleton();
+    seg.hoverSubObject(subObjectId);
+    EmitOnCtorDtor eocd(&SignalRelay::Signal_EventModel_handleMouseHover, state->signalRelay, coord, subObjectId, viewportType, &event);
+    if (seg.hoverVersion && Segmentation::enabled) {
+        const auto focusedObjectId = seg.tryLargestObjectContainingSubobject(subObjectId);
+        if (focusedObjectId != seg.mouseFocusedObjectId) {// highlighted edges only change with the object
+            seg.mouseFocusedObjectId = focusedObjectId;
+            if (!(state->gpuSlicer && state->viewer->gpuRendering)) {// the overlay shader outlines the hovered object by itself
+                state->viewer->window->forEachOrthoVPDo([](ViewportOrtho & vp) {
+                    vp.ocRingValid = false;
+                    vp.ocResliceNecessary = true;
+                });
+            }
+        }
     }
-    ViewportBase::handleMouseHover(event);
 }
 
 void startNodeSelection(const int x, const int y, const ViewportType vpType, const Qt::KeyboardModifiers modifiers) {
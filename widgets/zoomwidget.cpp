@@ -135,12 +135,11 @@ ZoomWidget::ZoomWidget(QWidget *parent, DatasetLoadWidget * datasetLoadWidget)
                state->viewer->updateDatasetMag(state->magnification * 2);
                newFOV = 0.5;
             }
-            else if(prevFOV == 0.5 && static_cast<uint>(state->magnification) > state->viewer->lowestMag() && prevFOV > newFOV) {
+            else if(prevFOV <= state->viewer->zoomMaxFOV() && static_cast<uint>(state->magnification) > state->viewer->lowestMag() && prevFOV > newFOV) {
+                newFOV = std::min(2 * prevFOV, static_cast<float>(VPZOOMMIN));// same scale in the finer mag
                 state->viewer->updateDatasetMag(state->magnification / 2);
-                newFOV = VPZOOMMIN;
             } else {
-                const float zoomMax = static_cast<float>(state->magnification) == state->lowestAvailableMag ? VPZOOMMAX : 0.5;
-                newFOV = std::max(std::min(newFOV, static_cast<float>(VPZOOMMIN)), zoomMax);
+                newFOV = std::max(std::min(newFOV, static_cast<float>(VPZOOMMIN)), state->viewer->zoomMaxFOV());
             }
         }
         state->viewer->window->forEachOrthoVPDo([&newFOV](ViewportOrtho & orthoVP) {
@@ -233,6 +232,7 @@ ZoomWidget::ZoomWidget(QWidget *parent, DatasetLoadWidget * datasetLoadWidget)
         reinitializeOrthoZoomWidgets();
     });
     connect(datasetLoadWidget, &DatasetLoadWidget::datasetChanged, this, &ZoomWidget::reinitializeOrthoZoomWidgets);
+    connect(datasetLoadWidget, &DatasetLoadWidget::datasetMagsChanged, this, &ZoomWidget::reinitializeOrthoZoomWidgets);
 
     setWindowFlags(windowFlags() & (~Qt::WindowContextHelpButtonHint));
 }